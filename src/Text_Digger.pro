@@ -4,6 +4,20 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++20 qtquickcompiler
 
+# The 8-bit PCRE2 library runs the regexes directly on the UTF-8 files, they are decoded to UTF-16 without it
+packagesExist(libpcre2-8) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libpcre2-8
+    DEFINES += TEXT_DIGGER_PCRE2
+}
+
+# The xxHash library hashes the contents (duplicates) with XXH3, vectorized, MurmurHash3 is used without it
+packagesExist(libxxhash) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libxxhash
+    DEFINES += TEXT_DIGGER_XXHASH
+}
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -20,12 +34,26 @@ HEADERS += \
     components/statusbarwidget.h \
     constants/constants.h \
     constants/resources.h \
+    databases/database_hashes.h \
+    databases/database_results.h \
     databases/database_settings.h \
     delegates/browsable_cell_delegate.h \
     delegates/checkbox_item_delegate.h \
     enumerators/enums.h \
     hash/checksum_utils.h \
+    hash/duplicates_detector.h \
+    hash/hash128.h \
     hash/murmurhash3.h \
+    indexes/change_journal.h \
+    indexes/trigram_index.h \
+    matchers/aho_corasick_matcher.h \
+    matchers/filename_matcher.h \
+    matchers/literal_matcher.h \
+    matchers/metadata_filter.h \
+    matchers/regex_literals.h \
+    matchers/text_matcher.h \
+    matchers/utf8_regex.h \
+    matchers/word_boundaries.h \
     models/results_model.h \
     models/results_sortfilterproxymodel.h \
     models/standardmodel.h \
@@ -37,16 +65,24 @@ HEADERS += \
     operations/op_open_files.h \
     operations/op_replace_ocurrences.h \
     operations/op_rescan_occurrences.h \
+    operations/op_rescan_results.h \
+    operations/op_walk_directories.h \
     stores/store_setting.h \
     stores/store_statistic.h \
+    utils/blocking_queue.h \
     utils/center_utils.h \
     utils/clipboard_utils.h \
+    utils/content_utils.h \
     utils/datetime_utils.h \
     utils/directories_utils.h \
     utils/file_utils.h \
+    utils/filetypes_utils.h \
     utils/logger_utils.h \
+    utils/mime_resolver.h \
     utils/mimetypes_utils.h \
-    utils/size_utils.h
+    utils/path_trie.h \
+    utils/size_utils.h \
+    utils/stat_utils.h
 
 
 SOURCES += \
@@ -83,6 +83,7 @@ AboutWindow::AboutWindow(QWidget *parent) : QDialog(parent), ui(new Ui::AboutWin
 
     detailsModel->appendNew("Settings Directory", SETTINGS_DIR.absolutePath());
     detailsModel->appendNew("Loggers Directory", LOGGERS_DIR.absolutePath());
+    detailsModel->appendNew("Cache Directory", CACHE_DIR.absolutePath());
 
 }
 
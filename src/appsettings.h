@@ -87,6 +87,7 @@ public:
         m_ignoreHiddenFiles(false),
         m_ignoreSymbolicFilesLinks(true),
         m_avoidDuplicateFiles(false),
+        m_listDuplicateFilesOnly(false),
         m_enableFileReadingTimeout(true),
         m_fileReadingTimeout(60),
         m_enableFilesToParseLimit(true),
@@ -100,6 +101,12 @@ public:
         m_alwaysOnTop(false),
         m_enableLoggers(false),
         m_loggersFilesToKeep(100),
+        m_scanThreads(0),
+        m_sortResults(true),
+        m_listMatchingFilesOnly(false),
+        m_useTrigramIndex(false),
+        m_useChangeJournal(false),
+        m_cacheResults(false),
         m_lastResultsDirectory("")
     { }
 
@@ -280,6 +287,10 @@ public:
         return m_avoidDuplicateFiles;
     }
 
+    inline bool listDuplicateFilesOnly() const {
+        return m_listDuplicateFilesOnly;
+    }
+
     inline bool enableFileReadingTimeout() const {
         return m_enableFileReadingTimeout;
     }
@@ -343,6 +354,30 @@ public:
         return m_loggersFilesToKeep;
     }
 
+    inline int getScanThreads() const {
+        return m_scanThreads;
+    }
+
+    inline bool getSortResults() const {
+        return m_sortResults;
+    }
+
+    inline bool getListMatchingFilesOnly() const {
+        return m_listMatchingFilesOnly;
+    }
+
+    inline bool getUseTrigramIndex() const {
+        return m_useTrigramIndex;
+    }
+
+    inline bool getUseChangeJournal() const {
+        return m_useChangeJournal;
+    }
+
+    inline bool getCacheResults() const {
+        return m_cacheResults;
+    }
+
     inline QString getLastResultsDirectory() const {
         return m_lastResultsDirectory;
     }
@@ -576,6 +611,10 @@ public:
         m_avoidDuplicateFiles = newAvoidDuplicateFiles;
     }
 
+    inline void setListDuplicateFilesOnly(const bool &newListDuplicateFilesOnly) {
+        m_listDuplicateFilesOnly = newListDuplicateFilesOnly;
+    }
+
     inline void setEnableFileReadingTimeout(const bool &newEnableFileReadingTimeout) {
         m_enableFileReadingTimeout = newEnableFileReadingTimeout;
     }
@@ -645,6 +684,30 @@ public:
         m_loggersFilesToKeep = newLoggersFilesToKeep;
     }
 
+    inline void setScanThreads(const int &newScanThreads) {
+        m_scanThreads = newScanThreads;
+    }
+
+    inline void setSortResults(const bool &newSortResults) {
+        m_sortResults = newSortResults;
+    }
+
+    inline void setListMatchingFilesOnly(const bool &newListMatchingFilesOnly) {
+        m_listMatchingFilesOnly = newListMatchingFilesOnly;
+    }
+
+    inline void setUseTrigramIndex(const bool &newUseTrigramIndex) {
+        m_useTrigramIndex = newUseTrigramIndex;
+    }
+
+    inline void setUseChangeJournal(const bool &newUseChangeJournal) {
+        m_useChangeJournal = newUseChangeJournal;
+    }
+
+    inline void setCacheResults(const bool &newCacheResults) {
+        m_cacheResults = newCacheResults;
+    }
+
     inline void setLastResultsDirectory(const QString &lastResultsDirectory) {
         m_lastResultsDirectory = lastResultsDirectory;
     }
@@ -829,6 +892,10 @@ public:
                                           QString::number(m_avoidDuplicateFiles),
                                           QString::number(0)));
 
+        settingsList.append(Store_Setting("m_listDuplicateFilesOnly",
+                                          QString::number(m_listDuplicateFilesOnly),
+                                          QString::number(0)));
+
         settingsList.append(Store_Setting("m_enableFileReadingTimeout",
                                           QString::number(m_enableFileReadingTimeout),
                                           QString::number(1)));
@@ -881,6 +948,30 @@ public:
                                           QString::number(m_loggersFilesToKeep),
                                           QString::number(100)));
 
+        settingsList.append(Store_Setting("m_scanThreads",
+                                          QString::number(m_scanThreads),
+                                          QString::number(0)));
+
+        settingsList.append(Store_Setting("m_sortResults",
+                                          QString::number(m_sortResults),
+                                          QString::number(1)));
+
+        settingsList.append(Store_Setting("m_listMatchingFilesOnly",
+                                          QString::number(m_listMatchingFilesOnly),
+                                          QString::number(0)));
+
+        settingsList.append(Store_Setting("m_useTrigramIndex",
+                                          QString::number(m_useTrigramIndex),
+                                          QString::number(0)));
+
+        settingsList.append(Store_Setting("m_useChangeJournal",
+                                          QString::number(m_useChangeJournal),
+                                          QString::number(0)));
+
+        settingsList.append(Store_Setting("m_cacheResults",
+                                          QString::number(m_cacheResults),
+                                          QString::number(0)));
+
         settingsList.append(Store_Setting("m_lastResultsDirectory",
                                           m_lastResultsDirectory,
                                           HOME_DIRECTORY.absolutePath()));
@@ -945,6 +1036,7 @@ private:
     bool m_ignoreHiddenFiles;
     bool m_ignoreSymbolicFilesLinks;
     bool m_avoidDuplicateFiles;
+    bool m_listDuplicateFilesOnly;
 
     bool m_enableFileReadingTimeout;
     int m_fileReadingTimeout;
@@ -965,6 +1057,13 @@ private:
     bool m_enableLoggers = false;
     int m_loggersFilesToKeep = 100;
 
+    int m_scanThreads = 0;      // 0 means "use the hardware concurrency"
+    bool m_sortResults = true;
+    bool m_listMatchingFilesOnly = false;   // Like grep -l: stop reading a file at its first match
+    bool m_useTrigramIndex = false;         // Only read the files the trigram index of their root can't rule out
+    bool m_useChangeJournal = false;        // Watch the searched directories, a repeated search only redoes the changes
+    bool m_cacheResults = false;            // Keep the scan outcome of each file, for the same search of the unchanged file
+
     QString m_lastResultsDirectory;
 
 };
@@ -50,6 +50,13 @@ FilterWidget::FilterWidget(QWidget *parent) : QLineEdit(parent) , m_patternGroup
     m_fixedStringAction->setCheckable(true);
     m_patternGroup->addAction(m_fixedStringAction);
 
+    m_multipleTermsAction = menu->addAction("Multiple Terms");
+    m_multipleTermsAction->setData(QVariant(int(MultipleTerms)));
+    m_multipleTermsAction->setCheckable(true);
+    m_multipleTermsAction->setVisible(false);
+    m_multipleTermsAction->setToolTip("Terms separated by semicolons or new lines, searched all at once");
+    m_patternGroup->addAction(m_multipleTermsAction);
+
     connect(m_patternGroup, &QActionGroup::triggered, this, &FilterWidget::filterChanged);
 
     connect(m_patternGroup, &QActionGroup::triggered, this, [this](QAction *action) {
@@ -112,9 +119,17 @@ void FilterWidget::setPatternSyntax(PatternSyntax patternSyntax) {
 void FilterWidget::disablePatternsActions(bool disable) {
     m_regularExpressionAction->setEnabled(!disable);
     m_wildcardAction->setEnabled(!disable);
+    m_multipleTermsAction->setEnabled(!disable);
     m_fixedStringAction->setChecked(true);
 }
 
+void FilterWidget::setMultipleTermsAvailable(bool available) {
+    m_multipleTermsAction->setVisible(available);
+
+    if (!available && m_multipleTermsAction->isChecked())
+        m_fixedStringAction->setChecked(true);
+}
+
 // Convert current PatternSyntax to QString
 QString FilterWidget::patternSyntaxToString() const {
     return patternSyntaxToString(patternSyntax());
@@ -129,6 +144,8 @@ QString FilterWidget::patternSyntaxToString(PatternSyntax patternSyntax) const {
         return QStringLiteral("Wildcard");
     case FixedString:
         return QStringLiteral("FixedString");
+    case MultipleTerms:
+        return QStringLiteral("MultipleTerms");
     default:
         return QStringLiteral("Unknown");
     }
@@ -146,6 +163,9 @@ FilterWidget::PatternSyntax FilterWidget::stringToPatternSyntax(const QString &s
     if (str == QStringLiteral("FixedString"))
         return FixedString;
 
+    if (str == QStringLiteral("MultipleTerms"))
+        return MultipleTerms;
+
     // Default or error case, you could throw an error or return a default value
     return FixedString;  // Default to FixedString or handle this appropriately
 
@@ -36,7 +36,8 @@ public:
     enum PatternSyntax {
         RegularExpression,
         Wildcard,
-        FixedString
+        FixedString,
+        MultipleTerms
     };
     Q_ENUM(PatternSyntax)
 
@@ -48,6 +49,9 @@ public:
     QString patternSyntaxToString(PatternSyntax patternSyntax) const;
     PatternSyntax stringToPatternSyntax(const QString &str) const;
 
+    // The "Multiple Terms" syntax is only offered where the search supports it
+    void setMultipleTermsAvailable(bool available);
+
 
 public slots:
     void disablePatternsActions(bool disable);
@@ -65,6 +69,7 @@ private:
     QAction *m_regularExpressionAction;
     QAction *m_wildcardAction;
     QAction *m_fixedStringAction;
+    QAction *m_multipleTermsAction;
 
 };
 
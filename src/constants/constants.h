@@ -23,6 +23,10 @@ static const QDir HOME_DIRECTORY(QStandardPaths::writableLocation(QStandardPaths
 static QDir SETTINGS_DIR(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/" + APP_TITLE);
 static QDir LOGGERS_DIR(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/" + APP_TITLE + "/Loggers");
 static QFileInfo SETTINGS_FILE(SETTINGS_DIR.filePath("settings.db"));
+static QDir CACHE_DIR(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + APP_TITLE);
+static QFileInfo HASHES_CACHE_FILE(CACHE_DIR.filePath("hashes.db"));
+static QFileInfo RESULTS_CACHE_FILE(CACHE_DIR.filePath("results.db"));
+static QDir INDEXES_DIR(CACHE_DIR.filePath("Indexes"));
 
 
 // *********************************************************************************************************************
@@ -98,6 +102,26 @@ static const QMap<QString, double> IEC_CONVERSIONS {
 
 
 
+// *********************************************************************************************************************
+// ***************************************************** Pipeline ******************************************************
+// *********************************************************************************************************************
+static constexpr qsizetype PATHS_QUEUE_CAPACITY = 4096;     // Paths waiting for the filters
+static constexpr qsizetype SCAN_QUEUE_CAPACITY = 1024;      // Filtered files waiting for the scanners
+static constexpr int RESULTS_BATCH_SIZE = 64;               // Results sent to the GUI thread at once
+static constexpr int RESULTS_BATCH_INTERVAL = 250;          // ms, a smaller batch is flushed after that delay
+static constexpr qsizetype HASHES_CACHE_BATCH_SIZE = 256;   // Hashes written to the cache in a single transaction
+static constexpr int HASHES_CACHE_FLUSH_INTERVAL = 1000;    // ms, a smaller batch is written after that delay
+static constexpr int HASHES_CACHE_MAX_AGE = 30;             // Days, the hashes unused for longer are evicted
+static constexpr qsizetype RESULTS_CACHE_BATCH_SIZE = 256;  // Scan outcomes written in a single transaction
+static constexpr int RESULTS_CACHE_FLUSH_INTERVAL = 1000;   // ms, a smaller batch is written after that delay
+static constexpr qint64 RESULTS_CACHE_MAX_SIZE = 128 * 1024 * 1024;    // Bytes, the least used outcomes are evicted beyond
+static constexpr int TRIGRAM_INDEX_MAX_AGE = 24;            // Hours, an older index is built again before a search
+static constexpr qint64 TRIGRAM_INDEX_MAX_FILE_SIZE = 64 * 1024 * 1024;    // Bigger files are always scanned
+static constexpr qsizetype CHANGE_JOURNAL_MAX_ENTRIES = 100000;  // Beyond, the next search is a full one
+static constexpr int CHANGE_JOURNAL_POLL_INTERVAL = 250;    // ms, how often the journal thread checks it must stop
+
+
+
 // *********************************************************************************************************************
 // *************************************************** Miscellaneous ***************************************************
 // *********************************************************************************************************************
@@ -106,7 +106,8 @@ inline const QIcon &getIcon(IconType type) {
         {COPY, ":/icons/resources/icons/svg/copy.svg"},
         {TRASH, ":/icons/resources/icons/svg/trash.svg"},
         {OPENFILES, ":/icons/resources/icons/svg/open_files.svg"},
-        {EDITFILE, ":/icons/resources/icons/svg/edit_file.svg"}
+        {EDITFILE, ":/icons/resources/icons/svg/edit_file.svg"},
+        {REFRESH, ":/icons/resources/icons/svg/refresh.svg"}
     };
 
     static std::map<IconType, QIcon> icons;
@@ -0,0 +1,415 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "constants/constants.h"
+#include "hash/checksum_utils.h"
+#include "hash/hash128.h"
+#include "utils/file_utils.h"
+#include "utils/stat_utils.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtSql/QtSql>
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+
+/**
+ * The Database_Hashes class is a persistent cache of the content hashes, stored in its own SQLite database apart
+ * from the settings. A hash stays valid while the path, inode, size & modification time of its file are unchanged,
+ * so the duplicates detection doesn't read again the files hashed by a previous search.
+ *
+ * A Qt SQL connection can only be used by the thread that opened it: a worker thread owns the connection and serves
+ * the scanners. The lookups waiting together run in a single transaction, the hashes are written by batches and
+ * the stale entries are evicted by small chunks whenever the worker is idle. The database is in WAL mode, so the
+ * lookups don't wait for the writes of another search.
+ */
+class Database_Hashes {
+
+public:
+
+    struct Key {
+        QString path;
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 modifiedTimeNs = -1;
+    };
+
+    struct Hashes {
+        std::optional<Hash128> partial;     // Of the first & last bytes, see DuplicatesDetector
+        std::optional<Hash128> whole;
+    };
+
+
+
+    // *******************************************************************************************************************
+    // ************************************************** Constructors ***************************************************
+    // *******************************************************************************************************************
+    /**
+     * Starts the worker, which opens the database. When it can't be opened, nothing is ever found nor written.
+     */
+    Database_Hashes() {
+
+        m_queryCreateTable = File_Utils::readFileFromResources(":/sql/resources/sql/hashes/create_table.sql");
+        m_queryCreateIndex = File_Utils::readFileFromResources(":/sql/resources/sql/hashes/create_index.sql");
+        m_queryLookup = File_Utils::readFileFromResources(":/sql/resources/sql/hashes/lookup.sql");
+        m_queryStore = File_Utils::readFileFromResources(":/sql/resources/sql/hashes/store.sql");
+        m_queryTouch = File_Utils::readFileFromResources(":/sql/resources/sql/hashes/touch.sql");
+        m_queryEvictStale = File_Utils::readFileFromResources(":/sql/resources/sql/hashes/evict_stale.sql");
+
+        // Each instance has its own connection, e.g. a search & a rescan at the same time
+        m_connectionName = QString("Hashes Database %1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+
+        m_worker.reset(QThread::create([this]() { run(); }));
+        m_worker->start(QThread::LowPriority);
+    }
+
+
+    /**
+     * Writes the hashes still waiting, then stops the worker.
+     */
+    ~Database_Hashes() {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_wakeWorker.wakeOne();
+        }
+
+        m_worker->wait();
+    }
+
+    Database_Hashes(const Database_Hashes &) = delete;
+    Database_Hashes &operator=(const Database_Hashes &) = delete;
+
+
+
+    // *******************************************************************************************************************
+    // ************************************************ Lookups & Stores *************************************************
+    // *******************************************************************************************************************
+    /**
+     * Checks if the metadata of a file can key its hashes. A file modified in the last seconds is left out: it could
+     * still change without its modification time changing.
+     */
+    static bool isCacheable(const FileStat &fileStat) {
+        const qint64 racyLimitNs = (QDateTime::currentMSecsSinceEpoch() - RACY_DELAY) * 1000000;
+        return fileStat.valid && fileStat.modifiedTimeNs >= 0 && fileStat.modifiedTimeNs < racyLimitNs;
+    }
+
+    static Key key(const QString &path, const FileStat &fileStat) {
+        return Key{path, fileStat.inode, fileStat.size, fileStat.modifiedTimeNs};
+    }
+
+
+    /**
+     * Looks the hashes of files up, waiting for the worker.
+     * @param keys - The files.
+     * @return - Their hashes in the order of the keys, none when the file is unknown or has changed since.
+     */
+    QVector<Hashes> lookup(const QVector<Key> &keys) {
+
+        LookupRequest request{&keys, QVector<Hashes>(keys.size()), false};
+        if (keys.isEmpty())
+            return request.results;
+
+        QMutexLocker locker(&m_mutex);
+        if (m_failed)
+            return request.results;
+
+        m_lookups.append(&request);
+        m_wakeWorker.wakeOne();
+
+        while (!request.done)
+            m_lookupsDone.wait(&m_mutex);
+
+        return request.results;
+    }
+
+
+    /**
+     * Keeps the hashes of a file, they are written with the next batch.
+     * @param key - The file.
+     * @param hashes - All its hashes known so far: they replace the ones stored for the file.
+     */
+    void store(const Key &key, const Hashes &hashes) {
+
+        QMutexLocker locker(&m_mutex);
+        if (m_failed)
+            return;
+
+        m_stores.append({key, hashes});
+        if (m_stores.size() >= HASHES_CACHE_BATCH_SIZE)
+            m_wakeWorker.wakeOne();
+    }
+
+
+
+
+private:
+    static constexpr qint64 RACY_DELAY = 2000;              // ms
+    static constexpr qint64 TOUCH_INTERVAL = 24 * 3600;     // s, the last use of a hash is updated once a day at most
+    static constexpr int EVICTION_CHUNK = 1000;             // Entries deleted at once, the lookups never wait long
+
+    struct LookupRequest {
+        const QVector<Key> *keys;
+        QVector<Hashes> results;
+        bool done;
+    };
+
+    QString m_connectionName;
+    std::unique_ptr<QThread> m_worker;
+
+    QString m_queryCreateTable;
+    QString m_queryCreateIndex;
+    QString m_queryLookup;
+    QString m_queryStore;
+    QString m_queryTouch;
+    QString m_queryEvictStale;
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeWorker;
+    QWaitCondition m_lookupsDone;
+    QVector<LookupRequest *> m_lookups;         // Waiting for the worker
+    QVector<QPair<Key, Hashes>> m_stores;       // Waiting for a full batch
+    bool m_stopping = false;
+    bool m_failed = false;
+
+
+    /**
+     * The worker: opens the database, serves the lookups & the stores until stopped, then closes it.
+     */
+    void run() {
+        {
+            QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+            database.setDatabaseName(HASHES_CACHE_FILE.absoluteFilePath());
+
+            if (openDatabase(database)) {
+                serve(database);
+            } else {
+                QMutexLocker locker(&m_mutex);
+                m_failed = true;
+
+                for (LookupRequest *request : std::as_const(m_lookups))
+                    request->done = true;
+
+                m_lookups.clear();
+                m_stores.clear();
+                m_lookupsDone.wakeAll();
+            }
+
+            database.close();
+        }
+
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+
+    /**
+     * Opens the database in WAL mode & creates the table if needed.
+     *
+     * @return True if the database is ready, otherwise false.
+     */
+    bool openDatabase(QSqlDatabase &database) {
+
+        if (!database.open()) {
+            qDebug() << "Hashes Database not opened!";
+            return false;
+        }
+
+        // The hashes can be computed again: a write lost on a power failure is no harm
+        QSqlQuery query(database);
+        if (!query.exec("PRAGMA journal_mode = WAL") || !query.exec("PRAGMA synchronous = NORMAL")
+            || !query.exec(m_queryCreateTable) || !query.exec(m_queryCreateIndex)) {
+            qDebug() << query.lastQuery();
+            qDebug() << query.lastError();
+            return false;
+        }
+
+        return true;
+    }
+
+
+    void serve(QSqlDatabase &database) {
+
+        QSqlQuery lookupQuery(database);
+        QSqlQuery storeQuery(database);
+        QSqlQuery touchQuery(database);
+        QSqlQuery evictQuery(database);
+        lookupQuery.prepare(m_queryLookup);
+        storeQuery.prepare(m_queryStore);
+        touchQuery.prepare(m_queryTouch);
+        evictQuery.prepare(m_queryEvictStale);
+
+        // The hashes of another algorithm (e.g. built without xxHash) are never found
+        const QString algorithm = ChecksumUtils::contentHashAlgorithm();
+        bool evicted = false;
+
+        QMutexLocker locker(&m_mutex);
+
+        forever {
+            if (m_lookups.isEmpty() && m_stores.size() < HASHES_CACHE_BATCH_SIZE && !m_stopping) {
+
+                // Idle: a chunk of the stale entries is evicted, else the incomplete batch is written after a while
+                if (!evicted) {
+                    locker.unlock();
+                    evicted = evictStale(evictQuery);
+                    locker.relock();
+                    continue;
+                }
+
+                if (m_wakeWorker.wait(&m_mutex, HASHES_CACHE_FLUSH_INTERVAL) || m_stores.isEmpty())
+                    continue;
+            }
+
+            const QVector<LookupRequest *> lookups = std::exchange(m_lookups, {});
+            const QVector<QPair<Key, Hashes>> stores = std::exchange(m_stores, {});
+            locker.unlock();
+
+            database.transaction();
+
+            for (LookupRequest *request : lookups)
+                lookupHashes(lookupQuery, touchQuery, algorithm, *request);
+
+            for (const QPair<Key, Hashes> &store : stores)
+                storeHashes(storeQuery, algorithm, store.first, store.second);
+
+            if (!database.commit())
+                qDebug() << "Error committing the hashes:" << database.lastError().text();
+
+            locker.relock();
+
+            for (LookupRequest *request : lookups)
+                request->done = true;
+
+            if (!lookups.isEmpty())
+                m_lookupsDone.wakeAll();
+
+            if (m_stopping && m_lookups.isEmpty() && m_stores.isEmpty())
+                break;
+        }
+    }
+
+
+    void lookupHashes(QSqlQuery &lookupQuery, QSqlQuery &touchQuery, const QString &algorithm, LookupRequest &request) {
+
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+        for (qsizetype i = 0; i < request.keys->size(); ++i) {
+            const Key &key = request.keys->at(i);
+
+            lookupQuery.bindValue(":C0", key.path);
+            lookupQuery.bindValue(":C1", static_cast<qint64>(key.inode));
+            lookupQuery.bindValue(":C2", key.size);
+            lookupQuery.bindValue(":C3", key.modifiedTimeNs);
+            lookupQuery.bindValue(":C4", algorithm);
+
+            if (!lookupQuery.exec()) {
+                qDebug() << "Error executing query:" << lookupQuery.lastError().text();
+                continue;
+            }
+
+            if (!lookupQuery.next()) {
+                lookupQuery.finish();
+                continue;
+            }
+
+            Hashes &hashes = request.results[i];
+            hashes.partial = readHash(lookupQuery, 0);
+            hashes.whole = readHash(lookupQuery, 2);
+            const qint64 lastUsed = lookupQuery.value(4).toLongLong();
+            lookupQuery.finish();
+
+            // Used again: not stale
+            if (now - lastUsed > TOUCH_INTERVAL) {
+                touchQuery.bindValue(":C0", now);
+                touchQuery.bindValue(":C1", key.path);
+                touchQuery.exec();
+            }
+        }
+    }
+
+
+    void storeHashes(QSqlQuery &storeQuery, const QString &algorithm, const Key &key, const Hashes &hashes) {
+
+        storeQuery.bindValue(":C0", key.path);
+        storeQuery.bindValue(":C1", static_cast<qint64>(key.inode));
+        storeQuery.bindValue(":C2", key.size);
+        storeQuery.bindValue(":C3", key.modifiedTimeNs);
+        storeQuery.bindValue(":C4", algorithm);
+        storeQuery.bindValue(":C5", hashPart(hashes.partial, false));
+        storeQuery.bindValue(":C6", hashPart(hashes.partial, true));
+        storeQuery.bindValue(":C7", hashPart(hashes.whole, false));
+        storeQuery.bindValue(":C8", hashPart(hashes.whole, true));
+        storeQuery.bindValue(":C9", QDateTime::currentSecsSinceEpoch());
+
+        if (!storeQuery.exec())
+            qDebug() << "Error storing hashes:" << storeQuery.lastError().text();
+    }
+
+
+    /**
+     * Deletes a chunk of the entries unused for HASHES_CACHE_MAX_AGE days.
+     *
+     * @return True if no stale entry is left.
+     */
+    bool evictStale(QSqlQuery &evictQuery) {
+
+        evictQuery.bindValue(":C0", QDateTime::currentSecsSinceEpoch() - qint64(HASHES_CACHE_MAX_AGE) * 24 * 3600);
+        evictQuery.bindValue(":C1", EVICTION_CHUNK);
+
+        if (!evictQuery.exec()) {
+            qDebug() << "Error evicting hashes:" << evictQuery.lastError().text();
+            return true;
+        }
+
+        return evictQuery.numRowsAffected() < EVICTION_CHUNK;
+    }
+
+
+    // SQLite integers are signed: the 64-bit halves of a hash are stored as such
+    static QVariant hashPart(const std::optional<Hash128> &hash, const bool high) {
+        if (!hash)
+            return QVariant(QMetaType::fromType<qint64>());
+
+        return static_cast<qint64>(high ? hash->high : hash->low);
+    }
+
+    static std::optional<Hash128> readHash(const QSqlQuery &query, const int column) {
+        if (query.value(column).isNull())
+            return std::nullopt;
+
+        return Hash128{static_cast<quint64>(query.value(column).toLongLong()),
+                       static_cast<quint64>(query.value(column + 1).toLongLong())};
+    }
+
+};
@@ -0,0 +1,400 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "constants/constants.h"
+#include "hash/hash128.h"
+#include "matchers/text_matcher.h"
+#include "utils/file_utils.h"
+#include "utils/stat_utils.h"
+
+#include <QDataStream>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtSql/QtSql>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+
+
+/**
+ * The Database_Results class is a persistent cache of the scan outcomes (occurrences & lines, or no match at all),
+ * stored in its own SQLite database. An outcome is keyed by the fingerprint of the scan (searched text & scanning
+ * options) and the path of the file, and stays valid while the inode, size & modification time of the file are
+ * unchanged: a search repeated over unchanged files reads none of them again.
+ *
+ * A worker thread owns the connection: it loads the outcomes of the fingerprint once, while the search is walking
+ * the directories, then writes the new outcomes by batches. The least recently used outcomes are evicted when the
+ * search ends, until the database fits RESULTS_CACHE_MAX_SIZE.
+ */
+class Database_Results {
+
+public:
+
+    struct Key {
+        QString path;
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 modifiedTimeNs = -1;
+    };
+
+    struct Outcome {
+        int occurrences = 0;                // UNPARSEABLE: the file was skipped as not being text
+        QSet<int> linesNumbers;
+        TermsBreakdown termsBreakdown;
+    };
+
+    static constexpr int UNPARSEABLE = -1;
+
+
+
+    // *******************************************************************************************************************
+    // ************************************************** Constructors ***************************************************
+    // *******************************************************************************************************************
+    /**
+     * Starts the worker, which opens the database & loads the outcomes of a scan. When it can't be opened, nothing is
+     * ever found nor written.
+     * @param fingerprint - Hash of everything a scan outcome depends on besides the file.
+     */
+    explicit Database_Results(const Hash128 &fingerprint) : m_fingerprint(fingerprint.toHex()) {
+
+        m_queryCreateTable = File_Utils::readFileFromResources(":/sql/resources/sql/results/create_table.sql");
+        m_queryCreateIndex = File_Utils::readFileFromResources(":/sql/resources/sql/results/create_index.sql");
+        m_queryLoad = File_Utils::readFileFromResources(":/sql/resources/sql/results/load.sql");
+        m_queryStore = File_Utils::readFileFromResources(":/sql/resources/sql/results/store.sql");
+        m_queryTouch = File_Utils::readFileFromResources(":/sql/resources/sql/results/touch.sql");
+        m_queryEvictLru = File_Utils::readFileFromResources(":/sql/resources/sql/results/evict_lru.sql");
+
+        m_connectionName = QString("Results Database %1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+
+        m_worker.reset(QThread::create([this]() { run(); }));
+        m_worker->start(QThread::LowPriority);
+    }
+
+
+    /**
+     * Writes the outcomes still waiting, evicts the least recently used ones, then stops the worker.
+     */
+    ~Database_Results() {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_wakeWorker.wakeOne();
+        }
+
+        m_worker->wait();
+    }
+
+    Database_Results(const Database_Results &) = delete;
+    Database_Results &operator=(const Database_Results &) = delete;
+
+
+
+    // *******************************************************************************************************************
+    // ************************************************ Lookups & Stores *************************************************
+    // *******************************************************************************************************************
+    static Key key(const QString &path, const FileStat &fileStat) {
+        return Key{path, fileStat.inode, fileStat.size, fileStat.modifiedTimeNs};
+    }
+
+
+    /**
+     * Looks the outcome of a file up, waiting for the outcomes to be loaded.
+     * @return - The outcome of the same scan of the file, none when the file is unknown or has changed since.
+     */
+    std::optional<Outcome> lookup(const Key &key) {
+
+        QMutexLocker locker(&m_mutex);
+
+        while (!m_loaded)
+            m_outcomesLoaded.wait(&m_mutex);
+
+        const auto it = m_outcomes.constFind(key.path);
+        if (it == m_outcomes.cend() || it->inode != key.inode || it->size != key.size
+            || it->modifiedTimeNs != key.modifiedTimeNs) {
+            m_misses++;
+            return std::nullopt;
+        }
+
+        m_hits++;
+        m_touches.append(key.path);
+        return it->outcome;
+    }
+
+
+    /**
+     * Keeps the outcome of a file, it is written with the next batch.
+     */
+    void store(const Key &key, const Outcome &outcome) {
+
+        QMutexLocker locker(&m_mutex);
+        if (m_failed)
+            return;
+
+        m_stores.append({key, outcome});
+        if (m_stores.size() >= RESULTS_CACHE_BATCH_SIZE)
+            m_wakeWorker.wakeOne();
+    }
+
+
+    qint64 hits() const {
+        return m_hits.load();
+    }
+
+    qint64 misses() const {
+        return m_misses.load();
+    }
+
+
+
+
+private:
+    static constexpr int EVICTION_CHUNK = 1000;             // Entries deleted at once
+
+    struct Entry {
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 modifiedTimeNs = -1;
+        Outcome outcome;
+    };
+
+    QString m_fingerprint;
+    QString m_connectionName;
+    std::unique_ptr<QThread> m_worker;
+
+    QString m_queryCreateTable;
+    QString m_queryCreateIndex;
+    QString m_queryLoad;
+    QString m_queryStore;
+    QString m_queryTouch;
+    QString m_queryEvictLru;
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeWorker;
+    QWaitCondition m_outcomesLoaded;
+    QHash<QString, Entry> m_outcomes;           // Of the fingerprint, by path
+    QVector<QPair<Key, Outcome>> m_stores;      // Waiting for a full batch
+    QStringList m_touches;                      // Paths of the outcomes used again, waiting for the next batch
+    bool m_loaded = false;
+    bool m_stopping = false;
+    bool m_failed = false;
+
+    std::atomic<qint64> m_hits = 0;
+    std::atomic<qint64> m_misses = 0;
+
+
+    /**
+     * The worker: opens the database, loads the outcomes, writes the new ones until stopped, then closes it.
+     */
+    void run() {
+        {
+            QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+            database.setDatabaseName(RESULTS_CACHE_FILE.absoluteFilePath());
+
+            const bool opened = openDatabase(database);
+            QHash<QString, Entry> outcomes = opened ? loadOutcomes(database) : QHash<QString, Entry>();
+
+            {
+                QMutexLocker locker(&m_mutex);
+                m_outcomes = std::move(outcomes);
+                m_loaded = true;
+                m_failed = !opened;
+                m_outcomesLoaded.wakeAll();
+            }
+
+            if (opened) {
+                serve(database);
+                evictLeastRecentlyUsed(database);
+            }
+
+            database.close();
+        }
+
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+
+    /**
+     * Opens the database in WAL mode & creates the table if needed.
+     *
+     * @return True if the database is ready, otherwise false.
+     */
+    bool openDatabase(QSqlDatabase &database) {
+
+        if (!database.open()) {
+            qDebug() << "Results Database not opened!";
+            return false;
+        }
+
+        // The outcomes can be computed again: a write lost on a power failure is no harm
+        QSqlQuery query(database);
+        if (!query.exec("PRAGMA journal_mode = WAL") || !query.exec("PRAGMA synchronous = NORMAL")
+            || !query.exec(m_queryCreateTable) || !query.exec(m_queryCreateIndex)) {
+            qDebug() << query.lastQuery();
+            qDebug() << query.lastError();
+            return false;
+        }
+
+        return true;
+    }
+
+
+    QHash<QString, Entry> loadOutcomes(QSqlDatabase &database) {
+
+        QHash<QString, Entry> outcomes;
+
+        QSqlQuery loadQuery(database);
+        loadQuery.setForwardOnly(true);
+        loadQuery.prepare(m_queryLoad);
+        loadQuery.bindValue(":C0", m_fingerprint);
+
+        if (!loadQuery.exec()) {
+            qDebug() << "Error executing query:" << loadQuery.lastError().text();
+            return outcomes;
+        }
+
+        while (loadQuery.next()) {
+            Entry entry;
+            entry.inode = static_cast<quint64>(loadQuery.value(1).toLongLong());
+            entry.size = loadQuery.value(2).toLongLong();
+            entry.modifiedTimeNs = loadQuery.value(3).toLongLong();
+            entry.outcome.occurrences = loadQuery.value(4).toInt();
+
+            const QByteArray details = loadQuery.value(5).toByteArray();
+            if (!details.isEmpty()) {
+                QDataStream stream(details);
+                stream >> entry.outcome.linesNumbers >> entry.outcome.termsBreakdown;
+            }
+
+            outcomes.insert(loadQuery.value(0).toString(), std::move(entry));
+        }
+
+        return outcomes;
+    }
+
+
+    void serve(QSqlDatabase &database) {
+
+        QSqlQuery storeQuery(database);
+        QSqlQuery touchQuery(database);
+        storeQuery.prepare(m_queryStore);
+        touchQuery.prepare(m_queryTouch);
+
+        QMutexLocker locker(&m_mutex);
+
+        forever {
+            if (m_stores.size() < RESULTS_CACHE_BATCH_SIZE && !m_stopping) {
+                if (m_wakeWorker.wait(&m_mutex, RESULTS_CACHE_FLUSH_INTERVAL)
+                    || (m_stores.isEmpty() && m_touches.isEmpty()))
+                    continue;
+            }
+
+            const QVector<QPair<Key, Outcome>> stores = std::exchange(m_stores, {});
+            const QStringList touches = std::exchange(m_touches, {});
+            locker.unlock();
+
+            const qint64 now = QDateTime::currentSecsSinceEpoch();
+            database.transaction();
+
+            for (const QPair<Key, Outcome> &store : stores)
+                storeOutcome(storeQuery, store.first, store.second, now);
+
+            // Used again: the most recently used
+            for (const QString &path : touches) {
+                touchQuery.bindValue(":C0", now);
+                touchQuery.bindValue(":C1", m_fingerprint);
+                touchQuery.bindValue(":C2", path);
+                touchQuery.exec();
+            }
+
+            if (!database.commit())
+                qDebug() << "Error committing the results:" << database.lastError().text();
+
+            locker.relock();
+
+            if (m_stopping && m_stores.isEmpty() && m_touches.isEmpty())
+                break;
+        }
+    }
+
+
+    void storeOutcome(QSqlQuery &storeQuery, const Key &key, const Outcome &outcome, const qint64 now) {
+
+        // Most files hold no match: no details to store
+        QByteArray details;
+        if (!outcome.linesNumbers.isEmpty() || !outcome.termsBreakdown.isEmpty()) {
+            QDataStream stream(&details, QIODevice::WriteOnly);
+            stream << outcome.linesNumbers << outcome.termsBreakdown;
+        }
+
+        storeQuery.bindValue(":C0", m_fingerprint);
+        storeQuery.bindValue(":C1", key.path);
+        storeQuery.bindValue(":C2", static_cast<qint64>(key.inode));
+        storeQuery.bindValue(":C3", key.size);
+        storeQuery.bindValue(":C4", key.modifiedTimeNs);
+        storeQuery.bindValue(":C5", outcome.occurrences);
+        storeQuery.bindValue(":C6", details);
+        storeQuery.bindValue(":C7", now);
+
+        if (!storeQuery.exec())
+            qDebug() << "Error storing results:" << storeQuery.lastError().text();
+    }
+
+
+    /**
+     * Deletes the least recently used outcomes, by chunks, until the database fits its budget.
+     */
+    void evictLeastRecentlyUsed(QSqlDatabase &database) {
+
+        QSqlQuery sizeQuery(database);
+        QSqlQuery evictQuery(database);
+        evictQuery.prepare(m_queryEvictLru);
+
+        forever {
+            // The pages freed by the deletions are reused, they don't count
+            if (!sizeQuery.exec("SELECT (page_count - freelist_count) * page_size "
+                                "FROM pragma_page_count(), pragma_freelist_count(), pragma_page_size()")
+                || !sizeQuery.next() || sizeQuery.value(0).toLongLong() <= RESULTS_CACHE_MAX_SIZE)
+                return;
+
+            sizeQuery.finish();
+
+            evictQuery.bindValue(":C0", EVICTION_CHUNK);
+            if (!evictQuery.exec() || evictQuery.numRowsAffected() == 0) {
+                qDebug() << "Error evicting results:" << evictQuery.lastError().text();
+                return;
+            }
+        }
+    }
+
+};
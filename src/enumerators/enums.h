@@ -123,7 +123,8 @@ enum IconType {
     COPY,
     TRASH,
     OPENFILES,
-    EDITFILE
+    EDITFILE,
+    REFRESH
 };
 
 
@@ -29,13 +29,22 @@
 #pragma once
 
 #include "enumerators/enums.h"
+#include "hash/hash128.h"
 #include "hash/murmurhash3.h"
 
 #include <QFile>
 #include <QCryptographicHash>
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QDebug>
 
+#include <algorithm>
+#include <limits>
+
+#ifdef TEXT_DIGGER_XXHASH
+#include <xxhash.h>
+#endif
+
 
 class ChecksumUtils {
 
@@ -49,6 +58,57 @@ public:
     };
 
 
+    /**
+     * Incremental content hash: the hash of the pieces fed to update() is the one of calculateContentHash() of
+     * their concatenation. XXH3 (128 bits) when the xxHash library is available, else MurmurHash3 (x64, 128 bits).
+     */
+    class ContentHasher {
+
+    public:
+        ContentHasher() {
+#ifdef TEXT_DIGGER_XXHASH
+            m_state = XXH3_createState();
+            XXH3_128bits_reset(m_state);
+#endif
+        }
+
+        ~ContentHasher() {
+#ifdef TEXT_DIGGER_XXHASH
+            XXH3_freeState(m_state);
+#endif
+        }
+
+        ContentHasher(const ContentHasher &) = delete;
+        ContentHasher &operator=(const ContentHasher &) = delete;
+
+        void update(const void *data, const size_t length) {
+#ifdef TEXT_DIGGER_XXHASH
+            XXH3_128bits_update(m_state, data, length);
+#else
+            m_stream.update(data, length);
+#endif
+        }
+
+        Hash128 final() const {
+#ifdef TEXT_DIGGER_XXHASH
+            const XXH128_hash_t hash = XXH3_128bits_digest(m_state);
+            return Hash128{hash.low64, hash.high64};
+#else
+            uint64_t hash[2];
+            m_stream.final(hash);
+            return Hash128{hash[0], hash[1]};
+#endif
+        }
+
+    private:
+#ifdef TEXT_DIGGER_XXHASH
+        XXH3_state_t *m_state;
+#else
+        MurmurHash3::Stream_x64_128 m_stream;
+#endif
+    };
+
+
     // *******************************************************************************************************************
     // ******************************************* QByteArray Hash Calculation *******************************************
     // *******************************************************************************************************************
@@ -109,7 +169,8 @@ public:
     }
 
     /**
-     * Calculates a MurmurHash3 hash of an open QFile object in chunks.
+     * Calculates a MurmurHash3 hash of an open QFile object, from its current position to its end. The content is
+     * hashed as a single message, mapped or read in chunks, so the hash is the one of the content in memory.
      * Supports three MurmurHash3 variants.
      * @param file - Reference to an open QFile object.
      * @param hashType - Type of MurmurHash3 to use.
@@ -118,8 +179,6 @@ public:
      */
     static QString calculateMurmurHash3(QFile &file, MurmurHash3Type hashType, const bool closeFile) {
 
-        const int chunkSize = 1024 * 1024; // 1MB chunks
-        QByteArray chunk;
         QString hashStr;
 
         if (!file.isOpen() && !file.open(QIODevice::ReadOnly)) {
@@ -135,22 +194,32 @@ public:
             return QString("");
         }
 
-        // Calculate hash based on the specified MurmurHash3 type
+        // From the current position to the end, the pseudo-files of size 0 being read up to their end
+        const qint64 offset = file.pos();
+        const qint64 length = file.size() > 0 ? file.size() - offset : -1;
+
+        // Calculate hash based on the specified MurmurHash3 type, the whole content being a single message
         switch (hashType) {
         case MURMUR_X86_32: {
-            uint32_t hash = 0; // Initial seed
+            MurmurHash3::Stream_x86_32 stream(0);
+            uint32_t hash = 0;
 
-            while (!(chunk = file.read(chunkSize)).isEmpty())
-                MurmurHash3::MurmurHash3_x86_32(chunk.constData(), chunk.size(), hash, &hash);
+            if (!hashFileRange(file, offset, length, stream))
+                break;
+
+            stream.final(&hash);
 
             hashStr = QString::number(hash, 16).rightJustified(8, '0'); // Ensure 8 hex digits
             break;
         }
         case MURMUR_X86_128: {
-            uint32_t hash[4] = {0}; // Initial seed
+            MurmurHash3::Stream_x86_128 stream(0);
+            uint32_t hash[4] = {0};
+
+            if (!hashFileRange(file, offset, length, stream))
+                break;
 
-            while (!(chunk = file.read(chunkSize)).isEmpty())
-                MurmurHash3::MurmurHash3_x86_128(chunk.constData(), chunk.size(), 0, hash);
+            stream.final(hash);
 
             hashStr = QString("%1%2%3%4")
                           .arg(QString::number(hash[0], 16).rightJustified(8, '0'),
@@ -161,10 +230,13 @@ public:
             break;
         }
         case MURMUR_X64_128: {
-            uint64_t hash[2] = {0}; // Initial seed
+            MurmurHash3::Stream_x64_128 stream(0);
+            uint64_t hash[2] = {0};
 
-            while (!(chunk = file.read(chunkSize)).isEmpty())
-                MurmurHash3::MurmurHash3_x64_128(chunk.constData(), chunk.size(), 0, hash);
+            if (!hashFileRange(file, offset, length, stream))
+                break;
+
+            stream.final(hash);
 
             hashStr = QString("%1%2")
                           .arg(QString::number(hash[0], 16).rightJustified(16, '0'),
@@ -184,10 +256,112 @@ public:
             file.close(); // Close the file once after processing
         }
 
+        if (hashStr.isEmpty())
+            qWarning() << "Failed to read file";
+
         return hashStr;
     }
 
 
+    /**
+     * Feeds a range of an open file to a hash stream (MurmurHash3 or ContentHasher). The range is hashed from a map
+     * of the file when possible, without any copy, else read piece by piece into a single buffer.
+     * @param file - The open file.
+     * @param offset - The start of the range.
+     * @param length - The length of the range, negative to read up to the end (e.g. a pipe or a pseudo-file).
+     * @param stream - The hash stream, having update(const void *data, size_t length).
+     * @return - false if the range could not be read whole.
+     */
+    template <typename Stream>
+    static bool hashFileRange(QFile &file, const qint64 offset, const qint64 length, Stream &stream) {
+
+        constexpr qint64 readSize = 1024 * 1024; // 1MB pieces, when the file can't be mapped
+
+        if (length > 0 && !file.isSequential()) {
+            if (uchar *mappedData = file.map(offset, length)) {
+                stream.update(mappedData, static_cast<size_t>(length));
+                file.unmap(mappedData);
+                return true;
+            }
+        }
+
+        if (!file.isSequential() && file.pos() != offset && !file.seek(offset))
+            return false;
+
+        QByteArray buffer(length < 0 ? readSize : std::min(length, readSize), Qt::Uninitialized);
+        qint64 remaining = length < 0 ? std::numeric_limits<qint64>::max() : length;
+
+        while (remaining > 0) {
+            const qint64 bytesRead = file.read(buffer.data(), std::min<qint64>(remaining, buffer.size()));
+            if (bytesRead <= 0)
+                return bytesRead == 0 && length < 0;
+
+            stream.update(buffer.constData(), static_cast<size_t>(bytesRead));
+            remaining -= bytesRead;
+        }
+
+        return true;
+    }
+
+
+
+
+    /**
+     * Calculates a MurmurHash3 (x64, 128 bits) hash of data already in memory (e.g. a file read at once or mapped).
+     * @param data - The data to hash.
+     * @return - The calculated hash.
+     */
+    static Hash128 calculateMurmurHash3_x64_128(const QByteArrayView &data) {
+        MurmurHash3::Stream_x64_128 stream(0);
+        stream.update(data.data(), static_cast<size_t>(data.size()));
+
+        uint64_t hash[2];
+        stream.final(hash);
+        return Hash128{hash[0], hash[1]};
+    }
+
+
+#ifdef TEXT_DIGGER_XXHASH
+    /**
+     * Calculates a XXH3 (128 bits) hash of data already in memory. xxHash picks the widest vector instructions
+     * of the processor (SSE2, AVX2, AVX-512, NEON) at run time.
+     * @param data - The data to hash.
+     * @return - The calculated hash.
+     */
+    static Hash128 calculateXXH3_128(const QByteArrayView &data) {
+        const XXH128_hash_t hash = XXH3_128bits(data.data(), static_cast<size_t>(data.size()));
+        return Hash128{hash.low64, hash.high64};
+    }
+#endif
+
+
+    /**
+     * Calculates the hash telling the contents apart (e.g. the duplicate files), so that it can be hashed from the
+     * buffer that is being scanned: XXH3 (128 bits) when the xxHash library is available, else MurmurHash3 (x64,
+     * 128 bits). The hashes of the two algorithms differ, they must not be compared.
+     * @param data - The data to hash.
+     * @return - The calculated hash.
+     */
+    static Hash128 calculateContentHash(const QByteArrayView &data) {
+#ifdef TEXT_DIGGER_XXHASH
+        return calculateXXH3_128(data);
+#else
+        return calculateMurmurHash3_x64_128(data);
+#endif
+    }
+
+    /**
+     * @return - The name of the algorithm of calculateContentHash().
+     */
+    static QString contentHashAlgorithm() {
+#ifdef TEXT_DIGGER_XXHASH
+        return QStringLiteral("XXH3-128");
+#else
+        return QStringLiteral("MurmurHash3 x64-128");
+#endif
+    }
+
+
 
 
     // *******************************************************************************************************************
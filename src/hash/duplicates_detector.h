@@ -0,0 +1,425 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "databases/database_hashes.h"
+#include "hash/checksum_utils.h"
+#include "hash/hash128.h"
+#include "utils/stat_utils.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+
+#include <optional>
+#include <utility>
+
+
+/**
+ * Finds the files whose content was already seen, reading as little as possible. The tiers, in order:
+ *  1. the hard links of a seen file, by device & inode, nothing is read;
+ *  2. the files whose size was never seen, nothing is read either;
+ *  3. a hash of the first & last 64 KiB, for the files sharing a size (the files seen before included);
+ *  4. a hash of the whole content, for the files whose partial hash still collides.
+ * A file whose whole content was hashed along its scan skips tier 3 against the files hashed whole as well.
+ * The hashes are computed lazily (a file seen first is only read once another file shares its size) and outside
+ * the lock, so the detector can be shared by the threads of a search. With a cache, the hashes of the files
+ * unchanged since a previous search are taken from it rather than read. The files may be inserted in any order, e.g.
+ * by concurrent scanners: to keep the same file of a content whatever the order, the smallest path can be preferred.
+ */
+class DuplicatesDetector {
+
+public:
+
+    struct Verdict {
+        bool duplicate = false;
+        QString originalPath;               // The file seen first with this content, when known
+        bool originalNewlyDuplicated = false;   // The original had no duplicate so far
+        QString replacedPath;               // The original the file took the place of, as its path sorts first
+    };
+
+
+    /**
+     * @param cache - The persistent hashes, consulted before reading a file & fed with the new hashes. Must outlive
+     *                the insertions, nullptr for none.
+     */
+    void setCache(Database_Hashes *cache) {
+        QMutexLocker locker(&m_mutex);
+        m_cache = cache;
+    }
+
+
+    /**
+     * Checks a file against the files seen so far, and records it if its content is new.
+     * @param filePath - The file.
+     * @param fileStat - Its metadata: the size, the device & the inode (0 when unknown).
+     * @param contentHash - The ChecksumUtils::calculateContentHash() of the whole content if already known, e.g. computed
+     *                      while scanning the file.
+     * @param keepSmallestPath - A duplicate whose path sorts before its original's replaces it as the kept file.
+     * @return - Whether the file duplicates one seen before, and which one.
+     */
+    Verdict insert(const QString &filePath, const FileStat &fileStat,
+                   const std::optional<Hash128> &contentHash = std::nullopt, const bool keepSmallestPath = false) {
+
+        QMutexLocker locker(&m_mutex);
+        m_insertedFiles++;
+
+
+        // --------------------------
+        // Tier 1: the hard links share the device & inode numbers
+        // --------------------------
+        const QPair<quint64, quint64> identity(fileStat.device, fileStat.inode);
+        const bool hasIdentity = fileStat.inode != 0;
+
+        if (hasIdentity) {
+            const auto it = m_identities.constFind(identity);
+            if (it != m_identities.constEnd()) {
+                m_hardLinks++;
+                return duplicateOf(*it, filePath, fileStat, keepSmallestPath);
+            }
+        }
+
+
+        // --------------------------
+        // Tier 2: a size seen for the first time can't be a duplicate
+        // --------------------------
+        Entry candidate;
+        candidate.path = filePath;
+        candidate.size = fileStat.size;
+        candidate.fileStat = fileStat;
+        candidate.wholeHash = contentHash;
+
+        if (!m_sizes.contains(fileStat.size))
+            return keep(std::move(candidate), hasIdentity, identity);
+
+
+        // --------------------------
+        // Tiers 3 & 4: hash the candidate & the files of the same size, as far as needed
+        // --------------------------
+        const bool partialIsWhole = fileStat.size <= 2 * PARTIAL_SIZE;
+
+        if (partialIsWhole && candidate.wholeHash)
+            candidate.partialHash = candidate.wholeHash;
+
+        forever {
+            const QVector<qsizetype> &sameSize = m_sizes.value(fileStat.size);
+
+            // A candidate hashed whole along its scan is compared on the whole hash to the entries hashed whole
+            if (candidate.wholeHash) {
+                const qsizetype original = m_wholeHashes.find(*candidate.wholeHash);
+                if (original >= 0) {
+                    if (hasIdentity)
+                        m_identities.insert(identity, original);
+
+                    return duplicateOf(original, filePath, fileStat, keepSmallestPath);
+                }
+            }
+
+            QVector<qsizetype> pending;
+            for (const qsizetype index : sameSize)
+                if (!candidate.wholeHash || !m_entries.at(index).wholeHash)
+                    pending.append(index);
+
+            if (pending.isEmpty())
+                return keep(std::move(candidate), hasIdentity, identity);
+
+            // Tier 3: the partial hashes, of the entries still in question only
+            QVector<qsizetype> missing;
+            for (const qsizetype index : std::as_const(pending))
+                if (!m_entries.at(index).partialHash)
+                    missing.append(index);
+
+            if (!missing.isEmpty() || !candidate.partialHash) {
+                hashEntries(locker, missing, candidate, false);
+                continue;
+            }
+
+            QVector<qsizetype> matches;
+            for (const qsizetype index : std::as_const(pending))
+                if (*m_entries.at(index).partialHash == *candidate.partialHash)
+                    matches.append(index);
+
+            if (matches.isEmpty())
+                return keep(std::move(candidate), hasIdentity, identity);
+
+            // Tier 4: the whole content (already hashed by the partial hash of the small files)
+            if (partialIsWhole) {
+                candidate.wholeHash = candidate.partialHash;
+            } else {
+                missing.clear();
+                for (const qsizetype index : std::as_const(matches))
+                    if (!m_entries.at(index).wholeHash)
+                        missing.append(index);
+
+                if (!missing.isEmpty() || !candidate.wholeHash) {
+                    hashEntries(locker, missing, candidate, true);
+                    continue;
+                }
+            }
+
+            const qsizetype original = m_wholeHashes.find(*candidate.wholeHash);
+            if (original < 0)
+                return keep(std::move(candidate), hasIdentity, identity);
+
+            if (hasIdentity)
+                m_identities.insert(identity, original);
+
+            return duplicateOf(original, filePath, fileStat, keepSmallestPath);
+        }
+    }
+
+
+    /**
+     * @return - true if a file of this size was seen: its content would then better be hashed along its scan.
+     */
+    bool sizeSeen(const qint64 size) const {
+        QMutexLocker locker(&m_mutex);
+        return m_sizes.contains(size);
+    }
+
+
+    qint64 insertedFiles() const { QMutexLocker locker(&m_mutex); return m_insertedFiles; }
+    qint64 hashedBytes() const { QMutexLocker locker(&m_mutex); return m_hashedBytes; }
+    qint64 hashingTime() const { QMutexLocker locker(&m_mutex); return m_hashingTime; }
+    qint64 cacheHits() const { QMutexLocker locker(&m_mutex); return m_cacheHits; }
+    qint64 hardLinks() const { QMutexLocker locker(&m_mutex); return m_hardLinks; }
+    qint64 duplicates() const { QMutexLocker locker(&m_mutex); return m_duplicates; }
+
+
+
+private:
+    static constexpr qint64 PARTIAL_SIZE = 64 * 1024;     // Hashed at the start & at the end of the file
+
+    struct Entry {
+        QString path;
+        qint64 size = 0;
+        FileStat fileStat;                  // Keys the cached hashes
+        std::optional<Hash128> partialHash;
+        std::optional<Hash128> wholeHash;
+        bool duplicated = false;
+    };
+
+    mutable QMutex m_mutex;
+    QVector<Entry> m_entries;                           // The files kept, i.e. the contents seen
+    QHash<qint64, QVector<qsizetype>> m_sizes;          // Entries per size
+    QHash<QPair<quint64, quint64>, qsizetype> m_identities;     // Entry per device & inode
+    Hash128Table m_wholeHashes;                         // Entry per whole content hash
+    Database_Hashes *m_cache = nullptr;
+
+    qint64 m_insertedFiles = 0;
+    qint64 m_hashedBytes = 0;
+    qint64 m_hashingTime = 0;                           // Reading & hashing, cumulated over the threads, in microseconds
+    qint64 m_cacheHits = 0;                             // Hashes found in the cache rather than computed
+    qint64 m_hardLinks = 0;
+    qint64 m_duplicates = 0;
+
+
+    Verdict keep(Entry &&candidate, const bool hasIdentity, const QPair<quint64, quint64> &identity) {
+
+        const qsizetype index = m_entries.size();
+
+        if (candidate.size <= 2 * PARTIAL_SIZE && candidate.partialHash)
+            candidate.wholeHash = candidate.partialHash;
+
+        if (candidate.wholeHash)
+            m_wholeHashes.insert(*candidate.wholeHash, index);
+
+        m_sizes[candidate.size].append(index);
+        m_entries.append(std::move(candidate));
+
+        if (hasIdentity)
+            m_identities.insert(identity, index);
+
+        return Verdict();
+    }
+
+
+    Verdict duplicateOf(const qsizetype index, const QString &filePath, const FileStat &fileStat,
+                        const bool keepSmallestPath) {
+
+        Entry &original = m_entries[index];
+        m_duplicates++;
+
+        Verdict verdict;
+
+        // The entry now stands for the file, its hashes are those of the same content
+        if (keepSmallestPath && filePath < original.path) {
+            verdict.replacedPath = std::exchange(original.path, filePath);
+            original.fileStat = fileStat;
+            return verdict;
+        }
+
+        verdict.duplicate = true;
+        verdict.originalPath = original.path;
+        verdict.originalNewlyDuplicated = !original.duplicated;
+        original.duplicated = true;
+        return verdict;
+    }
+
+
+    /**
+     * Computes the missing partial (or whole) hashes of the entries & of the candidate, the lock being released
+     * meanwhile. The cache is looked up for all of them at once, only the files it doesn't know are read. A file that
+     * can't be read gets a hash of its path, so it is only ever a duplicate of itself.
+     */
+    void hashEntries(QMutexLocker<QMutex> &locker, const QVector<qsizetype> &missing, Entry &candidate,
+                     const bool whole) {
+
+        // Copies of the entries to hash, the candidate last
+        QVector<Entry> files;
+        for (const qsizetype index : missing)
+            files.append(m_entries.at(index));
+
+        const bool hashCandidate = whole ? !candidate.wholeHash : !candidate.partialHash;
+        if (hashCandidate)
+            files.append(candidate);
+
+        const qint64 size = candidate.size;
+        Database_Hashes *cache = m_cache;
+
+        locker.unlock();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // --------------------------
+        // The cache first: the files unchanged since they were hashed are not read
+        // --------------------------
+        QVector<qsizetype> cacheable;
+        QVector<Database_Hashes::Key> keys;
+
+        if (cache) {
+            for (qsizetype i = 0; i < files.size(); ++i) {
+                if (Database_Hashes::isCacheable(files.at(i).fileStat)) {
+                    cacheable.append(i);
+                    keys.append(Database_Hashes::key(files.at(i).path, files.at(i).fileStat));
+                }
+            }
+        }
+
+        const QVector<Database_Hashes::Hashes> cached = cache ? cache->lookup(keys) : QVector<Database_Hashes::Hashes>();
+
+        qint64 cacheHits = 0;
+        for (qsizetype i = 0; i < cached.size(); ++i) {
+            Entry &file = files[cacheable.at(i)];
+            const std::optional<Hash128> &hash = whole ? cached.at(i).whole : cached.at(i).partial;
+
+            if (hash)
+                cacheHits++;
+
+            if (!file.partialHash)
+                file.partialHash = cached.at(i).partial;
+            if (!file.wholeHash)
+                file.wholeHash = cached.at(i).whole;
+        }
+
+
+        // --------------------------
+        // Then the files
+        // --------------------------
+        qint64 hashedBytes = 0;
+        qsizetype nextCacheable = 0;
+
+        for (qsizetype i = 0; i < files.size(); ++i) {
+            Entry &file = files[i];
+
+            const bool isCacheable = nextCacheable < cacheable.size() && cacheable.at(nextCacheable) == i;
+            if (isCacheable)
+                nextCacheable++;
+
+            if (whole ? file.wholeHash : file.partialHash)
+                continue;
+
+            const Hash128 hash = hashFile(file.path, size, whole, hashedBytes);
+            (whole ? file.wholeHash : file.partialHash) = hash;
+
+            if (size <= 2 * PARTIAL_SIZE)
+                file.wholeHash = file.partialHash = hash;
+
+            if (isCacheable)
+                cache->store(Database_Hashes::key(file.path, file.fileStat), {file.partialHash, file.wholeHash});
+        }
+
+        locker.relock();
+
+        m_hashedBytes += hashedBytes;
+        m_hashingTime += timer.nsecsElapsed() / 1000;
+        m_cacheHits += cacheHits;
+
+        for (qsizetype i = 0; i < missing.size(); ++i) {
+            Entry &entry = m_entries[missing.at(i)];
+
+            if (!entry.wholeHash && files.at(i).wholeHash) {
+                entry.wholeHash = files.at(i).wholeHash;
+                m_wholeHashes.insert(*entry.wholeHash, missing.at(i));
+            }
+
+            if (!entry.partialHash)
+                entry.partialHash = files.at(i).partialHash;
+        }
+
+        if (hashCandidate) {
+            candidate.partialHash = files.constLast().partialHash;
+            candidate.wholeHash = files.constLast().wholeHash;
+        }
+    }
+
+
+    /**
+     * @param whole - Hash the whole content, else its first & last PARTIAL_SIZE bytes (the whole content of the
+     *                small files).
+     */
+    static Hash128 hashFile(const QString &filePath, const qint64 size, const bool whole, qint64 &hashedBytes) {
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+            return ChecksumUtils::calculateContentHash(filePath.toUtf8());
+
+        // The ends are fed one after the other, each mapped when possible (no copy)
+        ChecksumUtils::ContentHasher hasher;
+        bool hashed;
+
+        if (!whole && size > 2 * PARTIAL_SIZE) {
+            hashed = ChecksumUtils::hashFileRange(file, 0, PARTIAL_SIZE, hasher)
+                     && ChecksumUtils::hashFileRange(file, size - PARTIAL_SIZE, PARTIAL_SIZE, hasher);
+            hashedBytes += 2 * PARTIAL_SIZE;
+        } else {
+            hashed = ChecksumUtils::hashFileRange(file, 0, size, hasher);
+            hashedBytes += size;
+        }
+
+        // A file that changed or can't be read whole only matches itself
+        return hashed ? hasher.final() : ChecksumUtils::calculateContentHash(filePath.toUtf8());
+    }
+
+};
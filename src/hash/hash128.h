@@ -0,0 +1,145 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+#include <utility>
+
+
+/**
+ * A 128-bit hash (e.g. MurmurHash3 x64_128 or XXH3-128), kept as two integers rather than as a hexadecimal string.
+ */
+struct Hash128 {
+    quint64 low = 0;
+    quint64 high = 0;
+
+    bool operator==(const Hash128 &other) const = default;
+
+    QString toHex() const {
+        return QString("%1%2").arg(QString::number(low, 16).rightJustified(16, '0'),
+                                   QString::number(high, 16).rightJustified(16, '0'));
+    }
+};
+
+
+/**
+ * Flat open addressing set of 128-bit hashes, each carrying an index (e.g. the file it was computed from).
+ * The keys live in a single array probed linearly, no node is allocated per key.
+ */
+class Hash128Table {
+
+public:
+
+    /**
+     * Inserts a hash unless it is already present.
+     * @param hash - The hash.
+     * @param index - The index carried by the hash, must be positive or null.
+     * @return - The index carried by the hash already present, or -1 if the hash was inserted.
+     */
+    qsizetype insert(const Hash128 &hash, const qsizetype index) {
+
+        if ((m_size + 1) * 2 > m_slots.size())
+            grow();
+
+        Slot &slot = m_slots[probe(hash)];
+        if (slot.index >= 0)
+            return slot.index;
+
+        slot.hash = hash;
+        slot.index = index;
+        m_size++;
+        return -1;
+    }
+
+
+    /**
+     * @return - The index carried by the hash, or -1 if it is not present.
+     */
+    qsizetype find(const Hash128 &hash) const {
+        return m_slots.isEmpty() ? -1 : m_slots.at(probe(hash)).index;
+    }
+
+
+    qsizetype size() const { return m_size; }
+
+
+
+private:
+    struct Slot {
+        Hash128 hash;
+        qsizetype index = -1;       // -1 marks a free slot
+    };
+
+    static constexpr qsizetype INITIAL_CAPACITY = 64;    // A power of two
+
+    QVector<Slot> m_slots;
+    qsizetype m_size = 0;
+
+
+    /**
+     * @return - The slot holding the hash, or the free slot ending its probe sequence.
+     */
+    qsizetype probe(const Hash128 &hash) const {
+
+        const qsizetype mask = m_slots.size() - 1;
+        qsizetype position = static_cast<qsizetype>(mix(hash) & static_cast<quint64>(mask));
+
+        while (m_slots.at(position).index >= 0 && !(m_slots.at(position).hash == hash))
+            position = (position + 1) & mask;
+
+        return position;
+    }
+
+
+    /**
+     * The content hashes are uniform already, the mix spreads the other keys (e.g. device & inode numbers).
+     */
+    static quint64 mix(const Hash128 &hash) {
+        quint64 h = hash.low ^ (hash.high * 0x9E3779B97F4A7C15ULL);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+
+    void grow() {
+
+        const QVector<Slot> slots = std::exchange(m_slots, QVector<Slot>(std::max(INITIAL_CAPACITY, m_slots.size() * 2)));
+
+        for (const Slot &slot : slots)
+            if (slot.index >= 0)
+                m_slots[probe(slot.hash)] = slot;
+    }
+
+};
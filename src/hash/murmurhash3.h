@@ -54,6 +54,8 @@
 #include <cstdint>
 #include <bit>
 #include <cstring>
+#include <algorithm>
+#include <cstddef>
 
 
 
@@ -181,30 +183,63 @@ class MurmurHash3 {
 
 public:
     //-----------------------------------------------------------------------------
-    //
+    // Incremental hashing: init(), update() with the content piece by piece, then
+    // final(). The hash is the one of the whole content whatever the sizes of the
+    // pieces, the bytes not filling a block are kept until the next update().
+    // The states are small and don't allocate, they can live on the stack.
     //-----------------------------------------------------------------------------
-    static void MurmurHash3_x86_32(const void* key, int len, std::uint32_t seed, void* out) {
+    class Stream_x86_32 {
+
+    public:
+        explicit Stream_x86_32(std::uint32_t seed = 0) {
+            init(seed);
+        }
 
-        const auto data = static_cast<const std::byte*>(key);
-        const int nblocks = len / 4;
+        void init(std::uint32_t seed) {
+            h1 = seed;
+            length = 0;
+            pending = 0;
+        }
+
+        void update(const void* key, std::size_t len) {
+            feed(*this, buffer, pending, length, static_cast<const std::byte*>(key), len);
+        }
 
-        std::uint32_t h1 = seed;
+        void final(void* out) const {
+            std::uint32_t h = h1;
+
+            // ------------------
+            // Tail
+            // ------------------
+            if (pending > 0) {
+                std::byte tail[BLOCK] = {};
+                std::memcpy(tail, buffer, pending);
+
+                std::uint32_t k1 = load32(tail);
+                k1 *= c1;
+                k1 = ROTL32(k1, 15);
+                k1 *= c2;
+                h ^= k1;
+            }
 
-        constexpr std::uint32_t c1 = 0xcc9e2d51;
-        constexpr std::uint32_t c2 = 0x1b873593;
+            // ------------------
+            // Finalization
+            // ------------------
+            h ^= static_cast<std::uint32_t>(length);
+            h = fmix32(h);
 
-        // ------------------
-        // Body
-        // ------------------
-        const auto blocks = reinterpret_cast<const std::uint32_t*>(data);
+            std::memcpy(out, &h, sizeof(h));
+        }
 
-        for (int i = 0; i < nblocks; ++i) {
-            std::uint32_t k1 = getblock32(blocks, i);
+    private:
+        friend class MurmurHash3;
 
-            // Convert endianness if necessary
-            if constexpr (std::endian::native != std::endian::little)
-                k1 = __builtin_bswap32(k1); // Swap bytes for big-endian
+        static constexpr std::size_t BLOCK = 4;
+        static constexpr std::uint32_t c1 = 0xcc9e2d51;
+        static constexpr std::uint32_t c2 = 0x1b873593;
 
+        void mixBlock(const std::byte* block) {
+            std::uint32_t k1 = load32(block);
 
             k1 *= c1;
             k1 = ROTL32(k1, 15);
@@ -215,70 +250,93 @@ public:
             h1 = h1 * 5 + 0xe6546b64;
         }
 
-        // ------------------
-        // Tail
-        // ------------------
-        const auto tail = data + nblocks * 4;
+        std::uint32_t h1;
+        std::uint64_t length;
+        std::size_t pending;
+        std::byte buffer[BLOCK];
+    };
 
-        std::uint32_t k1 = 0;
 
-        switch (len & 3) {
-        case 3: k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[2])) << 16; [[fallthrough]];
-        case 2: k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[1])) << 8; [[fallthrough]];
-        case 1: k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[0]));
-            k1 *= c1;
-            k1 = ROTL32(k1, 15);
-            k1 *= c2;
-            h1 ^= k1;
-            break;
-        }
+    class Stream_x86_128 {
 
-        // ------------------
-        // Finalization
-        // ------------------
-        h1 ^= len;
-        h1 = fmix32(h1);
+    public:
+        explicit Stream_x86_128(std::uint32_t seed = 0) {
+            init(seed);
+        }
 
-        *reinterpret_cast<std::uint32_t*>(out) = h1;
-    }
+        void init(std::uint32_t seed) {
+            h1 = h2 = h3 = h4 = seed;
+            length = 0;
+            pending = 0;
+        }
 
+        void update(const void* key, std::size_t len) {
+            feed(*this, buffer, pending, length, static_cast<const std::byte*>(key), len);
+        }
 
-    //-----------------------------------------------------------------------------
-    //
-    //-----------------------------------------------------------------------------
-    static void MurmurHash3_x86_128(const void* key, int len, std::uint32_t seed, void* out) {
-        const auto data = static_cast<const std::byte*>(key);
-        const int nblocks = len / 16;
-
-        std::uint32_t h1 = seed;
-        std::uint32_t h2 = seed;
-        std::uint32_t h3 = seed;
-        std::uint32_t h4 = seed;
-
-        constexpr std::uint32_t c1 = 0x239b961b;
-        constexpr std::uint32_t c2 = 0xab0e9789;
-        constexpr std::uint32_t c3 = 0x38b34ae5;
-        constexpr std::uint32_t c4 = 0xa1e38b93;
-
-        // ------------------
-        // Body
-        // ------------------
-        const auto blocks = reinterpret_cast<const std::uint32_t*>(data);
-
-        for (int i = 0; i < nblocks; ++i) {
-            std::uint32_t k1 = getblock32(blocks, i * 4 + 0);
-            std::uint32_t k2 = getblock32(blocks, i * 4 + 1);
-            std::uint32_t k3 = getblock32(blocks, i * 4 + 2);
-            std::uint32_t k4 = getblock32(blocks, i * 4 + 3);
-
-            // Convert endianness if necessary
-            if constexpr (std::endian::native != std::endian::little) {
-                k1 = __builtin_bswap32(k1); // Swap bytes for big-endian
-                k2 = __builtin_bswap32(k2);
-                k3 = __builtin_bswap32(k3);
-                k4 = __builtin_bswap32(k4);
+        void final(void* out) const {
+            std::uint32_t g1 = h1, g2 = h2, g3 = h3, g4 = h4;
+
+            // ------------------
+            // Tail (the missing bytes are zeros, as if the switch of the one-shot version stopped on them)
+            // ------------------
+            if (pending > 0) {
+                std::byte tail[BLOCK] = {};
+                std::memcpy(tail, buffer, pending);
+
+                std::uint32_t k1 = load32(tail);
+                std::uint32_t k2 = load32(tail + 4);
+                std::uint32_t k3 = load32(tail + 8);
+                std::uint32_t k4 = load32(tail + 12);
+
+                if (pending > 12) {
+                    k4 *= c4; k4 = ROTL32(k4, 18); k4 *= c1; g4 ^= k4;
+                }
+                if (pending > 8) {
+                    k3 *= c3; k3 = ROTL32(k3, 17); k3 *= c4; g3 ^= k3;
+                }
+                if (pending > 4) {
+                    k2 *= c2; k2 = ROTL32(k2, 16); k2 *= c3; g2 ^= k2;
+                }
+                k1 *= c1; k1 = ROTL32(k1, 15); k1 *= c2; g1 ^= k1;
             }
 
+            // ------------------
+            // Finalization
+            // ------------------
+            const auto len = static_cast<std::uint32_t>(length);
+            g1 ^= len; g2 ^= len; g3 ^= len; g4 ^= len;
+
+            g1 += g2; g1 += g3; g1 += g4;
+            g2 += g1; g3 += g1; g4 += g1;
+
+            g1 = fmix32(g1);
+            g2 = fmix32(g2);
+            g3 = fmix32(g3);
+            g4 = fmix32(g4);
+
+            g1 += g2; g1 += g3; g1 += g4;
+            g2 += g1; g3 += g1; g4 += g1;
+
+            const std::uint32_t hash[4] = {g1, g2, g3, g4};
+            std::memcpy(out, hash, sizeof(hash));
+        }
+
+    private:
+        friend class MurmurHash3;
+
+        static constexpr std::size_t BLOCK = 16;
+        static constexpr std::uint32_t c1 = 0x239b961b;
+        static constexpr std::uint32_t c2 = 0xab0e9789;
+        static constexpr std::uint32_t c3 = 0x38b34ae5;
+        static constexpr std::uint32_t c4 = 0xa1e38b93;
+
+        void mixBlock(const std::byte* block) {
+            std::uint32_t k1 = load32(block);
+            std::uint32_t k2 = load32(block + 4);
+            std::uint32_t k3 = load32(block + 8);
+            std::uint32_t k4 = load32(block + 12);
+
             k1 *= c1;
             k1 = ROTL32(k1, 15);
             k1 *= c2;
@@ -316,104 +374,85 @@ public:
             h4 = h4 * 5 + 0x32ac3b17;
         }
 
-        // ------------------
-        // Tail
-        // ------------------
-        const auto tail = data + nblocks * 16;
-
-        std::uint32_t k1 = 0;
-        std::uint32_t k2 = 0;
-        std::uint32_t k3 = 0;
-        std::uint32_t k4 = 0;
-
-        switch (len & 15) {
-        case 15: k4 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[14])) << 16; [[fallthrough]];
-        case 14: k4 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[13])) << 8; [[fallthrough]];
-        case 13: k4 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[12]));
-            k4 *= c4;
-            k4 = ROTL32(k4, 18);
-            k4 *= c1;
-            h4 ^= k4; [[fallthrough]];
+        std::uint32_t h1, h2, h3, h4;
+        std::uint64_t length;
+        std::size_t pending;
+        std::byte buffer[BLOCK];
+    };
 
-        case 12: k3 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[11])) << 24; [[fallthrough]];
-        case 11: k3 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[10])) << 16; [[fallthrough]];
-        case 10: k3 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[9])) << 8; [[fallthrough]];
-        case 9:  k3 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[8]));
-            k3 *= c3;
-            k3 = ROTL32(k3, 17);
-            k3 *= c4;
-            h3 ^= k3; [[fallthrough]];
 
-        case 8:  k2 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[7])) << 24; [[fallthrough]];
-        case 7:  k2 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[6])) << 16; [[fallthrough]];
-        case 6:  k2 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[5])) << 8; [[fallthrough]];
-        case 5:  k2 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[4]));
-            k2 *= c2;
-            k2 = ROTL32(k2, 16);
-            k2 *= c3;
-            h2 ^= k2; [[fallthrough]];
+    class Stream_x64_128 {
 
-        case 4:  k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[3])) << 24; [[fallthrough]];
-        case 3:  k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[2])) << 16; [[fallthrough]];
-        case 2:  k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[1])) << 8; [[fallthrough]];
-        case 1:  k1 ^= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(tail[0]));
-            k1 *= c1;
-            k1 = ROTL32(k1, 15);
-            k1 *= c2;
-            h1 ^= k1;
-            break;
+    public:
+        explicit Stream_x64_128(std::uint32_t seed = 0) {
+            init(seed);
         }
 
-        // ------------------
-        // Finalization
-        // ------------------
-        h1 ^= len; h2 ^= len; h3 ^= len; h4 ^= len;
-
-        h1 += h2; h1 += h3; h1 += h4;
-        h2 += h1; h3 += h1; h4 += h1;
+        void init(std::uint32_t seed) {
+            h1 = h2 = seed;
+            length = 0;
+            pending = 0;
+        }
 
-        h1 = fmix32(h1);
-        h2 = fmix32(h2);
-        h3 = fmix32(h3);
-        h4 = fmix32(h4);
+        void update(const void* key, std::size_t len) {
+            feed(*this, buffer, pending, length, static_cast<const std::byte*>(key), len);
+        }
 
-        h1 += h2; h1 += h3; h1 += h4;
-        h2 += h1; h3 += h1; h4 += h1;
+        void final(void* out) const {
+            std::uint64_t g1 = h1, g2 = h2;
+
+            // ------------------
+            // Tail (the missing bytes are zeros, as if the switch of the one-shot version stopped on them)
+            // ------------------
+            if (pending > 0) {
+                std::byte tail[BLOCK] = {};
+                std::memcpy(tail, buffer, pending);
+
+                std::uint64_t k1 = load64(tail);
+                std::uint64_t k2 = load64(tail + 8);
+
+                if (pending > 8) {
+                    k2 *= c2;
+                    k2 = ROTL64(k2, 33);
+                    k2 *= c1;
+                    g2 ^= k2;
+                }
+
+                k1 *= c1;
+                k1 = ROTL64(k1, 31);
+                k1 *= c2;
+                g1 ^= k1;
+            }
 
-        *reinterpret_cast<std::uint32_t*>(out) = h1;
-        *reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::byte*>(out) + 4) = h2;
-        *reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::byte*>(out) + 8) = h3;
-        *reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::byte*>(out) + 12) = h4;
-    }
+            // ------------------
+            // Finalization
+            // ------------------
+            g1 ^= length;
+            g2 ^= length;
 
+            g1 += g2;
+            g2 += g1;
 
-    //-----------------------------------------------------------------------------
-    //
-    //-----------------------------------------------------------------------------
-    static void MurmurHash3_x64_128(const void* key, int len, std::uint32_t seed, void* out) {
-        const auto data = static_cast<const std::byte*>(key);  // Cast to std::byte* for arithmetic
-        const int nblocks = len / 16;
+            g1 = fmix64(g1);
+            g2 = fmix64(g2);
 
-        std::uint64_t h1 = seed;
-        std::uint64_t h2 = seed;
+            g1 += g2;
+            g2 += g1;
 
-        constexpr std::uint64_t c1 = 0x87c37b91114253d5;
-        constexpr std::uint64_t c2 = 0x4cf5ad432745937f;
+            const std::uint64_t hash[2] = {g1, g2};
+            std::memcpy(out, hash, sizeof(hash));
+        }
 
-        // ------------------
-        // Body
-        // ------------------
-        const auto blocks = reinterpret_cast<const std::uint64_t*>(data);
+    private:
+        friend class MurmurHash3;
 
-        for (int i = 0; i < nblocks; ++i) {
-            std::uint64_t k1 = blocks[i * 2 + 0];
-            std::uint64_t k2 = blocks[i * 2 + 1];
+        static constexpr std::size_t BLOCK = 16;
+        static constexpr std::uint64_t c1 = 0x87c37b91114253d5;
+        static constexpr std::uint64_t c2 = 0x4cf5ad432745937f;
 
-            // Convert endianness if necessary
-            if constexpr (std::endian::native != std::endian::little) {
-                k1 = __builtin_bswap64(k1); // Swap bytes for big-endian
-                k2 = __builtin_bswap64(k2);
-            }
+        void mixBlock(const std::byte* block) {
+            std::uint64_t k1 = load64(block);
+            std::uint64_t k2 = load64(block + 8);
 
             k1 *= c1;
             k1 = ROTL64(k1, 31);
@@ -434,59 +473,93 @@ public:
             h2 = h2 * 5 + 0x38495ab5;
         }
 
-        // ------------------
-        // Tail
-        // ------------------
-        const auto tail = data + nblocks * 16; // Use data which is now a byte pointer
-
-        std::uint64_t k1 = 0;
-        std::uint64_t k2 = 0;
-
-        switch (len & 15) {
-        case 15: k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[14])) << 48; [[fallthrough]];
-        case 14: k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[13])) << 40; [[fallthrough]];
-        case 13: k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[12])) << 32; [[fallthrough]];
-        case 12: k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[11])) << 24; [[fallthrough]];
-        case 11: k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[10])) << 16; [[fallthrough]];
-        case 10: k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[9])) << 8; [[fallthrough]];
-        case 9:  k2 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[8]));
-            k2 *= c2;
-            k2 = ROTL64(k2, 33);
-            k2 *= c1;
-            h2 ^= k2; [[fallthrough]];
-
-        case 8:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[7])) << 56; [[fallthrough]];
-        case 7:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[6])) << 48; [[fallthrough]];
-        case 6:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[5])) << 40; [[fallthrough]];
-        case 5:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[4])) << 32; [[fallthrough]];
-        case 4:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[3])) << 24; [[fallthrough]];
-        case 3:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[2])) << 16; [[fallthrough]];
-        case 2:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[1])) << 8; [[fallthrough]];
-        case 1:  k1 ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(tail[0]));
-            k1 *= c1;
-            k1 = ROTL64(k1, 31);
-            k1 *= c2;
-            h1 ^= k1;
-            break;
-        }
+        std::uint64_t h1, h2;
+        std::uint64_t length;
+        std::size_t pending;
+        std::byte buffer[BLOCK];
+    };
 
-        // ------------------
-        // Finalization
-        // ------------------
-        h1 ^= len;
-        h2 ^= len;
 
-        h1 += h2;
-        h2 += h1;
 
-        h1 = fmix64(h1);
-        h2 = fmix64(h2);
+    //-----------------------------------------------------------------------------
+    // One-shot versions, for a content already in memory.
+    //-----------------------------------------------------------------------------
+    static void MurmurHash3_x86_32(const void* key, int len, std::uint32_t seed, void* out) {
+        Stream_x86_32 stream(seed);
+        stream.update(key, static_cast<std::size_t>(len));
+        stream.final(out);
+    }
 
-        h1 += h2;
-        h2 += h1;
+    static void MurmurHash3_x86_128(const void* key, int len, std::uint32_t seed, void* out) {
+        Stream_x86_128 stream(seed);
+        stream.update(key, static_cast<std::size_t>(len));
+        stream.final(out);
+    }
 
-        *reinterpret_cast<std::uint64_t*>(out) = h1;
-        *reinterpret_cast<std::uint64_t*>(reinterpret_cast<std::byte*>(out) + 8) = h2; // Fix pointer arithmetic for output
+    static void MurmurHash3_x64_128(const void* key, int len, std::uint32_t seed, void* out) {
+        Stream_x64_128 stream(seed);
+        stream.update(key, static_cast<std::size_t>(len));
+        stream.final(out);
+    }
+
+
+
+private:
+    //-----------------------------------------------------------------------------
+    // Little-endian block reads. std::memcpy allows the unaligned addresses of a
+    // piece in the middle of a file, the compilers turn it into a single load.
+    //-----------------------------------------------------------------------------
+    static std::uint32_t load32(const std::byte* bytes) {
+        std::uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+
+        if constexpr (std::endian::native != std::endian::little)
+            value = __builtin_bswap32(value); // Swap bytes for big-endian
+
+        return value;
+    }
+
+    static std::uint64_t load64(const std::byte* bytes) {
+        std::uint64_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+
+        if constexpr (std::endian::native != std::endian::little)
+            value = __builtin_bswap64(value);
+
+        return value;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // The block loop shared by the streams: completes the pending block first,
+    // mixes the whole blocks straight from the input, then keeps the remainder.
+    //-----------------------------------------------------------------------------
+    template <typename Stream, std::size_t BLOCK>
+    static void feed(Stream& stream, std::byte (&buffer)[BLOCK], std::size_t& pending, std::uint64_t& length,
+                     const std::byte* data, std::size_t len) {
+        length += len;
+
+        if (pending > 0) {
+            const std::size_t missing = std::min(len, BLOCK - pending);
+            std::memcpy(buffer + pending, data, missing);
+            pending += missing;
+            data += missing;
+            len -= missing;
+
+            if (pending < BLOCK)
+                return;
+
+            stream.mixBlock(buffer);
+            pending = 0;
+        }
+
+        for (; len >= BLOCK; data += BLOCK, len -= BLOCK)
+            stream.mixBlock(data);
+
+        if (len > 0) {
+            std::memcpy(buffer, data, len);
+            pending = len;
+        }
     }
 
 };
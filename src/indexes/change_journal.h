@@ -0,0 +1,258 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "constants/constants.h"
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * Records the paths changed under the directories walked by a search, so the next identical search only walks and
+ * scans those again. It watches each walked directory with inotify (no privileges needed) from a thread of its own.
+ *
+ * A changed file is recorded by path, a created, moved or deleted directory as a whole subtree. When the journal
+ * loses track (events queue overflow, no more watches available, too many changes), the whole watched tree is
+ * dirty: the changes are reported incomplete and the next search is a full one.
+ *
+ * Without inotify (other systems), the changes are always incomplete.
+ */
+class ChangeJournal {
+
+public:
+    struct Changes {
+        QSet<QString> files;            // Created, modified, deleted or moved files
+        QSet<QString> directories;      // Subtrees to walk again: created, deleted or moved directories
+        bool complete = false;          // false: anything may have changed
+    };
+
+
+    ChangeJournal() {
+#ifdef Q_OS_LINUX
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0) {
+            qWarning() << "Cannot watch the directories for changes: inotify_init1 failed";
+            return;
+        }
+
+        m_worker.reset(QThread::create([this]() { run(); }));
+        m_worker->start(QThread::LowPriority);
+#endif
+    }
+
+    ~ChangeJournal() {
+        m_stopping = true;
+
+        if (m_worker)
+            m_worker->wait();
+
+#ifdef Q_OS_LINUX
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+
+    ChangeJournal(const ChangeJournal &) = delete;
+    ChangeJournal &operator=(const ChangeJournal &) = delete;
+
+
+    bool isAvailable() const {
+        return m_fd >= 0;
+    }
+
+
+    /**
+     * Watches a directory (not its subdirectories), before it is enumerated so no change is missed.
+     * Called from the walker threads.
+     */
+    void watch(const QString &directory) {
+#ifdef Q_OS_LINUX
+        if (m_fd < 0)
+            return;
+
+        const int wd = inotify_add_watch(m_fd, QFile::encodeName(directory).constData(), WATCH_MASK);
+
+        QMutexLocker locker(&m_mutex);
+
+        if (wd < 0) {
+            // Typically ENOSPC, fs.inotify.max_user_watches being reached: the changes there would go unnoticed
+            if (!m_watchFailed)
+                qWarning() << "Cannot watch the directory" << directory << "for changes:" << strerror(errno);
+
+            m_watchFailed = true;
+            m_complete = false;
+            return;
+        }
+
+        m_directories.insert(wd, directory);
+#else
+        Q_UNUSED(directory)
+#endif
+    }
+
+
+    /**
+     * Removes all the watches & forgets the changes, before walking other directories.
+     */
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+
+#ifdef Q_OS_LINUX
+        for (auto it = m_directories.cbegin(); it != m_directories.cend(); ++it)
+            inotify_rm_watch(m_fd, it.key());
+#endif
+
+        m_directories.clear();
+        m_changes = Changes();
+        m_watchFailed = false;
+    }
+
+
+    /**
+     * @return - The changes recorded since the previous call, the journal starting a new record.
+     */
+    Changes takeChanges() {
+        QMutexLocker locker(&m_mutex);
+
+        Changes changes = std::move(m_changes);
+        changes.complete = m_complete && !m_watchFailed && isAvailable();
+
+        m_changes = Changes();
+        m_complete = true;
+        return changes;
+    }
+
+
+
+
+private:
+#ifdef Q_OS_LINUX
+    static constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB
+                                           | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF
+                                           | IN_ONLYDIR | IN_EXCL_UNLINK;
+#endif
+
+    int m_fd = -1;
+    std::unique_ptr<QThread> m_worker;
+    std::atomic<bool> m_stopping = false;
+
+    QMutex m_mutex;
+    QHash<int, QString> m_directories;      // Watch descriptor -> watched directory
+    Changes m_changes;
+    bool m_complete = false;                // Nothing was recorded yet
+    bool m_watchFailed = false;
+
+
+#ifdef Q_OS_LINUX
+    void run() {
+
+        // Large enough for many events at once, aligned for the inotify_event structures
+        alignas(struct inotify_event) char buffer[64 * 1024];
+
+        while (!m_stopping) {
+            struct pollfd pollFd = {m_fd, POLLIN, 0};
+            if (poll(&pollFd, 1, CHANGE_JOURNAL_POLL_INTERVAL) <= 0)
+                continue;
+
+            const ssize_t length = read(m_fd, buffer, sizeof(buffer));
+            if (length <= 0)
+                continue;
+
+            QMutexLocker locker(&m_mutex);
+
+            for (const char *pointer = buffer; pointer < buffer + length;) {
+                const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(pointer);
+                record(*event);
+                pointer += sizeof(struct inotify_event) + event->len;
+            }
+
+            if (m_changes.files.size() + m_changes.directories.size() > CHANGE_JOURNAL_MAX_ENTRIES) {
+                m_changes = Changes();
+                m_complete = false;
+            }
+        }
+    }
+
+
+    void record(const struct inotify_event &event) {
+
+        // The kernel dropped events: no telling what changed
+        if (event.mask & IN_Q_OVERFLOW) {
+            m_complete = false;
+            return;
+        }
+
+        const auto it = m_directories.constFind(event.wd);
+        if (it == m_directories.cend())
+            return;
+
+        const QString directory = it.value();
+
+        if (event.mask & IN_IGNORED) {
+            m_directories.remove(event.wd);
+            return;
+        }
+
+        // The watched directory itself was deleted or moved away
+        if (event.len == 0) {
+            if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                m_changes.directories.insert(directory);
+
+            return;
+        }
+
+        const QString name = QFile::decodeName(event.name);
+        const QString path = directory.endsWith('/') ? directory + name : directory + '/' + name;
+
+        if (event.mask & IN_ISDIR) {
+            if (event.mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB))
+                m_changes.directories.insert(path);
+        } else {
+            m_changes.files.insert(path);
+        }
+    }
+#endif
+
+};
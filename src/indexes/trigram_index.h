@@ -0,0 +1,671 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "constants/constants.h"
+#include "hash/checksum_utils.h"
+#include "operations/op_walk_directories.h"
+#include "utils/content_utils.h"
+#include "utils/stat_utils.h"
+
+#include <QBitArray>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+
+/**
+ * On-disk index of the trigrams (3 consecutive bytes) of the files under a root directory, like codesearch: a file
+ * lacking one of the trigrams of a literal can't hold it, so only the files holding them all need to be scanned.
+ *
+ * The index is a single file mapped in memory: a header, the files sorted by relative path (with the size & the
+ * modification time they had when indexed), the paths, the trigrams sorted with the offsets of their posting lists,
+ * then the posting lists themselves (ascending file numbers, delta & varint encoded).
+ * The ASCII letters are folded, so the index serves the case insensitive searches as well. The trigrams spanning a
+ * line break are left out, a searched literal never holds one.
+ *
+ * The index only rules files out: a file it doesn't know, that changed since, that isn't UTF-8 text or that is too
+ * big is always scanned.
+ */
+class TrigramIndex {
+
+public:
+
+    /**
+     * The trigrams a match holds: one alternative per literal of the search, a file may hold a match if it holds
+     * all the trigrams of one of them.
+     */
+    class Query {
+
+    public:
+        /**
+         * @param literals - The UTF-8 literals one of which any match holds (see TextMatcher::requiredLiterals()).
+         */
+        explicit Query(const QList<QByteArray> &literals) {
+
+            for (const QByteArray &literal : literals) {
+                QVector<quint32> trigrams;
+                forEachTrigram(literal.constData(), literal.size(), [&trigrams](const quint32 trigram) {
+                    trigrams.append(trigram);
+                });
+
+                std::sort(trigrams.begin(), trigrams.end());
+                trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+                // A literal shorter than a trigram matches everywhere: the index can't help
+                if (trigrams.isEmpty()) {
+                    m_alternatives.clear();
+                    return;
+                }
+
+                m_alternatives.append(trigrams);
+            }
+        }
+
+        bool isUsable() const {
+            return !m_alternatives.isEmpty();
+        }
+
+        const QVector<QVector<quint32>> &alternatives() const {
+            return m_alternatives;
+        }
+
+    private:
+        QVector<QVector<quint32>> m_alternatives;
+    };
+
+
+
+    // *******************************************************************************************************************
+    // **************************************************** Building *****************************************************
+    // *******************************************************************************************************************
+    /**
+     * @return - The file of the index of a root directory.
+     */
+    static QString indexPath(const QString &root) {
+        return INDEXES_DIR.filePath(ChecksumUtils::generateMurmurHash(QFileInfo(root).absoluteFilePath(), DirectoryPath)
+                                    + ".tdx");
+    }
+
+    /**
+     * @return - true if the root has no index yet, or an index older than TRIGRAM_INDEX_MAX_AGE hours.
+     */
+    static bool isOutdated(const QString &root) {
+        const QFileInfo indexInfo(indexPath(root));
+        return !indexInfo.isFile()
+               || indexInfo.lastModified().secsTo(QDateTime::currentDateTime()) > qint64(TRIGRAM_INDEX_MAX_AGE) * 3600;
+    }
+
+
+    /**
+     * Indexes the files under a root directory, the index replacing the previous one at once when complete.
+     * @param root - The root directory.
+     * @param threadsCount - The threads walking the directories & extracting the trigrams.
+     * @param cancel - Stops the building, the previous index being kept.
+     * @return - true if the index was written.
+     */
+    static bool build(const QString &root, const int threadsCount, const std::atomic<bool> &cancel) {
+
+        const QString rootPath = QFileInfo(root).absoluteFilePath();
+        const QString rootPrefix = prefixOf(rootPath);
+
+        // A file modified in the last seconds could change again within the same modification time
+        const qint64 racyLimitNs = (QDateTime::currentMSecsSinceEpoch() - RACY_DELAY) * 1000000;
+
+
+        // --------------------------
+        // The files, like the searches will see them (same walker, same metadata)
+        // --------------------------
+        QVector<Draft> drafts;
+        QMutex draftsMutex;
+
+        const PathTrie noExcludedDirectories;
+        WalkDirectories walker(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable | QDir::Hidden | QDir::NoSymLinks,
+                               QDir::Files | QDir::Readable | QDir::Hidden | QDir::NoSymLinks, noExcludedDirectories,
+                               true, 0, -1, false, 0, true, threadsCount, cancel);
+
+        walker.walk({rootPath}, {}, [&](const QString &filePath, const FileStat &fileStat) {
+            if (!filePath.startsWith(rootPrefix))
+                return true;
+
+            Draft draft;
+            draft.filePath = filePath;
+            draft.relativePath = filePath.mid(rootPrefix.size()).toUtf8();
+            draft.fileStat = fileStat.valid ? fileStat : Stat_Utils::fromFileInfo(QFileInfo(filePath));
+
+            QMutexLocker locker(&draftsMutex);
+            drafts.append(std::move(draft));
+            return true;
+        });
+
+        if (cancel)
+            return false;
+
+        std::sort(drafts.begin(), drafts.end(), [](const Draft &a, const Draft &b) {
+            return comparePaths(a.relativePath.constData(), a.relativePath.size(),
+                                b.relativePath.constData(), b.relativePath.size()) < 0;
+        });
+
+
+        // --------------------------
+        // The trigrams, each thread taking a contiguous range of files so its posting lists come out sorted
+        // --------------------------
+        const int workersCount = static_cast<int>(std::max<qsizetype>(1, std::min<qsizetype>(threadsCount, drafts.size())));
+        QVector<QHash<quint32, QVector<quint32>>> postings(workersCount);
+
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(workersCount);
+
+        Draft *draftsData = drafts.data();
+
+        for (int worker = 0; worker < workersCount; ++worker) {
+            const qsizetype first = drafts.size() * worker / workersCount;
+            const qsizetype last = drafts.size() * (worker + 1) / workersCount;
+            QHash<quint32, QVector<quint32>> *workerPostings = &postings[worker];
+
+            threadPool.start([draftsData, workerPostings, &cancel, first, last, racyLimitNs]() {
+                // One bit per trigram: the trigrams already listed for the current file
+                QVector<quint64> seen(TRIGRAMS_COUNT / 64, 0);
+                QVector<quint32> fileTrigrams;
+
+                for (qsizetype fileNumber = first; fileNumber < last && !cancel; ++fileNumber) {
+                    Draft &draft = draftsData[fileNumber];
+
+                    if (draft.fileStat.modifiedTimeNs >= racyLimitNs || !extractTrigrams(draft, seen.data(), fileTrigrams)) {
+                        draft.flags |= NOT_INDEXED;
+                        continue;
+                    }
+
+                    for (const quint32 trigram : std::as_const(fileTrigrams)) {
+                        (*workerPostings)[trigram].append(static_cast<quint32>(fileNumber));
+                        seen.data()[trigram / 64] = 0;
+                    }
+                }
+            });
+        }
+
+        threadPool.waitForDone();
+
+        if (cancel)
+            return false;
+
+        return write(indexPath(rootPath), rootPath, drafts, postings);
+    }
+
+
+
+    // *******************************************************************************************************************
+    // ***************************************************** Queries *****************************************************
+    // *******************************************************************************************************************
+    TrigramIndex() = default;
+    TrigramIndex(const TrigramIndex &) = delete;
+    TrigramIndex &operator=(const TrigramIndex &) = delete;
+
+    ~TrigramIndex() {
+        if (m_data)
+            m_file.unmap(const_cast<uchar *>(m_data));
+    }
+
+
+    /**
+     * Maps the index of a root directory.
+     * @return - false if there is no index, or an unreadable one.
+     */
+    bool open(const QString &root) {
+
+        m_root = QFileInfo(root).absoluteFilePath();
+        m_rootPrefix = prefixOf(m_root);
+
+        m_file.setFileName(indexPath(m_root));
+        if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(Header)))
+            return false;
+
+        m_data = m_file.map(0, m_file.size());
+        if (!m_data)
+            return false;
+
+        std::memcpy(&m_header, m_data, sizeof(Header));
+
+        const quint64 size = static_cast<quint64>(m_file.size());
+        const QByteArray rootPath = m_root.toUtf8();
+        const bool valid = std::memcmp(m_header.magic, MAGIC, sizeof(m_header.magic)) == 0
+                           && m_header.fileSize == size
+                           && m_header.filesOffset + quint64(m_header.filesCount) * sizeof(FileRecord) <= m_header.pathsOffset
+                           && m_header.pathsOffset + m_header.rootLength <= m_header.trigramsOffset
+                           && m_header.trigramsOffset + quint64(m_header.trigramsCount) * sizeof(TrigramRecord) <= m_header.postingsOffset
+                           && m_header.postingsOffset <= size
+                           && m_header.rootLength == quint64(rootPath.size())
+                           && std::memcmp(m_data + m_header.pathsOffset, rootPath.constData(), rootPath.size()) == 0;
+
+        if (!valid) {
+            qWarning() << "Invalid trigram index:" << m_file.fileName();
+            m_file.unmap(const_cast<uchar *>(m_data));
+            m_data = nullptr;
+            return false;
+        }
+
+        m_files = reinterpret_cast<const FileRecord *>(m_data + m_header.filesOffset);
+        m_trigrams = reinterpret_cast<const TrigramRecord *>(m_data + m_header.trigramsOffset);
+        m_candidates = QBitArray(m_header.filesCount, true);
+        return true;
+    }
+
+
+    const QString &root() const {
+        return m_root;
+    }
+
+    qsizetype filesCount() const {
+        return m_header.filesCount;
+    }
+
+    qsizetype candidatesCount() const {
+        return m_candidates.count(true);
+    }
+
+
+    /**
+     * Selects the files that may hold a match: the union over the alternatives of the intersection of the posting
+     * lists of their trigrams, the rarest trigrams first.
+     */
+    void select(const Query &query) {
+
+        m_candidates = QBitArray(m_header.filesCount, !query.isUsable());
+
+        for (const QVector<quint32> &alternative : query.alternatives()) {
+
+            QVector<const TrigramRecord *> records;
+            for (const quint32 trigram : alternative)
+                records.append(findTrigram(trigram));
+
+            // A trigram found nowhere: no file holds the literal
+            if (records.contains(nullptr))
+                continue;
+
+            std::sort(records.begin(), records.end(), [](const TrigramRecord *a, const TrigramRecord *b) {
+                return a->filesCount < b->filesCount;
+            });
+
+            QVector<quint32> files = decodePostings(*records.first());
+            for (qsizetype i = 1; i < records.size() && !files.isEmpty(); ++i) {
+                const QVector<quint32> others = decodePostings(*records.at(i));
+                QVector<quint32> intersection;
+                std::set_intersection(files.cbegin(), files.cend(), others.cbegin(), others.cend(),
+                                      std::back_inserter(intersection));
+                files = std::move(intersection);
+            }
+
+            for (const quint32 fileNumber : std::as_const(files))
+                m_candidates.setBit(fileNumber);
+        }
+    }
+
+
+    /**
+     * @param filePath - A file found under the root.
+     * @param fileStat - Its current metadata.
+     * @return - false only if the index knows the file, unchanged since, and rules it out.
+     */
+    bool mayMatch(const QString &filePath, const FileStat &fileStat) const {
+
+        if (!m_data || !fileStat.valid || !covers(filePath))
+            return true;
+
+        const QByteArray relativePath = filePath.mid(m_rootPrefix.size()).toUtf8();
+        const FileRecord *first = m_files;
+        const FileRecord *last = m_files + m_header.filesCount;
+
+        const FileRecord *record = std::lower_bound(first, last, relativePath, [this](const FileRecord &file, const QByteArray &path) {
+            return comparePaths(m_data + m_header.pathsOffset + file.pathOffset, file.pathLength,
+                                path.constData(), path.size()) < 0;
+        });
+
+        if (record == last || comparePaths(m_data + m_header.pathsOffset + record->pathOffset, record->pathLength,
+                                           relativePath.constData(), relativePath.size()) != 0)
+            return true;
+
+        if ((record->flags & NOT_INDEXED) || record->size != fileStat.size
+            || record->modifiedTimeNs != fileStat.modifiedTimeNs)
+            return true;
+
+        return m_candidates.testBit(record - first);
+    }
+
+
+    /**
+     * @return - true if the file is under the root of the index.
+     */
+    bool covers(const QString &filePath) const {
+        return filePath.size() > m_rootPrefix.size() && filePath.startsWith(m_rootPrefix);
+    }
+
+
+
+
+private:
+    static constexpr char MAGIC[8] = {'T', 'D', 'T', 'R', 'I', 'X', '0', '1'};
+    static constexpr quint32 TRIGRAMS_COUNT = 1 << 24;
+    static constexpr quint32 NOT_INDEXED = 1;       // Always scanned: not UTF-8 text, too big or modified lately
+    static constexpr qint64 RACY_DELAY = 2000;      // ms
+
+    struct Header {
+        char magic[8];
+        quint32 filesCount;
+        quint32 trigramsCount;
+        quint64 filesOffset;
+        quint64 pathsOffset;                        // The root first (rootLength bytes), then the relative paths
+        quint64 trigramsOffset;
+        quint64 postingsOffset;
+        quint64 fileSize;
+        quint32 rootLength;
+        quint32 reserved;
+    };
+
+    struct FileRecord {
+        quint32 pathOffset;                         // From the paths offset
+        quint32 pathLength;
+        qint64 size;
+        qint64 modifiedTimeNs;
+        quint32 flags;
+        quint32 reserved;
+    };
+
+    struct TrigramRecord {
+        quint32 trigram;
+        quint32 filesCount;
+        quint64 postingsOffset;                     // From the postings offset
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % 8 == 0);
+    static_assert(sizeof(FileRecord) == 32 && sizeof(TrigramRecord) == 16);
+
+    struct Draft {
+        QString filePath;
+        QByteArray relativePath;
+        FileStat fileStat;
+        quint32 flags = 0;
+    };
+
+    QString m_root;
+    QString m_rootPrefix;
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    Header m_header {};
+    const FileRecord *m_files = nullptr;
+    const TrigramRecord *m_trigrams = nullptr;
+    QBitArray m_candidates;
+
+
+    static QString prefixOf(const QString &root) {
+        return root.endsWith('/') ? root : root + '/';
+    }
+
+    static int comparePaths(const void *a, const qsizetype aSize, const void *b, const qsizetype bSize) {
+        const int result = std::memcmp(a, b, static_cast<size_t>(std::min(aSize, bSize)));
+        return result != 0 ? result : (aSize < bSize ? -1 : (aSize > bSize ? 1 : 0));
+    }
+
+
+    /**
+     * Calls `onTrigram` for each trigram of the bytes (ASCII letters folded), the trigrams spanning a line break
+     * excepted. A trigram is its 3 bytes as a 24-bit integer.
+     */
+    template <typename Callback>
+    static void forEachTrigram(const char *data, const qsizetype size, Callback &&onTrigram) {
+
+        quint32 trigram = 0;
+        int length = 0;
+
+        for (qsizetype i = 0; i < size; ++i) {
+            unsigned char byte = static_cast<unsigned char>(data[i]);
+
+            if (byte == '\n' || byte == '\r') {
+                length = 0;
+                continue;
+            }
+
+            if (byte >= 'A' && byte <= 'Z')
+                byte += 'a' - 'A';
+
+            trigram = ((trigram << 8) | byte) & (TRIGRAMS_COUNT - 1);
+            if (++length >= 3)
+                onTrigram(trigram);
+        }
+    }
+
+
+    /**
+     * Lists the distinct trigrams of a file, the `seenBits` being left set for the caller to clear.
+     * @return - false if the file is left out of the index (always scanned).
+     */
+    static bool extractTrigrams(const Draft &draft, quint64 *seenBits, QVector<quint32> &fileTrigrams) {
+
+        fileTrigrams.clear();
+
+        if (draft.fileStat.size > TRIGRAM_INDEX_MAX_FILE_SIZE)
+            return false;
+
+        QFile file(draft.filePath);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QByteArray content;
+        const qint64 size = file.size();
+        const uchar *mappedData = size > 0 ? file.map(0, size) : nullptr;
+        if (!mappedData)
+            content = file.readAll();
+
+        const char *data = mappedData ? reinterpret_cast<const char *>(mappedData) : content.constData();
+        const qsizetype dataSize = mappedData ? size : content.size();
+
+        // Only the UTF-8 text is searched as is, the other encodings are decoded by the scanner
+        const ContentClass contentClass = Content_Utils::classify(data, std::min(dataSize, Content_Utils::PEEK_SIZE),
+                                                                  dataSize > Content_Utils::PEEK_SIZE);
+        const bool indexable = contentClass.kind == ContentClass::Empty
+                               || (contentClass.kind == ContentClass::Text
+                                   && (contentClass.encoding == ContentClass::Ascii
+                                       || contentClass.encoding == ContentClass::Utf8
+                                       || contentClass.encoding == ContentClass::Utf8WithBom));
+
+        if (indexable) {
+            forEachTrigram(data, dataSize, [seenBits, &fileTrigrams](const quint32 trigram) {
+                quint64 &word = seenBits[trigram / 64];
+                const quint64 bit = quint64(1) << (trigram % 64);
+                if (!(word & bit)) {
+                    word |= bit;
+                    fileTrigrams.append(trigram);
+                }
+            });
+        }
+
+        if (mappedData)
+            file.unmap(const_cast<uchar *>(mappedData));
+
+        return indexable;
+    }
+
+
+    static void appendVarint(QByteArray &buffer, quint32 value) {
+        while (value >= 0x80) {
+            buffer.append(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.append(static_cast<char>(value));
+    }
+
+    template <typename T>
+    static void appendRaw(QByteArray &buffer, const T &value) {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static void alignTo8(QByteArray &buffer) {
+        while (buffer.size() % 8 != 0)
+            buffer.append('\0');
+    }
+
+
+    /**
+     * Writes the index, through a temporary file renamed once complete.
+     */
+    static bool write(const QString &path, const QString &rootPath, const QVector<Draft> &drafts,
+                      const QVector<QHash<quint32, QVector<quint32>>> &postings) {
+
+        // The trigrams of all the workers, each posting list being the concatenation of the workers' ones
+        QVector<quint32> trigrams;
+        for (const QHash<quint32, QVector<quint32>> &workerPostings : postings)
+            for (auto it = workerPostings.cbegin(); it != workerPostings.cend(); ++it)
+                trigrams.append(it.key());
+
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        QByteArray trigramsTable;
+        QByteArray postingsData;
+        trigramsTable.reserve(trigrams.size() * qsizetype(sizeof(TrigramRecord)));
+
+        for (const quint32 trigram : std::as_const(trigrams)) {
+            TrigramRecord record {trigram, 0, static_cast<quint64>(postingsData.size())};
+            quint32 previous = 0;
+
+            for (const QHash<quint32, QVector<quint32>> &workerPostings : postings) {
+                const auto it = workerPostings.constFind(trigram);
+                if (it == workerPostings.cend())
+                    continue;
+
+                for (const quint32 fileNumber : *it) {
+                    appendVarint(postingsData, fileNumber - previous);
+                    previous = fileNumber;
+                    record.filesCount++;
+                }
+            }
+
+            appendRaw(trigramsTable, record);
+        }
+
+
+        // --------------------------
+        // The files & their paths
+        // --------------------------
+        const QByteArray root = rootPath.toUtf8();
+        QByteArray paths = root;
+        QByteArray filesTable;
+        filesTable.reserve(drafts.size() * qsizetype(sizeof(FileRecord)));
+
+        for (const Draft &draft : drafts) {
+            FileRecord record {static_cast<quint32>(paths.size()), static_cast<quint32>(draft.relativePath.size()),
+                               draft.fileStat.size, draft.fileStat.modifiedTimeNs, draft.flags, 0};
+            appendRaw(filesTable, record);
+            paths.append(draft.relativePath);
+        }
+
+        alignTo8(paths);
+
+
+        // --------------------------
+        // Header, then the sections in order
+        // --------------------------
+        Header header {};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.filesCount = static_cast<quint32>(drafts.size());
+        header.trigramsCount = static_cast<quint32>(trigrams.size());
+        header.filesOffset = sizeof(Header);
+        header.pathsOffset = header.filesOffset + filesTable.size();
+        header.trigramsOffset = header.pathsOffset + paths.size();
+        header.postingsOffset = header.trigramsOffset + trigramsTable.size();
+        header.fileSize = header.postingsOffset + postingsData.size();
+        header.rootLength = static_cast<quint32>(root.size());
+
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Cannot write the trigram index" << path << ":" << file.errorString();
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        file.write(filesTable);
+        file.write(paths);
+        file.write(trigramsTable);
+        file.write(postingsData);
+        return file.commit();
+    }
+
+
+    const TrigramRecord *findTrigram(const quint32 trigram) const {
+        const TrigramRecord *last = m_trigrams + m_header.trigramsCount;
+        const TrigramRecord *record = std::lower_bound(m_trigrams, last, trigram, [](const TrigramRecord &a, const quint32 b) {
+            return a.trigram < b;
+        });
+
+        return (record != last && record->trigram == trigram) ? record : nullptr;
+    }
+
+
+    QVector<quint32> decodePostings(const TrigramRecord &record) const {
+
+        QVector<quint32> files;
+        files.reserve(record.filesCount);
+
+        const uchar *data = m_data + m_header.postingsOffset + record.postingsOffset;
+        const uchar *end = m_data + m_header.fileSize;
+        quint32 fileNumber = 0;
+
+        for (quint32 i = 0; i < record.filesCount && data < end; ++i) {
+            quint32 delta = 0;
+            int shift = 0;
+
+            while (data < end && (*data & 0x80) && shift < 28) {
+                delta |= quint32(*data++ & 0x7F) << shift;
+                shift += 7;
+            }
+
+            if (data < end)
+                delta |= quint32(*data++) << shift;
+
+            fileNumber += delta;
+            if (fileNumber >= m_header.filesCount)
+                break;
+
+            files.append(fileNumber);
+        }
+
+        return files;
+    }
+
+};
@@ -155,6 +155,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     ui->tableView_Results->setColumnHidden(7, true);
     ui->tableView_Results->setColumnHidden(9, true);
     ui->tableView_Results->setColumnHidden(11, true);
+    ui->tableView_Results->setColumnHidden(12, true);
 
 
     // -----------------------------------------
@@ -216,6 +217,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     ui->horizontalLayout_FindText->insertWidget(1, m_filterWidget_FindText);
     m_filterWidget_FindText->setText("jar");
     m_filterWidget_FindText->setToolTip(AppStrings::getString(StringType::TOOLTIP_FINDTEXT));
+    m_filterWidget_FindText->setMultipleTermsAvailable(true);
 
     m_filterWidget_Filenames = new FilterWidget;
     ui->gridLayout_Filenames->addWidget(m_filterWidget_Filenames, 0, 1);
@@ -265,6 +267,12 @@ void MainWindow::quitApp() {
 
 void MainWindow::closeEvent(QCloseEvent *event) {
     // Task to do before closing window
+    if (m_isRescanning) {
+        m_rescanResultsWorker->cancel();
+        m_rescanResultsThread->quit();
+        m_rescanResultsThread->wait();
+    }
+
     saveSettings_ToDatabase();
     event->accept();
 }
@@ -638,6 +646,17 @@ void MainWindow::setConnections() {
     connect(ui->checkBox_FindExactFilename, &QCheckBox::toggled,
             m_filterWidget_Filenames, &FilterWidget::disablePatternsActions);
 
+    // Dropping the duplicates & listing them only are exclusive
+    connect(ui->checkBox_AvoidDuplicateFiles, &QCheckBox::toggled, this, [this](const bool checked) {
+        if (checked)
+            ui->checkBox_ListDuplicateFilesOnly->setChecked(false);
+    });
+
+    connect(ui->checkBox_ListDuplicateFilesOnly, &QCheckBox::toggled, this, [this](const bool checked) {
+        if (checked)
+            ui->checkBox_AvoidDuplicateFiles->setChecked(false);
+    });
+
     connect(ui->checkBox_FileReadingTimeout, &QCheckBox::toggled, this, [this](const bool checked) {
         ui->spinBox_FileReadingTimeout->setEnabled(checked);
     });
@@ -653,21 +672,10 @@ void MainWindow::setConnections() {
     connect(ui->btn_ShowStatistics, &QPushButton::clicked, this, &MainWindow::showStatistics);
 
     connect(ui->btn_RescanResults, &QPushButton::clicked, this, [this]() {
-
-        m_elapsedTimer.start();
-        m_statsStartTime = QTime::currentTime().toString("hh:mm:ss");
-        m_statsEndTime = "";
-        m_statsElapsed = "";
-
-        m_resultsModel->rescan(ui->checkBox_FileReadingTimeout->isChecked(),
-                               ui->spinBox_FileReadingTimeout->value(),
-                               ui->checkBox_OccurrencesFoundLimit->isChecked(),
-                               ui->spinBox_OccurrencesFoundLimit->value(),
-                               !m_filterWidget_FindText->dontMatch());
-
-        m_statsElapsed = DateTime_Utils::formatElapsedTime(m_elapsedTimer.elapsed());
-        m_statsEndTime = QTime::currentTime().toString("hh:mm:ss");
-
+        if (m_isRescanning)
+            cancelRescan();
+        else
+            startRescan();
     });
 
     connect(ui->actionImport_Results, &QAction::triggered, this, [this]() {
@@ -695,6 +703,10 @@ void MainWindow::setConnections() {
 // *********************************************************************************************************************
 void MainWindow::startSearch() {
 
+    // A new search would replace the results being rescanned
+    if (m_isRescanning)
+        return;
+
     if (m_isSearching) {
         // If a search is already running, cancel it first
         cancelSearch();
@@ -733,6 +745,7 @@ void MainWindow::startSearch() {
     m_findExactFilename = ui->checkBox_FindExactFilename->isChecked();
     m_ignoreUnparseableFiles = ui->checkBox_IgnoreUnparseableFiles->isChecked();
     m_avoidDuplicates = ui->checkBox_AvoidDuplicateFiles->isChecked();
+    m_listDuplicatesOnly = ui->checkBox_ListDuplicateFilesOnly->isChecked();
 
     m_sizeSystem = ui->comboBox_SizeSystems->currentText();
     m_sizeCondition = ui->comboBox_SizeConditions->currentText();
@@ -748,7 +761,7 @@ void MainWindow::startSearch() {
     m_lastModificationDate_2 = ui->dateTimeEdit_LastModificationDate_2->dateTime();
     m_lastAccessDateCondition = ui->comboBox_LastAccessDateConditions->currentText();
     m_lastAccessDate_1 = ui->dateTimeEdit_LastAccessDate_1->dateTime();
-    m_lastAccessDate_2 = ui->dateTimeEdit_LastAccessDate_1->dateTime();
+    m_lastAccessDate_2 = ui->dateTimeEdit_LastAccessDate_2->dateTime();
     m_ignoreHiddenFiles = ui->checkBox_IgnoreHiddenFiles->isChecked();
 
     const bool filterBySize = ui->checkBox_Size->isChecked();
@@ -774,16 +787,48 @@ void MainWindow::startSearch() {
     // Initialize Search Text variable
     // --------------------------
     QString searchText = m_filterWidget_FindText->text();
+    const QString fixedText = searchText.normalized(QString::NormalizationForm_D);
     FilterWidget::PatternSyntax patternSyntax_SearchText = m_filterWidget_FindText->patternSyntax();
+    const bool matchWholeWords = ui->checkBox_MatchWholeWords->isChecked();
+
+    QStringList searchTerms;
 
-    if (patternSyntax_SearchText == FilterWidget::Wildcard)
+    if (patternSyntax_SearchText == FilterWidget::Wildcard) {
         searchText = QRegularExpression::wildcardToRegularExpression(searchText);
-    else if (patternSyntax_SearchText == FilterWidget::FixedString)
+
+    } else if (patternSyntax_SearchText == FilterWidget::FixedString) {
         searchText = QRegularExpression::escape(searchText);
 
+    } else if (patternSyntax_SearchText == FilterWidget::MultipleTerms) {
+        // Terms separated by semicolons or new lines, the regex (highlighting & replacing) is their alternation
+        for (const QString &term : fixedText.split(SEPARATOR_WITHOUT_WHITESPACE_REGEX, Qt::SkipEmptyParts)) {
+            const QString trimmedTerm = term.trimmed();
+            if (!trimmedTerm.isEmpty() && !searchTerms.contains(trimmedTerm))
+                searchTerms.append(trimmedTerm);
+        }
+
+        // Longest terms first, so the regex prefers them like the automaton reports them
+        QStringList escapedTerms = searchTerms;
+        std::stable_sort(escapedTerms.begin(), escapedTerms.end(), [](const QString &a, const QString &b) {
+            return a.size() > b.size();
+        });
+
+        for (QString &escapedTerm : escapedTerms)
+            escapedTerm = QRegularExpression::escape(escapedTerm);
+
+        searchText = escapedTerms.join('|');
+    }
+
     // Add word boundaries (\b) around the searchText if the "Match whole words" checkbox is checked
-    if (ui->checkBox_MatchWholeWords->isChecked())
-        searchText = "\\b" + QRegularExpression::escape(searchText) + "\\b";
+    // (a fixed string & the terms are already escaped)
+    if (matchWholeWords) {
+        if (patternSyntax_SearchText == FilterWidget::FixedString)
+            searchText = "\\b" + searchText + "\\b";
+        else if (patternSyntax_SearchText == FilterWidget::MultipleTerms)
+            searchText = "\\b(?:" + searchText + ")\\b";
+        else
+            searchText = "\\b" + QRegularExpression::escape(searchText) + "\\b";
+    }
 
     searchText = searchText.normalized(QString::NormalizationForm_D);
 
@@ -794,6 +839,23 @@ void MainWindow::startSearch() {
 
     m_searchTextPattern = QRegularExpression(searchText, patternOptions);
 
+    // Fixed strings are searched without the regex engine, the pattern remains for the highlighting & replacing
+    if (patternSyntax_SearchText == FilterWidget::FixedString)
+        m_textMatcher = TextMatcher::fixedString(fixedText, m_filterWidget_FindText->caseSensitivity(),
+                                                 matchWholeWords, m_searchTextPattern);
+    else if (patternSyntax_SearchText == FilterWidget::MultipleTerms)
+        m_textMatcher = TextMatcher::multipleTerms(searchTerms, m_filterWidget_FindText->caseSensitivity(),
+                                                   matchWholeWords, m_searchTextPattern);
+    else
+        m_textMatcher = TextMatcher(m_searchTextPattern);
+
+    // The occurrences per term are only known for a multiple terms search, and none are counted when only the
+    // matching files (or the duplicates) are listed
+    const bool occurrencesCounted = !m_appSettings->getListMatchingFilesOnly() && !m_listDuplicatesOnly;
+    ui->tableView_Results->setColumnHidden(10, !occurrencesCounted);
+    ui->tableView_Results->setColumnHidden(12, !occurrencesCounted
+                                                   || !m_textMatcher.isMultipleTerms());
+
     m_dontMatchText = m_filterWidget_FindText->dontMatch();
 
 
@@ -801,43 +863,34 @@ void MainWindow::startSearch() {
     // Initialize Filenames variable
     // --------------------------
     m_targetFilenames = m_filterWidget_Filenames->text();
-    QStringList filenamePatterns = m_targetFilenames.split(';');
-    QVector<QRegularExpression>().swap(m_filenamesPatterns);
 
     const Qt::CaseSensitivity filenamesCaseSensitivity = m_filterWidget_Filenames->caseSensitivity();
 
     FilterWidget::PatternSyntax patternSyntax_Filenames = m_filterWidget_Filenames->patternSyntax();
 
-    for (QString &filenamePattern : filenamePatterns) {
-
-        if (patternSyntax_Filenames == FilterWidget::Wildcard)
-            filenamePattern = QRegularExpression::wildcardToRegularExpression(filenamePattern);
-        else if (patternSyntax_Filenames == FilterWidget::FixedString)
-            filenamePattern = QRegularExpression::escape(filenamePattern);
-
-        QRegularExpression::PatternOptions patternOptions = QRegularExpression::NoPatternOption;
-
-
-        if (filenamesCaseSensitivity == Qt::CaseInsensitive)
-            patternOptions |= QRegularExpression::CaseInsensitiveOption;
+    m_dontMatchfilenames = m_filterWidget_Filenames->dontMatch();
 
-        m_filenamesPatterns.append(QRegularExpression(filenamePattern, patternOptions));
-    }
 
-    m_dontMatchfilenames = m_filterWidget_Filenames->dontMatch();
+    // --------------------------
+    // The change journal keeps watching between the searches, as long as the setting is on
+    // --------------------------
+    if (!m_appSettings->getUseChangeJournal())
+        m_changeJournal.reset();
+    else if (!m_changeJournal)
+        m_changeJournal = std::make_unique<ChangeJournal>();
 
 
     // --------------------------
     //
     // --------------------------
     m_findOccurrencesWorker = new FindOccurrences(m_checkedDirectoriesToInclude, m_checkedDirectoriesToExclude,
-                                                  m_checkedMimeTypes, m_filesList, m_resultsModel, m_searchTextPattern,
-                                                  m_targetFilenames, m_filenamesPatterns, patternSyntax_Filenames,
+                                                  m_checkedMimeTypes, m_searchTextPattern, m_textMatcher,
+                                                  m_targetFilenames, patternSyntax_Filenames,
                                                   filenamesCaseSensitivity, !m_dontMatchText, m_dontMatchfilenames,
                                                   m_subdirectories, m_minDepth, m_maxDepth, m_ignoreHiddenDirectories,
                                                   m_ignoreHiddenFiles, m_ignoreSymbolicDirectoriesLinks,
                                                   m_ignoreSymbolicFilesLinks, m_findExactFilename,
-                                                  m_ignoreUnparseableFiles, m_avoidDuplicates, m_filesHashes_Set,
+                                                  m_ignoreUnparseableFiles, m_avoidDuplicates, m_listDuplicatesOnly,
                                                   m_filtersDirectories, m_filtersFiles, m_sizeCondition, m_sizeSystem,
                                                   m_size_1, m_size_2, m_sizeUnits_1, m_sizeUnits_2,
                                                   m_creationDateCondition, m_creationDate_1, m_creationDate_2,
@@ -847,7 +900,10 @@ void MainWindow::startSearch() {
                                                   filterByLastModificationDate, filterByLastAccessDate, filterByMimeTypes,
                                                   m_fileReadingTimeout,  m_limitFilesToParse, m_limitOccurrencesFound,
                                                   m_timeoutFileReading, m_filesToParseLimit, m_occurrencesFoundLimit,
-                                                  nullptr);
+                                                  m_appSettings->getScanThreads(),
+                                                  m_appSettings->getListMatchingFilesOnly(),
+                                                  m_appSettings->getUseTrigramIndex(), m_changeJournal.get(),
+                                                  &m_searchSnapshot, m_appSettings->getCacheResults(), nullptr);
 
     m_findOccurrencesThread = new QThread;
     m_findOccurrencesWorker->moveToThread(m_findOccurrencesThread);
@@ -865,9 +921,26 @@ void MainWindow::startSearch() {
 
     connect(m_findOccurrencesWorker, &FindOccurrences::finished, this, [this](const QMap<QString, qint64> &statisticsMap) {
         m_statisticsMap = statisticsMap;
+
+        // Results arrive in the order they are scanned, sorting them is only a presentation step
+        if (m_appSettings->getSortResults())
+            ui->tableView_Results->sortByColumn(4, Qt::AscendingOrder);
+
         searchFinished();
     }, Qt::QueuedConnection);
 
+    connect(m_findOccurrencesWorker, &FindOccurrences::resultsFound, this, [this](const QVector<FileScanResult> &results) {
+        for (const FileScanResult &result : results)
+            m_resultsModel->appendNew(result.fileInfo, result.filePath, result.mimeType, m_sizeSystem,
+                                      result.occurrences, result.linesNumbers, m_searchTextPattern, !m_dontMatchText,
+                                      result.termsBreakdown, result.fileStat);
+    }, Qt::QueuedConnection);
+
+    // A duplicate whose path sorts first replaces a result already sent
+    connect(m_findOccurrencesWorker, &FindOccurrences::resultRetracted, this, [this](const QString &filePath) {
+        m_resultsModel->removeResult(filePath);
+    }, Qt::QueuedConnection);
+
     connect(m_findOccurrencesWorker, &FindOccurrences::canceled, this, [this](const QMap<QString, qint64> &statisticsMap) {
         m_statisticsMap = statisticsMap;
         searchCanceled();
@@ -935,6 +1008,89 @@ void MainWindow::searchCanceled() {
 }
 
 
+void MainWindow::startRescan() {
+
+    if (m_resultsModel->isEmpty())
+        return;
+
+    m_elapsedTimer.start();
+    m_statsStartTime = QTime::currentTime().toString("hh:mm:ss");
+    m_statsEndTime = "";
+    m_statsElapsed = "";
+
+    m_rescanResultsWorker = new RescanResults(m_resultsModel->prepareRescan(), m_resultsModel->searchTextPattern(),
+                                              ui->checkBox_FileReadingTimeout->isChecked(),
+                                              ui->spinBox_FileReadingTimeout->value(),
+                                              ui->checkBox_OccurrencesFoundLimit->isChecked(),
+                                              ui->spinBox_OccurrencesFoundLimit->value(),
+                                              !m_filterWidget_FindText->dontMatch(),
+                                              m_appSettings->getScanThreads(), nullptr);
+
+    m_rescanResultsThread = new QThread;
+    m_rescanResultsWorker->moveToThread(m_rescanResultsThread);
+
+
+    // --------------------------
+    // Connects
+    // --------------------------
+    connect(m_rescanResultsThread, &QThread::started, m_rescanResultsWorker, &RescanResults::start);
+    connect(m_rescanResultsWorker, &RescanResults::finished, m_rescanResultsThread, &QThread::quit);
+    connect(m_rescanResultsWorker, &RescanResults::canceled, m_rescanResultsThread, &QThread::quit);
+    connect(m_rescanResultsWorker, &RescanResults::finished, m_rescanResultsWorker, &RescanResults::deleteLater);
+    connect(m_rescanResultsWorker, &RescanResults::canceled, m_rescanResultsWorker, &RescanResults::deleteLater);
+    connect(m_rescanResultsThread, &QThread::finished, m_rescanResultsThread, &QThread::deleteLater);
+
+    connect(m_rescanResultsWorker, &RescanResults::rowsRescanned, this, [this](const QVector<RescanUpdate> &updates) {
+        m_resultsModel->applyRescan(updates);
+    }, Qt::QueuedConnection);
+
+    connect(m_rescanResultsWorker, &RescanResults::finished, this, [this]() {
+        rescanFinished("Rescan operation successfully finished.");
+    }, Qt::QueuedConnection);
+
+    connect(m_rescanResultsWorker, &RescanResults::canceled, this, [this]() {
+        rescanFinished("Rescan operation canceled.");
+    }, Qt::QueuedConnection);
+
+    connect(m_rescanResultsWorker, &RescanResults::updateStatusBarOperation, this, [this](const QString &operation) {
+        m_statusBarWidget->setOperation(operation);
+    }, Qt::QueuedConnection);
+
+
+    // --------------------------
+    // The results stay usable, a new search would clear them
+    // --------------------------
+    m_isRescanning = true;
+    ui->btn_StartSearch->setDisabled(true);
+    ui->btn_RescanResults->setIcon(AppIcons::getIcon(IconType::CANCEL));
+    m_rescanResultsThread->start();
+
+}
+
+
+void MainWindow::cancelRescan() {
+
+    // The worker stops within the file being read, canceled() then finishes the rescan
+    if (m_rescanResultsWorker)
+        m_rescanResultsWorker->cancel();
+}
+
+
+void MainWindow::rescanFinished(const QString &message) {
+
+    m_statsElapsed = DateTime_Utils::formatElapsedTime(m_elapsedTimer.elapsed());
+    m_statsEndTime = QTime::currentTime().toString("hh:mm:ss");
+
+    m_resultsModel->finishRescan();
+    m_rescanResultsWorker = nullptr;
+    m_isRescanning = false;
+    ui->btn_StartSearch->setDisabled(false);
+    ui->btn_RescanResults->setIcon(AppIcons::getIcon(IconType::REFRESH));
+    m_statusBarWidget->clearOperation();
+    m_statusBarWidget->setMessage(message);
+}
+
+
 bool MainWindow::clearLists() {
 
     // Clear the Set and free up the memory
@@ -990,11 +1146,6 @@ bool MainWindow::clearLists() {
 
     m_resultsModel->clearModel();
 
-    QStringList().swap(m_filesList);
-    // or fileList = QStringList();
-
-    QSet<QString>().swap(m_filesHashes_Set);
-
     ui->textEdit_View->clear();
 
     return true;
@@ -1483,7 +1634,7 @@ void MainWindow::handleContextMenus() {
                 QMenu contextMenu("Columns", this);
 
                 // Add actions for each column in the table view
-                for (int i = 0; i < 12; ++i) {
+                for (int i = 0; i < m_resultsModel->columnCount(); ++i) {
                     QAction *action = contextMenu.addAction(m_resultsModel->headerData(i, Qt::Horizontal).toString());
                     action->setCheckable(true);
                     action->setChecked(!ui->tableView_Results->isColumnHidden(i));
@@ -1684,6 +1835,7 @@ void MainWindow::loadSettings_FromDatabase() {
     m_appSettings->setIgnoreHiddenFiles(getSettingValue(settingsList, "m_ignoreHiddenFiles").toInt());
     m_appSettings->setIgnoreSymbolicFilesLinks(getSettingValue(settingsList, "m_ignoreSymbolicFilesLinks").toInt());
     m_appSettings->setAvoidDuplicateFiles(getSettingValue(settingsList, "m_avoidDuplicateFiles").toInt());
+    m_appSettings->setListDuplicateFilesOnly(getSettingValue(settingsList, "m_listDuplicateFilesOnly").toInt());
     m_appSettings->setEnableFileReadingTimeout(getSettingValue(settingsList, "m_enableFileReadingTimeout").toInt());
     m_appSettings->setFileReadingTimeout(getSettingValue(settingsList, "m_fileReadingTimeout").toInt());
     m_appSettings->setEnableFilesToParseLimit(getSettingValue(settingsList, "m_enableFilesToParseLimit").toInt());
@@ -1698,6 +1850,12 @@ void MainWindow::loadSettings_FromDatabase() {
     m_appSettings->setEnableLoggers(getSettingValue(settingsList, "m_enableLoggers").toInt());
     m_appSettings->setLoggersFilesToKeep(getSettingValue(settingsList, "m_LoggersFilesToKeep").toInt());
     m_appSettings->setEnableLoggers(getSettingValue(settingsList, "m_enableLoggers").toInt());
+    m_appSettings->setScanThreads(getSettingValue(settingsList, "m_scanThreads").toInt());
+    m_appSettings->setSortResults(getSettingValue(settingsList, "m_sortResults").toInt());
+    m_appSettings->setListMatchingFilesOnly(getSettingValue(settingsList, "m_listMatchingFilesOnly").toInt());
+    m_appSettings->setUseTrigramIndex(getSettingValue(settingsList, "m_useTrigramIndex").toInt());
+    m_appSettings->setUseChangeJournal(getSettingValue(settingsList, "m_useChangeJournal").toInt());
+    m_appSettings->setCacheResults(getSettingValue(settingsList, "m_cacheResults").toInt());
     m_appSettings->setLastResultsDirectory(getSettingValue(settingsList, "m_lastResultsDirectory"));
 
 }
@@ -1777,6 +1935,7 @@ void MainWindow::saveSettings_ToDatabase() {
     m_appSettings->setIgnoreHiddenFiles(ui->checkBox_IgnoreHiddenFiles->isChecked());
     m_appSettings->setIgnoreSymbolicFilesLinks(ui->checkBox_IgnoreSymbolicFilesLinks->isChecked());
     m_appSettings->setAvoidDuplicateFiles(ui->checkBox_AvoidDuplicateFiles->isChecked());
+    m_appSettings->setListDuplicateFilesOnly(ui->checkBox_ListDuplicateFilesOnly->isChecked());
     m_appSettings->setEnableFileReadingTimeout(ui->checkBox_FileReadingTimeout->isChecked());
     m_appSettings->setFileReadingTimeout(ui->spinBox_FileReadingTimeout->value());
     m_appSettings->setEnableFilesToParseLimit(ui->checkBox_FilesToParse->isChecked());
@@ -1935,6 +2094,8 @@ void MainWindow::initialiazeControlsFromSettings() {
 
     ui->checkBox_AvoidDuplicateFiles->setChecked(m_appSettings->avoidDuplicateFiles());
 
+    ui->checkBox_ListDuplicateFilesOnly->setChecked(m_appSettings->listDuplicateFilesOnly());
+
     ui->checkBox_FileReadingTimeout->setChecked(m_appSettings->enableFileReadingTimeout());
 
     ui->spinBox_FileReadingTimeout->setValue(m_appSettings->getFileReadingTimeout());
@@ -38,10 +38,13 @@
 #include "models/results_model.h"
 #include "models/results_sortfilterproxymodel.h"
 #include "operations/op_find_occurrences.h"
+#include "operations/op_rescan_results.h"
 
 #include <QMainWindow>
 #include <QTableView>
 
+#include <memory>
+
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -72,6 +75,10 @@ public:
     void searchFinished();
     void searchCanceled();
 
+    void startRescan();
+    void cancelRescan();
+    void rescanFinished(const QString &message);
+
     bool clearLists();
 
     void viewResults(const QModelIndex &modelIndex);
@@ -115,7 +122,6 @@ private:
     QSet<QString> m_checkedDirectoriesToInclude;
     QSet<QString> m_checkedDirectoriesToExclude;
     QSet<QMimeType> m_checkedMimeTypes;
-    QStringList m_filesList;
     StandardModel *m_includedDirectoriesModel;
     StandardModel *m_excludedDirectoriesModel;
     StandardModel *m_mimetypesModel;
@@ -123,8 +129,8 @@ private:
     ResultsSortFilterProxyModel *m_resultsSortFilterProxyModel;
 
     QRegularExpression m_searchTextPattern;
+    TextMatcher m_textMatcher;
     QString m_targetFilenames;
-    QVector<QRegularExpression> m_filenamesPatterns;
     bool m_dontMatchText;
     bool m_dontMatchfilenames;
 
@@ -140,8 +146,8 @@ private:
     bool m_findExactFilename = false;
     bool m_ignoreUnparseableFiles = true;
     bool m_avoidDuplicates = false;
+    bool m_listDuplicatesOnly = false;
 
-    QSet<QString> m_filesHashes_Set;
     QDir::Filters m_filtersDirectories = QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable;
     QDir::Filters m_filtersFiles = QDir::Files | QDir::NoDotAndDotDot | QDir::Readable;
 
@@ -176,6 +182,12 @@ private:
 
     FindOccurrences *m_findOccurrencesWorker;
     QThread *m_findOccurrencesThread;
+    std::unique_ptr<ChangeJournal> m_changeJournal;     // Watches the searched directories between the searches
+    SearchSnapshot m_searchSnapshot;                    // The results of the last search, for an identical one
+
+    bool m_isRescanning = false;
+    RescanResults *m_rescanResultsWorker = nullptr;
+    QThread *m_rescanResultsThread = nullptr;
 
     QElapsedTimer m_elapsedTimer;
     QString m_statsStartTime = "";
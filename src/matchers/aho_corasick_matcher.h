@@ -0,0 +1,251 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "matchers/word_boundaries.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+#include <array>
+#include <utility>
+#include <queue>
+
+
+/**
+ * Multi-term search over UTF-8 bytes with an Aho-Corasick automaton.
+ *
+ * The automaton is a complete DFA stored as one flat table (states x byte classes): the bytes that never appear
+ * in the terms share a single class, so each row stays small and a step is a single indexed load. Every
+ * occurrence of every term is reported, overlapping occurrences of different terms included.
+ */
+class AhoCorasickMatcher {
+
+public:
+
+    /**
+     * @param terms - The UTF-8 terms (empty ones are ignored, duplicates are merged).
+     * @param caseInsensitive - Fold the ASCII letters, the other bytes match exactly.
+     * @param wholeWords - Only report the occurrences that are delimited by word boundaries.
+     */
+    AhoCorasickMatcher(const QList<QByteArray> &terms, const bool caseInsensitive, const bool wholeWords)
+        : m_caseInsensitive(caseInsensitive),
+        m_wholeWords(wholeWords) {
+
+        for (const QByteArray &term : terms) {
+            const QByteArray key = caseInsensitive ? term.toLower() : term;
+            if (!key.isEmpty() && !m_keys.contains(key)) {
+                m_keys.append(key);
+                m_terms.append(term);
+            }
+        }
+
+        buildByteClasses();
+        buildAutomaton();
+    }
+
+
+    qsizetype termsCount() const {
+        return m_terms.size();
+    }
+
+    const QByteArray &term(const int index) const {
+        return m_terms.at(index);
+    }
+
+    qsizetype statesCount() const {
+        return m_firstOutput.size();
+    }
+
+
+    /**
+     * Reads the bytes once and reports every occurrence.
+     * @param data - The UTF-8 bytes.
+     * @param size - The number of bytes.
+     * @param onMatch - Called with (term index, 1-based line number) for each occurrence, returning false stops.
+     */
+    template <typename Callback>
+    void scan(const char *data, const qsizetype size, Callback &&onMatch) const {
+
+        const qint32 *transitions = m_transitions.constData();
+        const quint16 *byteClasses = m_byteClasses.data();
+        const qsizetype classesCount = m_classesCount;
+
+        qint32 state = 0;
+        int lineNumber = 1;
+
+        for (qsizetype i = 0; i < size; ++i) {
+            const unsigned char byte = static_cast<unsigned char>(data[i]);
+
+            state = transitions[state * classesCount + byteClasses[byte]];
+
+            if (m_firstOutput[state] >= 0) {
+                for (qint32 output = m_firstOutput[state]; output >= 0; output = m_outputLink[output]) {
+                    const int termIndex = m_stateTerm[output];
+                    const qsizetype end = i + 1;
+                    const qsizetype start = end - m_keys.at(termIndex).size();
+
+                    if (m_wholeWords && !WordBoundaries::isWholeWord(data, size, start, end, m_firstIsWord.at(termIndex),
+                                                                     m_lastIsWord.at(termIndex)))
+                        continue;
+
+                    if (!onMatch(termIndex, lineNumber))
+                        return;
+                }
+            }
+
+            if (byte == '\n')
+                lineNumber++;
+        }
+    }
+
+
+
+private:
+
+    /**
+     * The bytes used by the terms get their own class, all the others share the class 0.
+     */
+    void buildByteClasses() {
+
+        m_byteClasses.fill(0);
+        m_classesCount = 1;
+
+        for (const QByteArray &key : std::as_const(m_keys)) {
+            for (const char &c : key) {
+                const unsigned char byte = static_cast<unsigned char>(c);
+                if (m_byteClasses[byte] == 0)
+                    m_byteClasses[byte] = m_classesCount++;
+            }
+        }
+
+        // The upper case letters share the class of their lower case (the keys are lowered)
+        if (m_caseInsensitive)
+            for (int byte = 'A'; byte <= 'Z'; ++byte)
+                m_byteClasses[byte] = m_byteClasses[byte + ('a' - 'A')];
+    }
+
+
+    void buildAutomaton() {
+
+        // --------------------------
+        // Trie of the keys, the missing transitions are -1
+        // --------------------------
+        m_transitions = QVector<qint32>(m_classesCount, -1);
+        m_stateTerm = QVector<qint32>(1, -1);
+
+        for (int termIndex = 0; termIndex < m_keys.size(); ++termIndex) {
+            qint32 state = 0;
+
+            for (const char &c : m_keys.at(termIndex)) {
+                const qsizetype slot = state * m_classesCount + m_byteClasses[static_cast<unsigned char>(c)];
+
+                if (m_transitions[slot] < 0) {
+                    m_transitions[slot] = static_cast<qint32>(m_stateTerm.size());
+                    m_stateTerm.append(-1);
+                    m_transitions.resize(m_transitions.size() + m_classesCount, -1);
+                }
+
+                state = m_transitions[slot];
+            }
+
+            m_stateTerm[state] = termIndex;
+
+            const QByteArray &key = m_keys.at(termIndex);
+            m_firstIsWord.append(WordBoundaries::isWordCodePoint(WordBoundaries::decodeAt(key.constData(), key.size(), 0)));
+            m_lastIsWord.append(WordBoundaries::isWordCodePoint(WordBoundaries::decodeBefore(key.constData(), key.size())));
+        }
+
+
+        // --------------------------
+        // Breadth-first: failure links, then complete the DFA with the transitions of the failure states
+        // --------------------------
+        const qsizetype statesCount = m_stateTerm.size();
+        QVector<qint32> failure(statesCount, 0);
+        m_outputLink = QVector<qint32>(statesCount, -1);
+        m_firstOutput = QVector<qint32>(statesCount, -1);
+
+        std::queue<qint32> pending;
+
+        for (qsizetype byteClass = 0; byteClass < m_classesCount; ++byteClass) {
+            qint32 &next = m_transitions[byteClass];
+            if (next < 0) {
+                next = 0;
+            } else {
+                failure[next] = 0;
+                pending.push(next);
+            }
+        }
+
+        while (!pending.empty()) {
+            const qint32 state = pending.front();
+            pending.pop();
+
+            // Nearest proper suffix state that ends a term
+            const qint32 fallback = failure[state];
+            m_outputLink[state] = m_stateTerm[fallback] >= 0 ? fallback : m_outputLink[fallback];
+
+            for (qsizetype byteClass = 0; byteClass < m_classesCount; ++byteClass) {
+                qint32 &next = m_transitions[state * m_classesCount + byteClass];
+                const qint32 fallbackNext = m_transitions[fallback * m_classesCount + byteClass];
+
+                if (next < 0) {
+                    next = fallbackNext;
+                } else {
+                    failure[next] = fallbackNext;
+                    pending.push(next);
+                }
+            }
+        }
+
+        for (qsizetype state = 0; state < statesCount; ++state)
+            m_firstOutput[state] = m_stateTerm[state] >= 0 ? static_cast<qint32>(state) : m_outputLink[state];
+    }
+
+
+
+private:
+    bool m_caseInsensitive = false;
+    bool m_wholeWords = false;
+
+    QList<QByteArray> m_terms;              // As given
+    QList<QByteArray> m_keys;               // As searched (lowered when case insensitive)
+    QVector<bool> m_firstIsWord;
+    QVector<bool> m_lastIsWord;
+
+    std::array<quint16, 256> m_byteClasses;
+    qsizetype m_classesCount = 1;
+
+    QVector<qint32> m_transitions;          // statesCount x classesCount
+    QVector<qint32> m_stateTerm;            // Term ending at the state, -1 if none
+    QVector<qint32> m_outputLink;           // Next state ending a term along the failure links, -1 if none
+    QVector<qint32> m_firstOutput;          // The state itself if it ends a term, else its output link
+
+};
@@ -0,0 +1,487 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "components/filterwidget.h"
+
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <vector>
+
+
+/**
+ * Matches a filename against all the ';' separated patterns of a search at once.
+ *
+ * The extension globs (`*.cpp`) are answered by a hash set lookup on the suffixes of the name, the names without
+ * wildcard by another set, and the other globs & fixed strings are compiled together into a single DFA, so a name
+ * is matched in a time proportional to its length whatever the number of patterns. The DFA reads code points, as
+ * the regexes do: `?` or `[!a]` match a whole character outside of the BMP. The regexes, and the globs the DFA can't
+ * express with the same meaning, are combined into one regex when none of them holds a group.
+ */
+class FilenameMatcher {
+
+public:
+    FilenameMatcher() = default;
+
+
+    /**
+     * @param patterns - The ';' separated patterns, as typed.
+     * @param syntax - How the patterns are read, the multiple terms being regexes for the filenames.
+     * @param caseSensitivity - Whether the case of the names matters.
+     * @param exactFilename - With fixed strings, the whole text is the name to find, the ';' included.
+     */
+    FilenameMatcher(const QString &patterns, FilterWidget::PatternSyntax syntax, Qt::CaseSensitivity caseSensitivity,
+                    bool exactFilename)
+        : m_caseInsensitive(caseSensitivity == Qt::CaseInsensitive) {
+
+        if (syntax == FilterWidget::FixedString && exactFilename) {
+            m_literals.insert(fold(patterns));
+            return;
+        }
+
+        std::vector<Glob> globs;
+        QStringList regexes;
+
+        for (const QString &pattern : patterns.split(';')) {
+            if (syntax == FilterWidget::Wildcard)
+                addWildcard(pattern, globs, regexes);
+            else if (syntax == FilterWidget::FixedString)
+                addFixedString(pattern, globs);
+            else
+                regexes.append(pattern);
+        }
+
+        // Too many states: the globs are matched by their regexes instead
+        if (!globs.empty() && !compileAutomaton(globs))
+            for (const Glob &glob : globs)
+                regexes.append(glob.regex);
+
+        compileRegexes(regexes);
+    }
+
+
+    /**
+     * @return - true if the name matches at least one of the patterns.
+     */
+    bool matches(const QString &filename) const {
+
+        if (m_matchesAll)
+            return true;
+
+        const QString name = fold(filename);
+
+        if (m_literals.contains(name))
+            return true;
+
+        // Every suffix of the name following a dot, for the extensions made of several parts (`*.tar.gz`)
+        if (!m_extensions.isEmpty()) {
+            for (qsizetype dot = name.indexOf(u'.'); dot >= 0; dot = name.indexOf(u'.', dot + 1))
+                if (m_extensions.contains(QString::fromRawData(name.constData() + dot + 1, name.size() - dot - 1)))
+                    return true;
+        }
+
+        if (!m_transitions.empty() && runAutomaton(name))
+            return true;
+
+        for (const QRegularExpression &regex : m_regexes)
+            if (regex.match(filename).hasMatch())
+                return true;
+
+        return false;
+    }
+
+
+
+
+private:
+    static constexpr int MAX_STATES = 2048;     // DFA states, more fall back to the regexes
+    static constexpr int ASCII_SIZE = 128;
+
+
+    /**
+     * A glob element: a character (a single range), any character, any sequence or a class of characters, the
+     * characters being code points.
+     */
+    struct Token {
+        enum class Kind { Char, Any, Star, Class };
+
+        Kind kind = Kind::Char;
+        std::vector<std::pair<char32_t, char32_t>> ranges;
+        bool negated = false;
+
+        bool matches(const char32_t c) const {
+            if (kind == Kind::Any)
+                return true;
+
+            const bool inRanges = std::any_of(ranges.cbegin(), ranges.cend(), [c](const auto &range) {
+                return c >= range.first && c <= range.second;
+            });
+            return inRanges != negated;
+        }
+    };
+
+
+    struct Glob {
+        std::vector<Token> tokens;
+        QString regex;      // The same pattern, for the fallback
+    };
+
+
+    QString fold(const QString &text) const {
+        return m_caseInsensitive ? text.toCaseFolded() : text;
+    }
+
+
+    char32_t fold(const char32_t c) const {
+        return m_caseInsensitive ? QChar::toCaseFolded(c) : c;
+    }
+
+
+    void addWildcard(const QString &pattern, std::vector<Glob> &globs, QStringList &regexes) {
+
+        // Matches an empty name only
+        if (pattern.isEmpty())
+            return;
+
+        const QString folded = fold(pattern);
+        static const QRegularExpression specialCharacters(R"([*?\[\]\\])");
+
+        if (!folded.contains(specialCharacters)) {
+            m_literals.insert(folded);
+            return;
+        }
+
+        if (folded.startsWith(QLatin1String("*.")) && !folded.sliced(2).contains(specialCharacters)) {
+            m_extensions.insert(folded.sliced(2));
+            return;
+        }
+
+        Glob glob;
+        glob.regex = QRegularExpression::wildcardToRegularExpression(pattern);
+
+        if (parseGlob(pattern, glob.tokens))
+            globs.push_back(std::move(glob));
+        else
+            regexes.append(glob.regex);
+    }
+
+
+    /**
+     * A fixed string is found anywhere in the name: it is the glob `*string*`, an empty one matching all the names.
+     */
+    void addFixedString(const QString &pattern, std::vector<Glob> &globs) {
+
+        if (pattern.isEmpty()) {
+            m_matchesAll = true;
+            return;
+        }
+
+        Glob glob;
+        glob.regex = QRegularExpression::escape(pattern);
+        glob.tokens.push_back({Token::Kind::Star, {}, false});
+
+        for (const uint c : pattern.toUcs4()) {
+            const char32_t folded = fold(c);
+            glob.tokens.push_back({Token::Kind::Char, {{folded, folded}}, false});
+        }
+
+        glob.tokens.push_back({Token::Kind::Star, {}, false});
+        globs.push_back(std::move(glob));
+    }
+
+
+    /**
+     * Parses a glob the way QRegularExpression::wildcardToRegularExpression() reads it.
+     * @return - false if the glob holds an element read differently by the regex (a backslash, a lone bracket,
+     * a class starting with ']' or, case insensitive, a range other than digits or letters of the same case).
+     */
+    bool parseGlob(const QString &pattern, std::vector<Token> &tokens) const {
+
+        const QList<uint> codePoints = pattern.toUcs4();
+
+        for (qsizetype i = 0; i < codePoints.size(); ++i) {
+            const char32_t c = codePoints.at(i);
+
+            if (c == U'*') {
+                if (tokens.empty() || tokens.back().kind != Token::Kind::Star)
+                    tokens.push_back({Token::Kind::Star, {}, false});
+
+            } else if (c == U'?') {
+                tokens.push_back({Token::Kind::Any, {}, false});
+
+            } else if (c == U'[') {
+                Token token;
+                token.kind = Token::Kind::Class;
+
+                if (i + 1 < codePoints.size() && codePoints.at(i + 1) == U'!') {
+                    token.negated = true;
+                    ++i;
+                }
+
+                if (i + 1 >= codePoints.size() || codePoints.at(i + 1) == U']')
+                    return false;
+
+                while (++i < codePoints.size() && codePoints.at(i) != U']') {
+                    const char32_t first = codePoints.at(i);
+                    if (first == U'\\' || first == U'[')
+                        return false;
+
+                    // A range, unless the '-' is the last character of the class
+                    if (i + 2 < codePoints.size() && codePoints.at(i + 1) == U'-'
+                        && codePoints.at(i + 2) != U']') {
+                        const char32_t last = codePoints.at(i + 2);
+                        if (last == U'\\' || last == U'[' || last < first || !isFoldableRange(first, last))
+                            return false;
+
+                        token.ranges.push_back({fold(first), fold(last)});
+                        i += 2;
+                    } else {
+                        token.ranges.push_back({fold(first), fold(first)});
+                    }
+                }
+
+                // Unterminated
+                if (i >= codePoints.size())
+                    return false;
+
+                tokens.push_back(std::move(token));
+
+            } else if (c == U']' || c == U'\\') {
+                return false;
+
+            } else {
+                const char32_t folded = fold(c);
+                tokens.push_back({Token::Kind::Char, {{folded, folded}}, false});
+            }
+        }
+
+        return true;
+    }
+
+
+    /**
+     * @return - true if the folded range holds the folded characters of the range, always when case sensitive.
+     */
+    bool isFoldableRange(const char32_t first, const char32_t last) const {
+        if (!m_caseInsensitive)
+            return true;
+
+        return (first >= U'0' && last <= U'9') || (first >= U'a' && last <= U'z') || (first >= U'A' && last <= U'Z');
+    }
+
+
+    /**
+     * Builds the DFA of the globs by the subset construction. The characters are grouped in classes, the ones
+     * between two boundaries of the patterns behaving the same in every state.
+     * @return - false if the DFA would have more than MAX_STATES states.
+     */
+    bool compileAutomaton(const std::vector<Glob> &globs) {
+
+        // --------------------------
+        // The classes of characters
+        // --------------------------
+        for (const Glob &glob : globs)
+            for (const Token &token : glob.tokens)
+                for (const auto &range : token.ranges) {
+                    m_boundaries.push_back(static_cast<int>(range.first));
+                    m_boundaries.push_back(static_cast<int>(range.second) + 1);
+                }
+
+        std::sort(m_boundaries.begin(), m_boundaries.end());
+        m_boundaries.erase(std::unique(m_boundaries.begin(), m_boundaries.end()), m_boundaries.end());
+
+        m_classesCount = static_cast<int>(m_boundaries.size()) + 1;
+
+        for (int c = 0; c < ASCII_SIZE; ++c)
+            m_asciiClasses[c] = classOf(c);
+
+
+        // --------------------------
+        // The states of the NFA: a glob & the number of its tokens matched
+        // --------------------------
+        std::vector<std::pair<int, int>> nfaStates;
+        std::vector<int> firstStates;
+
+        for (int glob = 0; glob < static_cast<int>(globs.size()); ++glob) {
+            firstStates.push_back(static_cast<int>(nfaStates.size()));
+            for (int matched = 0; matched <= static_cast<int>(globs[glob].tokens.size()); ++matched)
+                nfaStates.push_back({glob, matched});
+        }
+
+        // A star may match nothing: the state following it is reached as well
+        auto closure = [&](std::vector<int> states) {
+            for (size_t i = 0; i < states.size(); ++i) {
+                const auto [glob, matched] = nfaStates[states[i]];
+                const std::vector<Token> &tokens = globs[glob].tokens;
+
+                if (matched < static_cast<int>(tokens.size()) && tokens[matched].kind == Token::Kind::Star)
+                    states.push_back(states[i] + 1);
+            }
+
+            std::sort(states.begin(), states.end());
+            states.erase(std::unique(states.begin(), states.end()), states.end());
+            return states;
+        };
+
+        auto isAccepting = [&](const std::vector<int> &states) {
+            return std::any_of(states.cbegin(), states.cend(), [&](const int state) {
+                const auto [glob, matched] = nfaStates[state];
+                return matched == static_cast<int>(globs[glob].tokens.size());
+            });
+        };
+
+
+        // --------------------------
+        // The subset construction, each class of characters represented by its first character
+        // --------------------------
+        std::map<std::vector<int>, int> statesIds;
+        std::vector<std::vector<int>> dfaStates;
+
+        auto stateId = [&](const std::vector<int> &states) {
+            const auto [it, inserted] = statesIds.emplace(states, static_cast<int>(dfaStates.size()));
+            if (inserted) {
+                dfaStates.push_back(states);
+                m_accepting.push_back(isAccepting(states));
+            }
+            return it->second;
+        };
+
+        m_startState = stateId(closure(firstStates));
+        m_deadState = stateId({});
+
+        for (size_t dfaState = 0; dfaState < dfaStates.size(); ++dfaState) {
+            if (dfaStates.size() > static_cast<size_t>(MAX_STATES)) {
+                m_transitions.clear();
+                return false;
+            }
+
+            for (int characterClass = 0; characterClass < m_classesCount; ++characterClass) {
+                const char32_t c = characterClass == 0 ? 0 : static_cast<char32_t>(m_boundaries[characterClass - 1]);
+                std::vector<int> next;
+
+                for (const int state : dfaStates[dfaState]) {
+                    const auto [glob, matched] = nfaStates[state];
+                    const std::vector<Token> &tokens = globs[glob].tokens;
+                    if (matched == static_cast<int>(tokens.size()))
+                        continue;
+
+                    if (tokens[matched].kind == Token::Kind::Star)
+                        next.push_back(state);
+                    else if (tokens[matched].matches(c))
+                        next.push_back(state + 1);
+                }
+
+                m_transitions.push_back(stateId(closure(next)));
+            }
+        }
+
+        return true;
+    }
+
+
+    int classOf(const int c) const {
+        const auto it = std::upper_bound(m_boundaries.cbegin(), m_boundaries.cend(), c);
+        return static_cast<int>(it - m_boundaries.cbegin());
+    }
+
+
+    /**
+     * Runs the DFA over the code points of the name, a lone surrogate being read as itself.
+     */
+    bool runAutomaton(const QString &name) const {
+
+        int state = m_startState;
+        const qsizetype size = name.size();
+
+        for (qsizetype i = 0; i < size; ++i) {
+            char32_t c = name.at(i).unicode();
+
+            if (QChar::isHighSurrogate(c) && i + 1 < size && name.at(i + 1).isLowSurrogate())
+                c = QChar::surrogateToUcs4(static_cast<char16_t>(c), name.at(++i).unicode());
+
+            const int characterClass = c < ASCII_SIZE ? m_asciiClasses[c] : classOf(static_cast<int>(c));
+            state = m_transitions[state * m_classesCount + characterClass];
+
+            if (state == m_deadState)
+                return false;
+        }
+
+        return m_accepting[state];
+    }
+
+
+    /**
+     * Combines the regexes into a single one, unless one of them is invalid (it then never matches, as before) or
+     * holds a group: the groups of the regexes after the first would be renumbered, and the back references (`\1`),
+     * conditions (`(?(1)...)`) and recursions (`(?1)`) would then refer to the groups of another regex.
+     */
+    void compileRegexes(const QStringList &regexes) {
+
+        const QRegularExpression::PatternOptions options = m_caseInsensitive
+                                                               ? QRegularExpression::CaseInsensitiveOption
+                                                               : QRegularExpression::NoPatternOption;
+
+        for (const QString &regex : regexes)
+            m_regexes.append(QRegularExpression(regex, options));
+
+        const bool combinable = std::all_of(m_regexes.cbegin(), m_regexes.cend(), [](const QRegularExpression &regex) {
+            return regex.isValid() && regex.captureCount() == 0;
+        });
+
+        if (m_regexes.size() > 1 && combinable) {
+            const QRegularExpression combined("(?:" + regexes.join(")|(?:") + ")", options);
+            if (combined.isValid())
+                m_regexes = {combined};
+        }
+    }
+
+
+    bool m_caseInsensitive = false;
+    bool m_matchesAll = false;              // An empty fixed string is found in every name
+
+    QSet<QString> m_literals;               // Whole names, folded when case insensitive
+    QSet<QString> m_extensions;             // Idem, the suffixes following a dot
+
+    std::vector<int> m_boundaries;          // First character of each class of characters but the first one
+    std::array<int, ASCII_SIZE> m_asciiClasses = {};
+    int m_classesCount = 0;
+    std::vector<int> m_transitions;         // State * classes count + class -> state
+    std::vector<bool> m_accepting;
+    int m_startState = 0;
+    int m_deadState = 0;
+
+    QVector<QRegularExpression> m_regexes;
+
+};
@@ -0,0 +1,281 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "matchers/word_boundaries.h"
+
+#include <QByteArray>
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LITERAL_MATCHER_X86
+#include <immintrin.h>
+#endif
+
+
+/**
+ * Literal (fixed string) search over UTF-8 bytes.
+ *
+ * Candidates are found by comparing the first and the last byte of the needle against 16 (SSE2) or 32 (AVX2)
+ * positions at once, then verified with a memcmp. AVX2 is selected at runtime so the same binary runs on older
+ * CPUs. Case insensitivity is ASCII only, and whole words follow the `\b` semantics of the regex engine.
+ */
+class LiteralMatcher {
+
+public:
+    LiteralMatcher() = default;
+
+
+    /**
+     * @param needle - The UTF-8 text to find, must not be empty nor contain line breaks.
+     * @param caseInsensitive - Fold the ASCII letters, the needle must then be ASCII.
+     * @param wholeWords - Only report the matches that are delimited by word boundaries.
+     */
+    LiteralMatcher(const QByteArray &needle, const bool caseInsensitive, const bool wholeWords)
+        : m_needle(caseInsensitive ? needle.toLower() : needle),
+        m_caseInsensitive(caseInsensitive),
+        m_wholeWords(wholeWords) {
+
+        if (!canMatch(needle, caseInsensitive)) {
+            m_needle.clear();
+            return;
+        }
+
+        m_first = m_needle.front();
+        m_last = m_needle.back();
+        m_firstAlt = caseInsensitive ? toUpperAscii(m_first) : m_first;
+        m_lastAlt = caseInsensitive ? toUpperAscii(m_last) : m_last;
+
+        m_firstIsWord = WordBoundaries::isWordCodePoint(WordBoundaries::decodeAt(m_needle.constData(), m_needle.size(), 0));
+        m_lastIsWord = WordBoundaries::isWordCodePoint(WordBoundaries::decodeBefore(m_needle.constData(), m_needle.size()));
+    }
+
+
+    /**
+     * Tells whether a needle can be searched by this matcher (otherwise the regex engine must be used).
+     */
+    static bool canMatch(const QByteArray &needle, const bool caseInsensitive) {
+
+        if (needle.isEmpty() || needle.contains('\n') || needle.contains('\r'))
+            return false;
+
+        // Non ASCII letters would need the Unicode case folding
+        if (caseInsensitive)
+            for (const char &c : needle)
+                if (static_cast<unsigned char>(c) >= 0x80)
+                    return false;
+
+        return true;
+    }
+
+
+    bool isValid() const {
+        return !m_needle.isEmpty();
+    }
+
+    qsizetype size() const {
+        return m_needle.size();
+    }
+
+    const QByteArray &needle() const {
+        return m_needle;
+    }
+
+
+    /**
+     * Finds the next match.
+     * @param data - The UTF-8 bytes to search.
+     * @param size - The number of bytes.
+     * @param from - The position to start from.
+     * @return - The position of the match, or -1 if there isn't any.
+     */
+    qsizetype indexIn(const char *data, const qsizetype size, qsizetype from) const {
+
+        static const FindFunction find = selectFind();
+
+        while (true) {
+            const qsizetype position = find(*this, data, size, from);
+
+            if (position < 0 || !m_wholeWords
+                || WordBoundaries::isWholeWord(data, size, position, position + m_needle.size(), m_firstIsWord, m_lastIsWord))
+                return position;
+
+            from = position + 1;
+        }
+    }
+
+
+
+private:
+    using FindFunction = qsizetype (*)(const LiteralMatcher &, const char *, qsizetype, qsizetype);
+
+
+    static FindFunction selectFind() {
+#ifdef LITERAL_MATCHER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return &findAvx2;
+
+        return &findSse2;
+#else
+        return &findScalar;
+#endif
+    }
+
+
+    // *******************************************************************************************************************
+    // ***************************************************** Search ******************************************************
+    // *******************************************************************************************************************
+    bool verify(const char *candidate) const {
+
+        const qsizetype length = m_needle.size();
+
+        if (!m_caseInsensitive)
+            return length <= 2 || std::memcmp(candidate + 1, m_needle.constData() + 1, length - 2) == 0;
+
+        for (qsizetype i = 1; i < length - 1; ++i)
+            if (toLowerAscii(candidate[i]) != m_needle.at(i))
+                return false;
+
+        return true;
+    }
+
+
+    static qsizetype findScalar(const LiteralMatcher &matcher, const char *data, const qsizetype size, qsizetype from) {
+
+        const qsizetype length = matcher.m_needle.size();
+
+        for (qsizetype i = from; i + length <= size; ++i) {
+            const char first = data[i];
+            const char last = data[i + length - 1];
+
+            if ((first == matcher.m_first || first == matcher.m_firstAlt)
+                && (last == matcher.m_last || last == matcher.m_lastAlt)
+                && matcher.verify(data + i))
+                return i;
+        }
+
+        return -1;
+    }
+
+
+#ifdef LITERAL_MATCHER_X86
+    __attribute__((target("sse2")))
+    static qsizetype findSse2(const LiteralMatcher &matcher, const char *data, const qsizetype size, qsizetype from) {
+
+        const qsizetype length = matcher.m_needle.size();
+
+        const __m128i first = _mm_set1_epi8(matcher.m_first);
+        const __m128i firstAlt = _mm_set1_epi8(matcher.m_firstAlt);
+        const __m128i last = _mm_set1_epi8(matcher.m_last);
+        const __m128i lastAlt = _mm_set1_epi8(matcher.m_lastAlt);
+
+        qsizetype i = from;
+        for (; i + length - 1 + 16 <= size; i += 16) {
+            const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + length - 1));
+
+            const __m128i matchFirst = _mm_or_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockFirst, firstAlt));
+            const __m128i matchLast = _mm_or_si128(_mm_cmpeq_epi8(blockLast, last), _mm_cmpeq_epi8(blockLast, lastAlt));
+
+            unsigned int candidates = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(matchFirst, matchLast)));
+
+            while (candidates) {
+                const int offset = __builtin_ctz(candidates);
+                if (matcher.verify(data + i + offset))
+                    return i + offset;
+
+                candidates &= candidates - 1;
+            }
+        }
+
+        return findScalar(matcher, data, size, i);
+    }
+
+
+    __attribute__((target("avx2")))
+    static qsizetype findAvx2(const LiteralMatcher &matcher, const char *data, const qsizetype size, qsizetype from) {
+
+        const qsizetype length = matcher.m_needle.size();
+
+        const __m256i first = _mm256_set1_epi8(matcher.m_first);
+        const __m256i firstAlt = _mm256_set1_epi8(matcher.m_firstAlt);
+        const __m256i last = _mm256_set1_epi8(matcher.m_last);
+        const __m256i lastAlt = _mm256_set1_epi8(matcher.m_lastAlt);
+
+        qsizetype i = from;
+        for (; i + length - 1 + 32 <= size; i += 32) {
+            const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + length - 1));
+
+            const __m256i matchFirst = _mm256_or_si256(_mm256_cmpeq_epi8(blockFirst, first),
+                                                       _mm256_cmpeq_epi8(blockFirst, firstAlt));
+            const __m256i matchLast = _mm256_or_si256(_mm256_cmpeq_epi8(blockLast, last),
+                                                      _mm256_cmpeq_epi8(blockLast, lastAlt));
+
+            unsigned int candidates = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(matchFirst, matchLast)));
+
+            while (candidates) {
+                const int offset = __builtin_ctz(candidates);
+                if (matcher.verify(data + i + offset))
+                    return i + offset;
+
+                candidates &= candidates - 1;
+            }
+        }
+
+        return findSse2(matcher, data, size, i);
+    }
+#endif
+
+
+    static char toLowerAscii(const char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    static char toUpperAscii(const char c) {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+    }
+
+
+
+private:
+    QByteArray m_needle;
+    bool m_caseInsensitive = false;
+    bool m_wholeWords = false;
+
+    char m_first = 0;
+    char m_firstAlt = 0;
+    char m_last = 0;
+    char m_lastAlt = 0;
+    bool m_firstIsWord = false;
+    bool m_lastIsWord = false;
+
+};
@@ -0,0 +1,326 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "utils/size_utils.h"
+#include "utils/stat_utils.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <vector>
+
+
+/**
+ * The hidden, name, size & dates filters of a search, compiled once into a flat list of checks: an opcode, a
+ * comparison and its bounds in bytes or nanoseconds since the epoch. A file is then tested against a single stat,
+ * the checks ordered from the cheapest, with no string comparison nor unit conversion left.
+ */
+class MetadataFilter {
+
+public:
+    enum class Opcode {
+        Hidden,
+        Size,
+        CreationDate,
+        ModificationDate,
+        AccessDate,
+        Filename,
+        Count
+    };
+
+    enum class Comparison {
+        Equals,
+        NotEquals,
+        Less,
+        Greater,
+        Between,
+        NotBetween,
+        Unknown         // A condition not known rejects every file
+    };
+
+    static constexpr int OPCODES_COUNT = static_cast<int>(Opcode::Count);
+
+
+    /**
+     * Files tested & rejected by each check, counted by each filter thread then summed.
+     */
+    struct Counters {
+        std::array<qint64, OPCODES_COUNT> tested = {};
+        std::array<qint64, OPCODES_COUNT> rejected = {};
+
+        Counters &operator+=(const Counters &other) {
+            for (int i = 0; i < OPCODES_COUNT; ++i) {
+                tested[i] += other.tested[i];
+                rejected[i] += other.rejected[i];
+            }
+            return *this;
+        }
+    };
+
+
+    /**
+     * Adds the hidden files check.
+     */
+    void addHidden() {
+        append({Opcode::Hidden, Comparison::Equals, 0, 0});
+    }
+
+
+    /**
+     * Adds the size check, its bounds converted to bytes.
+     * @param sizeCondition - The condition as shown to the user (e.g., "Between").
+     * @param sizeSystem - The measurement system ("SI" or "IEC").
+     */
+    void addSize(const QString &sizeCondition, const QString &sizeSystem, double size_1, double size_2,
+                 const QString &sizeUnits_1, const QString &sizeUnits_2) {
+
+        append({Opcode::Size, comparison(sizeCondition, "Less than", "Greater than"),
+                Size_Utils::convertSize(size_1, sizeUnits_1, sizeSystem),
+                Size_Utils::convertSize(size_2, sizeUnits_2, sizeSystem)});
+    }
+
+
+    /**
+     * Adds a date check, its bounds converted to nanoseconds since the epoch.
+     * @param opcode - Which date of the file is checked.
+     * @param dateCondition - The condition as shown to the user (e.g., "Before").
+     */
+    void addDate(Opcode opcode, const QString &dateCondition, const QDateTime &date_1, const QDateTime &date_2) {
+        append({opcode, comparison(dateCondition, "Before", "After"), toNs(date_1), toNs(date_2)});
+    }
+
+
+    /**
+     * Adds the filenames check, the matcher only receiving the name of the file.
+     */
+    void addFilename(const std::function<bool(const QString &)> &filenameMatcher) {
+        m_filenameMatcher = filenameMatcher;
+        append({Opcode::Filename, Comparison::Equals, 0, 0});
+    }
+
+
+    /**
+     * Orders the checks from the cheapest, once they are all added.
+     */
+    void compile() {
+        std::stable_sort(m_checks.begin(), m_checks.end(), [](const Check &a, const Check &b) {
+            return cost(a.opcode) < cost(b.opcode);
+        });
+    }
+
+
+    /**
+     * @return - true if a check needs the metadata of the files.
+     */
+    bool needsStat() const {
+        return std::any_of(m_checks.cbegin(), m_checks.cend(), [](const Check &check) {
+            return isStatCheck(check.opcode);
+        });
+    }
+
+
+    /**
+     * @return - true if there is no check, every file passes.
+     */
+    bool isEmpty() const {
+        return m_checks.empty();
+    }
+
+
+    /**
+     * Tests a file against the checks, stopping at the first one rejecting it.
+     * @param fileInfo - The file, its name only is read (plus the hidden attribute outside of Linux).
+     * @param fileStat - Its metadata, stat'ed here if the walker couldn't and a check needs it.
+     * @param counters - The counters of the calling thread.
+     * @return - true if the file passes all the checks.
+     */
+    bool matches(const QFileInfo &fileInfo, FileStat &fileStat, Counters &counters) const {
+
+        for (const Check &check : m_checks) {
+            const int opcode = static_cast<int>(check.opcode);
+            counters.tested[opcode]++;
+
+            if (isStatCheck(check.opcode) && !fileStat.valid) {
+                fileStat = Stat_Utils::fromPath(fileInfo.filePath());
+
+                // Gone since it was listed
+                if (!fileStat.valid) {
+                    counters.rejected[opcode]++;
+                    return false;
+                }
+            }
+
+            if (!test(check, fileInfo, fileStat)) {
+                counters.rejected[opcode]++;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    /**
+     * @return - The name of a check, for the statistics.
+     */
+    static QString name(Opcode opcode) {
+        switch (opcode) {
+        case Opcode::Hidden:           return "Hidden";
+        case Opcode::Size:             return "Size";
+        case Opcode::CreationDate:     return "Creation Date";
+        case Opcode::ModificationDate: return "Modification Date";
+        case Opcode::AccessDate:       return "Access Date";
+        case Opcode::Filename:         return "Filename";
+        default:                       return QString();
+        }
+    }
+
+
+
+
+private:
+    struct Check {
+        Opcode opcode;
+        Comparison comparison;
+        qint64 bound_1;     // Bytes or nanoseconds since the epoch
+        qint64 bound_2;     // Only for the ranges
+    };
+
+
+    void append(const Check &check) {
+        m_checks.push_back(check);
+    }
+
+
+    bool test(const Check &check, const QFileInfo &fileInfo, const FileStat &fileStat) const {
+
+        switch (check.opcode) {
+        case Opcode::Hidden:
+#ifdef Q_OS_LINUX
+            return !fileInfo.fileName().startsWith(QLatin1Char('.'));
+#else
+            return !fileInfo.isHidden();
+#endif
+        case Opcode::Size:
+            return compare(check, fileStat.size);
+        case Opcode::CreationDate:
+            return compare(check, toMSecsPrecision(fileStat.birthTimeNs));
+        case Opcode::ModificationDate:
+            return compare(check, toMSecsPrecision(fileStat.modifiedTimeNs));
+        case Opcode::AccessDate:
+            return compare(check, toMSecsPrecision(fileStat.accessedTimeNs));
+        case Opcode::Filename:
+            return m_filenameMatcher(fileInfo.fileName());
+        default:
+            return true;
+        }
+    }
+
+
+    static bool compare(const Check &check, const qint64 value) {
+
+        switch (check.comparison) {
+        case Comparison::Equals:     return value == check.bound_1;
+        case Comparison::NotEquals:  return value != check.bound_1;
+        case Comparison::Less:       return value < check.bound_1;
+        case Comparison::Greater:    return value > check.bound_1;
+        case Comparison::Between:    return value >= check.bound_1 && value <= check.bound_2;
+        case Comparison::NotBetween: return value < check.bound_1 || value > check.bound_2;
+        case Comparison::Unknown:    return false;
+        }
+
+        return false;
+    }
+
+
+    /**
+     * @param less - The name of the "less than" condition, "before" for the dates.
+     * @param greater - Idem for "greater than".
+     */
+    static Comparison comparison(const QString &condition, const QString &less, const QString &greater) {
+
+        if (condition == "Equals")
+            return Comparison::Equals;
+        if (condition == "Not equals")
+            return Comparison::NotEquals;
+        if (condition == less)
+            return Comparison::Less;
+        if (condition == greater)
+            return Comparison::Greater;
+        if (condition == "Between")
+            return Comparison::Between;
+        if (condition == "Not between")
+            return Comparison::NotBetween;
+
+        return Comparison::Unknown;
+    }
+
+
+    /**
+     * Relative cost of a check: the name, the size & dates (integers, the walker stats the files when a check needs
+     * it), then the filenames patterns.
+     */
+    static int cost(Opcode opcode) {
+
+        switch (opcode) {
+        case Opcode::Hidden:   return 0;
+        case Opcode::Filename: return 2;
+        default:               return 1;
+        }
+    }
+
+
+    static bool isStatCheck(Opcode opcode) {
+        return opcode == Opcode::Size || opcode == Opcode::CreationDate || opcode == Opcode::ModificationDate
+               || opcode == Opcode::AccessDate;
+    }
+
+
+    static qint64 toNs(const QDateTime &dateTime) {
+        return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() * 1000000 : -1;
+    }
+
+
+    /**
+     * The dates were compared as QDateTime, to the millisecond: the unknown times (-1) are kept before any date.
+     */
+    static qint64 toMSecsPrecision(const qint64 timeNs) {
+        return timeNs < 0 ? timeNs : timeNs - timeNs % 1000000;
+    }
+
+
+    std::vector<Check> m_checks;
+    std::function<bool(const QString &)> m_filenameMatcher;
+
+};
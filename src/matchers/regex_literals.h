@@ -0,0 +1,385 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+
+#include <algorithm>
+
+
+/**
+ * Extracts from a regex a literal that every match must contain, so the text that can't match is rejected by the
+ * literal matcher before the regex engine (and the decoding) ever runs.
+ *
+ * The analysis is conservative: the optional parts, the alternations, the character classes & escapes, and the
+ * lookarounds only end the literal runs, and the constructs that could change the matching rules (inline options,
+ * verbs, conditionals, extended syntax) disable the extraction.
+ */
+class RegexLiterals {
+
+public:
+
+    /**
+     * @param pattern - The regex.
+     * @return - The UTF-8 bytes of the longest required literal, or empty if none is worth prefiltering.
+     */
+    static QByteArray requiredLiteral(const QRegularExpression &pattern) {
+
+        const QRegularExpression::PatternOptions supportedOptions = QRegularExpression::CaseInsensitiveOption
+                                                                    | QRegularExpression::MultilineOption
+                                                                    | QRegularExpression::DontCaptureOption
+                                                                    | QRegularExpression::UseUnicodePropertiesOption;
+
+        if (!pattern.isValid() || (pattern.patternOptions() & ~supportedOptions))
+            return QByteArray();
+
+        const QString regex = pattern.pattern();
+        const bool caseInsensitive = pattern.patternOptions().testFlag(QRegularExpression::CaseInsensitiveOption);
+
+        qsizetype position = 0;
+        bool supported = true;
+        const QString literal = parseSequence(regex, position, caseInsensitive, supported);
+
+        // Stopped on an unbalanced parenthesis
+        if (!supported || position != regex.size())
+            return QByteArray();
+
+        const QByteArray bytes = literal.toUtf8();
+        return bytes.size() >= MIN_LITERAL_SIZE ? bytes : QByteArray();
+    }
+
+
+
+private:
+    static constexpr qsizetype MIN_LITERAL_SIZE = 2;
+
+
+    /**
+     * Parses a sequence of alternatives up to the closing parenthesis (not consumed) or the end.
+     * @return - The longest literal required by the sequence, empty if it holds alternatives.
+     */
+    static QString parseSequence(const QString &regex, qsizetype &position, const bool caseInsensitive, bool &supported) {
+
+        QString best;
+        QString run;
+        bool alternation = false;
+
+        auto closeRun = [&best, &run]() {
+            if (run.size() > best.size())
+                best = run;
+            run.clear();
+        };
+
+        while (position < regex.size() && supported) {
+
+            const QChar c = regex.at(position);
+
+            if (c == u')')
+                break;
+
+            if (c == u'|') {
+                alternation = true;
+                closeRun();
+                position++;
+                continue;
+            }
+
+
+            // --------------------------
+            // Groups: only the mandatory groups that don't look around can bring a literal
+            // --------------------------
+            if (c == u'(') {
+                position++;
+                closeRun();
+
+                bool lookaround = false;
+                const QStringView rest = QStringView(regex).sliced(position);
+
+                if (rest.startsWith(u"?:")) {
+                    position += 2;
+                } else if (rest.startsWith(u"?=") || rest.startsWith(u"?!")) {
+                    position += 2;
+                    lookaround = true;
+                } else if (rest.startsWith(u"?<=") || rest.startsWith(u"?<!")) {
+                    position += 3;
+                    lookaround = true;
+                } else if (rest.startsWith(u"?<") || rest.startsWith(u"?P<") || rest.startsWith(u"?'")) {
+                    const qsizetype nameEnd = regex.indexOf(rest.startsWith(u"?'") ? u'\'' : u'>',
+                                                            position + (rest.startsWith(u"?'") ? 2 : 1));
+                    if (nameEnd < 0) {
+                        supported = false;
+                        break;
+                    }
+                    position = nameEnd + 1;
+                } else if (rest.startsWith(u'?') || rest.startsWith(u'*')) {
+                    // Inline options, comments, recursions, conditionals & verbs
+                    supported = false;
+                    break;
+                }
+
+                const QString inner = parseSequence(regex, position, caseInsensitive, supported);
+                if (!supported || position >= regex.size()) {
+                    supported = false;
+                    break;
+                }
+
+                position++;     // ')'
+
+                const bool optional = skipQuantifier(regex, position);
+                if (!lookaround && !optional && inner.size() > best.size())
+                    best = inner;
+
+                continue;
+            }
+
+
+            // --------------------------
+            // Character classes
+            // --------------------------
+            if (c == u'[') {
+                skipCharacterClass(regex, position);
+                closeRun();
+                skipQuantifier(regex, position);
+                continue;
+            }
+
+
+            // --------------------------
+            // Escapes: the escaped punctuation is literal, the escaped letters & digits are classes, anchors,
+            // back-references...
+            // --------------------------
+            QString atom;
+
+            if (c == u'\\') {
+                if (position + 1 >= regex.size()) {
+                    supported = false;
+                    break;
+                }
+
+                const QChar escaped = regex.at(position + 1);
+                position += 2;
+
+                if (escaped == u'Q') {
+                    qsizetype quoteEnd = regex.indexOf(QStringLiteral("\\E"), position);
+                    if (quoteEnd < 0)
+                        quoteEnd = regex.size();
+
+                    // The quantifier (if any) only applies to the last quoted character
+                    for (qsizetype i = position; i < quoteEnd; ++i) {
+                        const QChar quoted = regex.at(i);
+                        if (i + 1 < quoteEnd || quoteEnd == regex.size())
+                            appendLiteral(run, closeRun, quoted, caseInsensitive);
+                        else
+                            atom = quoted;
+                    }
+
+                    position = std::min(quoteEnd + 2, regex.size());
+
+                    if (atom.isEmpty())
+                        continue;
+
+                } else if (escaped.isLetterOrNumber()) {
+                    skipEscapeArgument(regex, escaped, position);
+                    closeRun();
+                    skipQuantifier(regex, position);
+                    continue;
+
+                } else {
+                    atom = escaped;
+                }
+
+            } else if (c == u'.' || c == u'^' || c == u'$') {
+                position++;
+                closeRun();
+                skipQuantifier(regex, position);
+                continue;
+
+            } else if (c.isHighSurrogate() && position + 1 < regex.size()) {
+                atom = regex.mid(position, 2);
+                position += 2;
+
+            } else {
+                atom = c;
+                position++;
+            }
+
+
+            // --------------------------
+            // A literal character: a following quantifier makes it optional or ends the run after it
+            // --------------------------
+            qsizetype quantifierStart = position;
+            const bool optional = skipQuantifier(regex, position);
+
+            if (optional) {
+                closeRun();
+            } else {
+                for (const QChar &atomChar : std::as_const(atom))
+                    appendLiteral(run, closeRun, atomChar, caseInsensitive);
+
+                if (position != quantifierStart)
+                    closeRun();
+            }
+        }
+
+        closeRun();
+        return alternation ? QString() : best;
+    }
+
+
+    /**
+     * Appends a character to the current run, or ends the run if the literal matcher can't compare it: line
+     * breaks, and when case insensitive the non ASCII characters and the ASCII letters having non ASCII case
+     * variants ('k' & Kelvin sign, 's' & long s).
+     */
+    template <typename CloseRun>
+    static void appendLiteral(QString &run, CloseRun &closeRun, const QChar &c, const bool caseInsensitive) {
+
+        const char16_t unicode = c.unicode();
+        const bool breaking = unicode == u'\n' || unicode == u'\r'
+                              || (caseInsensitive && (unicode >= 0x80 || unicode == u'k' || unicode == u'K'
+                                                      || unicode == u's' || unicode == u'S'));
+        if (breaking)
+            closeRun();
+        else
+            run.append(c);
+    }
+
+
+    /**
+     * Skips the quantifier at the position, if any (lazy & possessive suffixes included).
+     * @return - true if the quantified element may be absent (?, *, {0...} & {,m}).
+     */
+    static bool skipQuantifier(const QString &regex, qsizetype &position) {
+
+        if (position >= regex.size())
+            return false;
+
+        bool optional = false;
+        const QChar c = regex.at(position);
+
+        if (c == u'?' || c == u'*') {
+            optional = true;
+            position++;
+        } else if (c == u'+') {
+            position++;
+        } else if (c == u'{') {
+            static const QRegularExpression QUANTIFIER_REGEX(R"(\{(\d*)(?:,\d*)?\})");
+            const QRegularExpressionMatch match = QUANTIFIER_REGEX.matchView(QStringView(regex), position,
+                                                                             QRegularExpression::NormalMatch,
+                                                                             QRegularExpression::AnchorAtOffsetMatchOption);
+            // Not a quantifier: a literal brace
+            if (!match.hasMatch() || match.capturedLength(0) == 2)
+                return false;
+
+            optional = match.capturedView(1).isEmpty() || match.capturedView(1).toInt() == 0;
+            position = match.capturedEnd(0);
+        } else {
+            return false;
+        }
+
+        if (position < regex.size() && (regex.at(position) == u'?' || regex.at(position) == u'+'))
+            position++;
+
+        return optional;
+    }
+
+
+    static void skipCharacterClass(const QString &regex, qsizetype &position) {
+
+        position++;     // '['
+
+        if (position < regex.size() && regex.at(position) == u'^')
+            position++;
+
+        // A leading ']' is literal
+        if (position < regex.size() && regex.at(position) == u']')
+            position++;
+
+        while (position < regex.size() && regex.at(position) != u']') {
+            if (regex.at(position) == u'\\') {
+                position += 2;
+            } else if (QStringView(regex).sliced(position).startsWith(u"[:")) {
+                const qsizetype classEnd = regex.indexOf(QStringLiteral(":]"), position + 2);
+                position = classEnd < 0 ? position + 1 : classEnd + 2;
+            } else {
+                position++;
+            }
+        }
+
+        position = std::min(position + 1, regex.size());
+    }
+
+
+    /**
+     * Skips the argument of an escape, e.g. \x41, \x{41}, \p{L}, \pL, \cA, \012, \k<name> or \g{-1}.
+     */
+    static void skipEscapeArgument(const QString &regex, const QChar &escaped, qsizetype &position) {
+
+        if (position >= regex.size())
+            return;
+
+        const QChar opening = regex.at(position);
+        QChar closing;
+
+        if (opening == u'{')
+            closing = u'}';
+        else if (opening == u'<' && (escaped == u'k' || escaped == u'g'))
+            closing = u'>';
+        else if (opening == u'\'' && (escaped == u'k' || escaped == u'g'))
+            closing = u'\'';
+
+        if (!closing.isNull()) {
+            const qsizetype argumentEnd = regex.indexOf(closing, position + 1);
+            if (argumentEnd >= 0)
+                position = argumentEnd + 1;
+            return;
+        }
+
+        auto skipWhile = [&regex, &position](auto predicate, qsizetype maximum) {
+            while (maximum-- > 0 && position < regex.size() && predicate(regex.at(position)))
+                position++;
+        };
+
+        if (escaped == u'x')
+            skipWhile([](const QChar &c) {
+                const char16_t unicode = c.unicode();
+                return (unicode >= u'0' && unicode <= u'9') || (unicode >= u'a' && unicode <= u'f')
+                       || (unicode >= u'A' && unicode <= u'F');
+            }, 2);
+        else if (escaped == u'c' || escaped == u'p' || escaped == u'P')
+            position++;
+        else if (escaped.isDigit())
+            skipWhile([](const QChar &c) { return c.isDigit(); }, 3);
+        else if (escaped == u'g')
+            skipWhile([](const QChar &c) { return c.isDigit() || c == u'-' || c == u'+'; }, 4);
+    }
+
+};
@@ -0,0 +1,233 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "matchers/aho_corasick_matcher.h"
+#include "matchers/literal_matcher.h"
+#include "matchers/regex_literals.h"
+#include "matchers/utf8_regex.h"
+
+#include <QMap>
+#include <QPair>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+
+#include <memory>
+
+
+/**
+ * Occurrences per term of a multiple terms search: term -> (occurrences, lines numbers).
+ */
+using TermsBreakdown = QMap<QString, QPair<int, QSet<int>>>;
+
+
+/**
+ * What the scanners look for: the search regex, plus a literal matcher when the text can be searched without the
+ * regex engine (fixed strings), an Aho-Corasick automaton for multiple terms, or a prefilter on the literal a regex
+ * requires. The regex is kept in any case for the highlighting, the replacing and the stream engine.
+ */
+class TextMatcher {
+
+public:
+    TextMatcher() = default;
+
+    /**
+     * Creates a matcher for a regex, prefiltered by the literal it requires (if any).
+     * @param pattern - The search regex.
+     */
+    explicit TextMatcher(const QRegularExpression &pattern) : m_pattern(pattern) {
+
+        const QByteArray requiredLiteral = RegexLiterals::requiredLiteral(pattern);
+        const bool caseInsensitive = pattern.patternOptions().testFlag(QRegularExpression::CaseInsensitiveOption);
+
+        if (!requiredLiteral.isEmpty() && LiteralMatcher::canMatch(requiredLiteral, caseInsensitive))
+            m_prefilter = LiteralMatcher(requiredLiteral, caseInsensitive, false);
+
+        // Compiled (and JIT-ed) once, shared by the copies of the scanning threads
+        auto utf8Regex = std::make_shared<const Utf8Regex>(pattern, canMatchWholeChunks(pattern));
+        if (utf8Regex->isValid())
+            m_utf8Regex = std::move(utf8Regex);
+    }
+
+
+    /**
+     * Tells whether a regex can run over many lines at once (the occurrences being still counted per line).
+     * Lookarounds & subject anchors could see the neighbouring lines, and patterns matching the empty string would
+     * produce extra matches around the line breaks: those must run line by line.
+     */
+    static bool canMatchWholeChunks(const QRegularExpression &pattern) {
+
+        static const QRegularExpression LINE_DEPENDENT_REGEX(R"(\(\?<?[=!]|\(\*|\\[AzZGK])");
+
+        return pattern.isValid()
+               && !LINE_DEPENDENT_REGEX.match(pattern.pattern()).hasMatch()
+               && !pattern.match(QString()).hasMatch();
+    }
+
+
+    /**
+     * Creates a matcher for a fixed string, searched with the literal matcher when possible.
+     * @param text - The text to find (not escaped).
+     * @param caseSensitivity - The case sensitivity of the search.
+     * @param wholeWords - Only match whole words.
+     * @param pattern - The equivalent regex.
+     */
+    static TextMatcher fixedString(const QString &text, const Qt::CaseSensitivity &caseSensitivity,
+                                   const bool &wholeWords, const QRegularExpression &pattern) {
+
+        TextMatcher textMatcher(pattern);
+
+        const QByteArray needle = text.toUtf8();
+        const bool caseInsensitive = caseSensitivity == Qt::CaseInsensitive;
+
+        if (pattern.isValid() && LiteralMatcher::canMatch(needle, caseInsensitive))
+            textMatcher.m_literal = LiteralMatcher(needle, caseInsensitive, wholeWords);
+
+        return textMatcher;
+    }
+
+
+    /**
+     * Creates a matcher looking for several fixed strings in a single pass. The automaton counts the overlapping
+     * occurrences of different terms, whereas the regex (used by a rescan, and when the automaton can't match the
+     * terms) counts the non-overlapping matches of the alternation: the counts may differ for overlapping terms.
+     * @param terms - The terms to find (not escaped).
+     * @param caseSensitivity - The case sensitivity of the search.
+     * @param wholeWords - Only match whole words.
+     * @param pattern - The equivalent regex (an alternation of the terms).
+     */
+    static TextMatcher multipleTerms(const QStringList &terms, const Qt::CaseSensitivity &caseSensitivity,
+                                     const bool &wholeWords, const QRegularExpression &pattern) {
+
+        const bool caseInsensitive = caseSensitivity == Qt::CaseInsensitive;
+
+        QList<QByteArray> utf8Terms;
+        utf8Terms.reserve(terms.size());
+        for (const QString &term : terms) {
+            const QByteArray utf8Term = term.toUtf8();
+
+            // The automaton only folds the ASCII letters, like the literal matcher: the regex takes such terms
+            if (!utf8Term.isEmpty() && !LiteralMatcher::canMatch(utf8Term, caseInsensitive))
+                return TextMatcher(pattern);
+
+            utf8Terms.append(utf8Term);
+        }
+
+        // The terms never go through the regex engine
+        TextMatcher textMatcher;
+        textMatcher.m_pattern = pattern;
+
+        // Shared by the copies of the scanning threads, the automaton is never modified once built
+        textMatcher.m_terms = std::make_shared<const AhoCorasickMatcher>(utf8Terms, caseInsensitive, wholeWords);
+        return textMatcher;
+    }
+
+
+    /**
+     * @return - A copy owning its own compiled regex, for a scanning thread.
+     */
+    TextMatcher compiledCopy() const {
+        TextMatcher textMatcher(*this);
+        textMatcher.m_pattern = QRegularExpression(m_pattern.pattern(), m_pattern.patternOptions());
+        return textMatcher;
+    }
+
+
+    const QRegularExpression &pattern() const {
+        return m_pattern;
+    }
+
+    bool isLiteral() const {
+        return m_literal.isValid();
+    }
+
+    const LiteralMatcher &literal() const {
+        return m_literal;
+    }
+
+    /**
+     * @return - true if the regex requires a literal: the text not holding it can't match.
+     */
+    bool hasPrefilter() const {
+        return m_prefilter.isValid();
+    }
+
+    const LiteralMatcher &prefilter() const {
+        return m_prefilter;
+    }
+
+    /**
+     * @return - true if the regex can run directly on UTF-8 bytes (PCRE2 available).
+     */
+    bool hasUtf8Regex() const {
+        return m_utf8Regex != nullptr;
+    }
+
+    const Utf8Regex &utf8Regex() const {
+        return *m_utf8Regex;
+    }
+
+    bool isMultipleTerms() const {
+        return m_terms != nullptr;
+    }
+
+    const AhoCorasickMatcher &terms() const {
+        return *m_terms;
+    }
+
+
+    /**
+     * @return - Literals one of which any match holds, as UTF-8 bytes (empty if a match may hold none).
+     */
+    QList<QByteArray> requiredLiterals() const {
+
+        QList<QByteArray> literals;
+
+        if (isMultipleTerms())
+            for (int i = 0; i < m_terms->termsCount(); ++i)
+                literals.append(m_terms->term(i));
+        else if (isLiteral())
+            literals.append(m_literal.needle());
+        else if (hasPrefilter())
+            literals.append(m_prefilter.needle());
+
+        return literals;
+    }
+
+
+
+private:
+    QRegularExpression m_pattern;
+    LiteralMatcher m_literal;
+    LiteralMatcher m_prefilter;
+    std::shared_ptr<const Utf8Regex> m_utf8Regex;
+    std::shared_ptr<const AhoCorasickMatcher> m_terms;
+
+};
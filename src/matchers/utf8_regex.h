@@ -0,0 +1,328 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QVector>
+
+#ifdef TEXT_DIGGER_PCRE2
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+
+/**
+ * Runs a search regex straight on UTF-8 bytes with the 8-bit PCRE2 library (JIT compiled when available), which
+ * spares the UTF-8 to UTF-16 decoding that QRegularExpression requires. Built once per search and shared read-only
+ * by the scanning threads, each of them owning its match data & JIT stack.
+ *
+ * Without PCRE2 (TEXT_DIGGER_PCRE2 undefined), the regex is never valid and the decoding engine is used.
+ */
+class Utf8Regex {
+
+public:
+
+    /**
+     * @param pattern - The search regex.
+     * @param wholeChunk - Whether the regex may run over many lines at once (see TextMatcher::canMatchWholeChunks).
+     */
+    Utf8Regex(const QRegularExpression &pattern, const bool wholeChunk) {
+
+#ifdef TEXT_DIGGER_PCRE2
+        if (!pattern.isValid())
+            return;
+
+        const QRegularExpression::PatternOptions patternOptions = pattern.patternOptions();
+        uint32_t options = PCRE2_UTF;
+
+#ifdef PCRE2_MATCH_INVALID_UTF
+        // Binary garbage in a text file must not fail the whole file
+        options |= PCRE2_MATCH_INVALID_UTF;
+#endif
+
+        if (patternOptions.testFlag(QRegularExpression::CaseInsensitiveOption))
+            options |= PCRE2_CASELESS;
+        if (patternOptions.testFlag(QRegularExpression::DotMatchesEverythingOption))
+            options |= PCRE2_DOTALL;
+        if (patternOptions.testFlag(QRegularExpression::MultilineOption))
+            options |= PCRE2_MULTILINE;
+        if (patternOptions.testFlag(QRegularExpression::ExtendedPatternSyntaxOption))
+            options |= PCRE2_EXTENDED;
+        if (patternOptions.testFlag(QRegularExpression::InvertedGreedinessOption))
+            options |= PCRE2_UNGREEDY;
+        if (patternOptions.testFlag(QRegularExpression::DontCaptureOption))
+            options |= PCRE2_NO_AUTO_CAPTURE;
+        if (patternOptions.testFlag(QRegularExpression::UseUnicodePropertiesOption))
+            options |= PCRE2_UCP;
+
+        const QByteArray regex = pattern.pattern().toUtf8();
+
+        m_lineCode = compile(regex, options);
+        if (m_lineCode && wholeChunk)
+            m_wholeCode = compile("(*ANYCRLF)" + regex, options | PCRE2_MULTILINE);
+#else
+        Q_UNUSED(pattern)
+        Q_UNUSED(wholeChunk)
+#endif
+    }
+
+
+    ~Utf8Regex() {
+#ifdef TEXT_DIGGER_PCRE2
+        pcre2_code_free(m_wholeCode);
+        pcre2_code_free(m_lineCode);
+#endif
+    }
+
+    Utf8Regex(const Utf8Regex &) = delete;
+    Utf8Regex &operator=(const Utf8Regex &) = delete;
+
+
+    bool isValid() const {
+#ifdef TEXT_DIGGER_PCRE2
+        return m_lineCode != nullptr;
+#else
+        return false;
+#endif
+    }
+
+
+    /**
+     * Finds the matches in UTF-8 text, the whole text at once when possible, line by line otherwise (a match never
+     * spans several lines, as with the decoding engine).
+     * @param data - The UTF-8 bytes, made of whole lines.
+     * @param size - The number of bytes.
+     * @param firstLineNumber - The number of the first line.
+     * @param maxMatches - The number of matches after which the search stops.
+     * @param matchesLines - Receives the line number of each match.
+     * @return - false if PCRE2 failed (e.g. JIT stack exhausted): nothing is reported, the text must be decoded.
+     */
+    bool scan(const char *data, const qsizetype size, const int firstLineNumber, const qsizetype maxMatches,
+              QVector<int> &matchesLines) const {
+
+        matchesLines.clear();
+
+#ifdef TEXT_DIGGER_PCRE2
+        if (!isValid())
+            return false;
+
+        if (m_wholeCode) {
+            const Status status = scanWhole(data, size, firstLineNumber, maxMatches, matchesLines);
+            if (status != Status::MultilineMatch)
+                return status == Status::Done;
+
+            matchesLines.clear();
+        }
+
+        return scanLines(data, size, firstLineNumber, maxMatches, matchesLines) == Status::Done;
+#else
+        Q_UNUSED(data)
+        Q_UNUSED(size)
+        Q_UNUSED(firstLineNumber)
+        Q_UNUSED(maxMatches)
+        return false;
+#endif
+    }
+
+
+
+#ifdef TEXT_DIGGER_PCRE2
+private:
+    static constexpr size_t JIT_STACK_START_SIZE = 32 * 1024;
+    static constexpr size_t JIT_STACK_MAX_SIZE = 1024 * 1024;
+
+    enum class Status {
+        Done,
+        MultilineMatch,     // A match holds a line break: the text must run line by line
+        Failed
+    };
+
+
+    static pcre2_code *compile(const QByteArray &regex, const uint32_t options) {
+
+        int errorCode = 0;
+        PCRE2_SIZE errorOffset = 0;
+
+        pcre2_code *code = pcre2_compile(reinterpret_cast<PCRE2_SPTR>(regex.constData()), regex.size(), options,
+                                         &errorCode, &errorOffset, nullptr);
+        if (!code)
+            return nullptr;
+
+        // The interpreter is used if the JIT is not available
+        pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+        return code;
+    }
+
+
+    /**
+     * The match data & JIT stack of the current thread.
+     */
+    struct MatchResources {
+        pcre2_match_data *matchData = pcre2_match_data_create(1, nullptr);
+        pcre2_match_context *matchContext = pcre2_match_context_create(nullptr);
+        pcre2_jit_stack *jitStack = pcre2_jit_stack_create(JIT_STACK_START_SIZE, JIT_STACK_MAX_SIZE, nullptr);
+
+        MatchResources() {
+            pcre2_jit_stack_assign(matchContext, nullptr, jitStack);
+        }
+
+        ~MatchResources() {
+            pcre2_jit_stack_free(jitStack);
+            pcre2_match_context_free(matchContext);
+            pcre2_match_data_free(matchData);
+        }
+    };
+
+    static MatchResources &matchResources() {
+        thread_local MatchResources resources;
+        return resources;
+    }
+
+
+    /**
+     * Iterates over the matches like QRegularExpression::globalMatch: after an empty match, a non-empty one is
+     * looked for at the same position, then the search moves on by a character.
+     * @param onMatch - Called with the (start, end) offsets of each match, returning false stops.
+     */
+    template <typename Callback>
+    static bool matchAll(const pcre2_code *code, const char *data, const qsizetype size, Callback &&onMatch) {
+
+        MatchResources &resources = matchResources();
+        const PCRE2_SPTR subject = reinterpret_cast<PCRE2_SPTR>(data);
+        const PCRE2_SIZE length = static_cast<PCRE2_SIZE>(size);
+
+        PCRE2_SIZE offset = 0;
+        uint32_t matchOptions = 0;
+
+        while (offset <= length) {
+
+            const int result = pcre2_match(code, subject, length, offset, matchOptions, resources.matchData,
+                                           resources.matchContext);
+
+            if (result == PCRE2_ERROR_NOMATCH) {
+                if (matchOptions == 0)
+                    return true;
+
+                // No non-empty match where the empty one was: move on by a character
+                offset++;
+                while (offset < length && (subject[offset] & 0xC0) == 0x80)
+                    offset++;
+
+                matchOptions = 0;
+                continue;
+            }
+
+            if (result < 0)
+                return false;
+
+            const PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(resources.matchData);
+
+            // \K may set the start after the end
+            if (ovector[0] > ovector[1])
+                return false;
+
+            if (!onMatch(static_cast<qsizetype>(ovector[0]), static_cast<qsizetype>(ovector[1])))
+                return true;
+
+            offset = ovector[1];
+            matchOptions = ovector[0] == ovector[1] ? PCRE2_NOTEMPTY_ATSTART | PCRE2_ANCHORED : 0;
+        }
+
+        return true;
+    }
+
+
+    Status scanWhole(const char *data, const qsizetype size, const int firstLineNumber, const qsizetype maxMatches,
+                     QVector<int> &matchesLines) const {
+
+        bool multilineMatch = false;
+        int lineNumber = firstLineNumber;
+        qsizetype countedUpTo = 0;
+
+        const bool succeeded = matchAll(m_wholeCode, data, size, [&](const qsizetype start, const qsizetype end) {
+
+            if (std::any_of(data + start, data + end, [](const char c) { return c == '\n' || c == '\r'; })) {
+                multilineMatch = true;
+                return false;
+            }
+
+            lineNumber += static_cast<int>(std::count(data + countedUpTo, data + start, '\n'));
+            countedUpTo = start;
+
+            matchesLines.append(lineNumber);
+            return matchesLines.size() < maxMatches;
+        });
+
+        if (!succeeded)
+            return Status::Failed;
+
+        return multilineMatch ? Status::MultilineMatch : Status::Done;
+    }
+
+
+    Status scanLines(const char *data, const qsizetype size, const int firstLineNumber, const qsizetype maxMatches,
+                     QVector<int> &matchesLines) const {
+
+        int lineNumber = firstLineNumber;
+        qsizetype lineStart = 0;
+
+        while (lineStart < size && matchesLines.size() < maxMatches) {
+
+            const char *lineBreak = static_cast<const char *>(memchr(data + lineStart, '\n', size - lineStart));
+            const qsizetype lineEnd = lineBreak ? lineBreak - data : size;
+
+            qsizetype lineLength = lineEnd - lineStart;
+            if (lineLength > 0 && data[lineStart + lineLength - 1] == '\r')
+                lineLength--;
+
+            const bool succeeded = matchAll(m_lineCode, data + lineStart, lineLength, [&](const qsizetype, const qsizetype) {
+                matchesLines.append(lineNumber);
+                return matchesLines.size() < maxMatches;
+            });
+
+            if (!succeeded)
+                return Status::Failed;
+
+            lineNumber++;
+            lineStart = lineEnd + 1;
+        }
+
+        return Status::Done;
+    }
+
+
+    pcre2_code *m_lineCode = nullptr;       // Runs on a single line
+    pcre2_code *m_wholeCode = nullptr;      // Runs on many lines at once, null if the regex depends on the lines
+#endif
+
+};
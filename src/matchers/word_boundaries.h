@@ -0,0 +1,108 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <QChar>
+#include <QtGlobal>
+
+
+/**
+ * `\b` semantics on UTF-8 bytes, shared by the byte matchers for their "match whole words" option. The search regex
+ * is built without QRegularExpression::UseUnicodePropertiesOption, so its word characters are [A-Za-z0-9_] only:
+ * the other characters, accented letters included, are never word characters here either.
+ */
+class WordBoundaries {
+
+public:
+
+    /**
+     * Same rule as the ASCII `\b` on both ends of a match: the boundary holds when the characters on each side of
+     * it differ in being word characters.
+     * @param data - The UTF-8 bytes.
+     * @param size - The number of bytes.
+     * @param start - The position of the match.
+     * @param end - The position following the match.
+     * @param firstIsWord - Whether the first character of the match is a word character.
+     * @param lastIsWord - Whether the last character of the match is a word character.
+     */
+    static bool isWholeWord(const char *data, const qsizetype size, const qsizetype start, const qsizetype end,
+                            const bool firstIsWord, const bool lastIsWord) {
+
+        const bool previousIsWord = start > 0 && isWordCodePoint(decodeBefore(data, start));
+        const bool nextIsWord = end < size && isWordCodePoint(decodeAt(data, size, end));
+
+        return previousIsWord != firstIsWord && nextIsWord != lastIsWord;
+    }
+
+
+    /**
+     * @return - true for [A-Za-z0-9_], the word characters of `\b` without the Unicode properties.
+     */
+    static bool isWordCodePoint(const char32_t codePoint) {
+        return (codePoint >= 'a' && codePoint <= 'z') || (codePoint >= 'A' && codePoint <= 'Z')
+               || (codePoint >= '0' && codePoint <= '9') || codePoint == '_';
+    }
+
+
+    /**
+     * Decodes the character starting at `position` (invalid sequences give the replacement character).
+     */
+    static char32_t decodeAt(const char *data, const qsizetype size, const qsizetype position) {
+
+        const unsigned char lead = static_cast<unsigned char>(data[position]);
+
+        if (lead < 0x80)
+            return lead;
+
+        const int continuations = lead >= 0xF0 ? 3 : (lead >= 0xE0 ? 2 : (lead >= 0xC0 ? 1 : 0));
+        if (continuations == 0 || position + continuations >= size)
+            return QChar::ReplacementCharacter;
+
+        char32_t codePoint = lead & (0x3F >> continuations);
+        for (int i = 1; i <= continuations; ++i)
+            codePoint = (codePoint << 6) | (static_cast<unsigned char>(data[position + i]) & 0x3F);
+
+        return codePoint;
+    }
+
+
+    /**
+     * Decodes the character ending right before `position`.
+     */
+    static char32_t decodeBefore(const char *data, const qsizetype position) {
+
+        // Walk back over the continuation bytes (at most 3) to the lead byte
+        qsizetype start = position - 1;
+        while (start > 0 && position - start < 4 && (static_cast<unsigned char>(data[start]) & 0xC0) == 0x80)
+            --start;
+
+        return decodeAt(data, position, start);
+    }
+
+};
@@ -28,15 +28,17 @@
 #pragma once
 
 #include "utils/size_utils.h"
-#include "operations/op_rescan_occurrences.h"
+#include "operations/op_rescan_results.h"
+#include "utils/stat_utils.h"
 
 #include <QApplication>
+#include <QHash>
 #include <QStandardItemModel>
 #include <QMimeDatabase>
+#include <QPersistentModelIndex>
+#include <QSignalBlocker>
 #include <QStyle>
 #include <QUuid>
-#include <QProgressDialog>
-#include <QMessageBox>
 
 
 class ResultsModel : public QStandardItemModel {
@@ -50,7 +52,7 @@ public:
      */
     ResultsModel(QObject *parent) : QStandardItemModel(parent) {
 
-        setColumnCount(12);
+        setColumnCount(13);
         setHorizontalHeaderItem(0, new QStandardItem("Uuid"));
         setHorizontalHeaderItem(1, new QStandardItem(""));
         setHorizontalHeaderItem(2, new QStandardItem("√"));
@@ -63,6 +65,7 @@ public:
         setHorizontalHeaderItem(9, new QStandardItem("Accessed"));
         setHorizontalHeaderItem(10, new QStandardItem("Founds"));
         setHorizontalHeaderItem(11, new QStandardItem("Search Text Pattern"));
+        setHorizontalHeaderItem(12, new QStandardItem("Terms"));
     }
 
 
@@ -74,10 +77,13 @@ public:
      * @param sizeSystem - The system to use for size conversion (e.g., "SI" or "IEC").
      * @param occurrences - The number of times a particular search term was found in the file.
      * @param linesNumbers - Set of line numbers where search terms were found.
+     * @param termsBreakdown - The occurrences & lines of each term, for a multiple terms search.
+     * @param fileStat - The metadata of the file when it was scanned, a rescan only reads it again if it changed.
      */
     void appendNew(const QFileInfo &fileInfo, const QString &filePath, const QString &mimeType, const QString &sizeSystem,
                    const int &occurrences, const QSet<int> &linesNumbers, const QRegularExpression &searchTextPattern,
-                   const bool &matchText) {
+                   const bool &matchText, const TermsBreakdown &termsBreakdown = TermsBreakdown(),
+                   const FileStat &fileStat = FileStat()) {
 
         // --------------------------
         // Generate a unique identifier for the file and center-align it
@@ -110,6 +116,8 @@ public:
         QStandardItem *filenameItem = new QStandardItem(fileInfo.fileName());
 
         QStandardItem *pathItem = new QStandardItem(filePath);
+        if (fileStat.valid)
+            setScanFingerprint(pathItem, fileStat);
 
         QStandardItem *sizeItem = new QStandardItem(Size_Utils::convertSizeToHuman(fileInfo.size(), sizeSystem));
         sizeItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
@@ -140,149 +148,174 @@ public:
         searchTextPatternItem->setData(searchTextPattern.pattern(), Qt::UserRole + 2);
         searchTextPatternItem->setData(matchText, Qt::UserRole + 3);
 
+        QStandardItem *termsItem = new QStandardItem();
+        setTermsBreakdown(termsItem, termsBreakdown);
+
 
         // --------------------------
         // Add the row to the model with all created items
         // --------------------------
         appendRow({uuidItem, iconItem, item_checkbox, filenameItem, pathItem, sizeItem, mimeTypeItem, createdItem,
-                   modifiedItem, accessedItem, occurrencesItem, searchTextPatternItem});
+                   modifiedItem, accessedItem, occurrencesItem, searchTextPatternItem, termsItem});
+
+        m_pathRows.insert(filePath, QPersistentModelIndex(indexFromItem(pathItem)));
     }
 
 
     /**
-     * Rescan the results
+     * Removes the row of a file, e.g. a result retracted by the search that found it.
+     * @param filePath - The full path to the file.
      */
-    void rescan(const bool &fileReadingTimeout, const int &timeoutFileReading, const bool &limitOccurrencesFound,
-                const int &occurrencesFoundLimit, const bool matchText, QWidget *parent = nullptr) {
-
-        if (isEmpty())
-            return;
-
-
-        startReset();  // Notify views that the model is about to undergo major changes
-
-
-        const QStandardItem *searchTextItem = item(0, 11);
-        const QString searchText = searchTextItem->data(Qt::UserRole + 2).toString();
+    void removeResult(const QString &filePath) {
 
-        QRegularExpression::PatternOptions patternOptions = QRegularExpression::NoPatternOption;
-
-        if (searchTextItem->data(Qt::UserRole + 1).toString() == "1")
-            patternOptions |= QRegularExpression::CaseInsensitiveOption;
-
-        QRegularExpression searchTextPattern = QRegularExpression(searchText, patternOptions);
+        const QPersistentModelIndex pathIndex = m_pathRows.take(filePath);
 
+        if (pathIndex.isValid())
+            removeRow(pathIndex.row());
+    }
 
-        // Create a progress dialog to show rescan progress.
-        QProgressDialog progress("Rescan files...", "Cancel", 0, rowCount(), parent);
-        progress.setWindowModality(Qt::WindowModal);
 
+    /**
+     * Lists the rows to rescan, each one remembered by a persistent index: the rows can be sorted or removed
+     * while the rescan runs in the background.
+     * @return - The file of every row & its metadata when it was scanned, in the order of the rows.
+     */
+    QVector<RescanJob> prepareRescan() {
 
-        const QMimeDatabase mimeDatabase;
-        QVector<int> rowsToDelete;
+        QVector<RescanJob> jobs;
+        jobs.reserve(rowCount());
+        m_rescanRows.clear();
+        m_rescanRows.reserve(rowCount());
 
         for (int row = 0; row < rowCount(); ++row) {
+            jobs.append({item(row, 4)->text(), scannedStat(row)});
+            m_rescanRows.append(QPersistentModelIndex(index(row, 0)));
+        }
 
-            // --------------------------
-            //
-            // --------------------------
-            QString filePath = item(row, 4)->text();
-            const QFileInfo fileInfo(filePath);
+        return jobs;
+    }
 
-            if (!fileInfo.isFile()) {
-                rowsToDelete.append(row);
-                continue;
-            }
 
+    /**
+     * Applies a batch of updates from the rescan: a single dataChanged() for the refreshed rows, the rows no
+     * longer results are removed by contiguous ranges. The rows removed meanwhile are skipped.
+     * @param updates - The updates, their job being the row position given by prepareRescan().
+     */
+    void applyRescan(const QVector<RescanUpdate> &updates) {
 
-            // --------------------------
-            //
-            // --------------------------
-            QStandardItem *iconItem = item(row, 1);
-            QStandardItem *sizeItem = item(row, 5);
-            QStandardItem *mimeTypeItem = item(row, 6);
-            QStandardItem *createdItem = item(row, 7);
-            QStandardItem *modifiedItem = item(row, 8);
-            QStandardItem *accessedItem = item(row, 9);
-            QStandardItem *occurrencesItem = item(row, 10);
-
-
-            // --------------------------
-            //
-            // --------------------------
-            QFile file(filePath);
-            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                rowsToDelete.append(row);
-                continue ;
+        QVector<int> rowsToDelete;
+        int firstRow = rowCount();
+        int lastRow = -1;
+
+        {
+            // The items would each notify the views, they are notified once for the whole batch
+            const QSignalBlocker blocker(this);
+
+            for (const RescanUpdate &update : updates) {
+                if (update.job >= m_rescanRows.size() || !m_rescanRows.at(update.job).isValid())
+                    continue;
+
+                const int row = m_rescanRows.at(update.job).row();
+
+                if (update.kind == RescanUpdate::Kind::Removed) {
+                    rowsToDelete.append(row);
+                    continue;
+                }
+
+                if (update.kind == RescanUpdate::Kind::Rescanned) {
+                    QStandardItem *occurrencesItem = item(row, 10);
+                    occurrencesItem->setText(QString::number(update.occurrences));
+                    occurrencesItem->setData(update.occurrences, Qt::UserRole + 1);
+                    occurrencesItem->setData(QVariant::fromValue(update.linesNumbers), Qt::UserRole + 2);
+
+                    // The rescan goes through the regex, which has no breakdown per term (imported rows have no item)
+                    // and doesn't count the overlapping occurrences of the terms as the automaton did
+                    if (QStandardItem *termsItem = item(row, 12))
+                        setTermsBreakdown(termsItem, TermsBreakdown());
+
+                    // The icon only depends on the suffix
+                    item(row, 6)->setText(update.mimeType);
+                }
+
+                setFileStat(row, update.fileStat);
+                firstRow = std::min(firstRow, row);
+                lastRow = std::max(lastRow, row);
             }
+        }
 
-            const QPair<int, QSet<int>> occurencesFound = RescanOccurrences::scan(file, fileReadingTimeout,
-                                                                                  timeoutFileReading, limitOccurrencesFound,
-                                                                                  occurrencesFoundLimit, searchTextPattern,
-                                                                                  progress.wasCanceled());
-
-            file.close();
-
-            // Add the result to the results QVector if any occurrences were found
-            bool shouldAppend = (matchText && occurencesFound.first > 0) || (!matchText && occurencesFound.first == 0);
-
-            if (shouldAppend) {
-                occurrencesItem->setText(QString::number(occurencesFound.first));
-                occurrencesItem->setData(occurencesFound.first, Qt::UserRole + 1);
-                occurrencesItem->setData(QVariant::fromValue(occurencesFound.second), Qt::UserRole + 2);
-            } else {
-                rowsToDelete.append(row);
-            }
+        if (firstRow <= lastRow)
+            emit dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
 
+        // Removed from the last row, by ranges of contiguous rows
+        std::sort(rowsToDelete.begin(), rowsToDelete.end());
+        for (qsizetype last = rowsToDelete.size() - 1; last >= 0; ) {
+            qsizetype first = last;
+            while (first > 0 && rowsToDelete.at(first - 1) == rowsToDelete.at(first) - 1)
+                --first;
 
-            // --------------------------
-            //
-            // --------------------------
-            // Determine the appropriate icon for the file based on type (file or folder)
-            QIcon fileIcon;
-            if (fileInfo.isDir())
-                fileIcon = QIcon::fromTheme("folder", QApplication::style()->standardIcon(QStyle::SP_DirIcon));
-            else
-                fileIcon = QIcon::fromTheme(fileInfo.suffix(), QApplication::style()->standardIcon(QStyle::SP_FileIcon));
+            removeRows(rowsToDelete.at(first), static_cast<int>(last - first + 1));
+            last = first - 1;
+        }
+    }
 
-            iconItem->setData(fileIcon, Qt::DecorationRole);
 
-            QString sizeSystem = sizeItem->data(Qt::UserRole + 2).toString();
-            sizeItem->setText(Size_Utils::convertSizeToHuman(fileInfo.size(), sizeSystem));
-            sizeItem->setData(fileInfo.size(), Qt::UserRole + 1);
-            sizeItem->setData(sizeSystem, Qt::UserRole + 2);
+    /**
+     * Forgets the rows of the rescan, once it finished or was canceled.
+     */
+    void finishRescan() {
+        m_rescanRows.clear();
+    }
 
-            mimeTypeItem->setText(mimeDatabase.mimeTypeForFile(fileInfo).name());
 
-            createdItem->setText(fileInfo.birthTime().toString("yyyy-MM-dd hh:mm:ss"));
-            createdItem->setData(fileInfo.birthTime(), Qt::UserRole);
+    /**
+     * @return - The pattern the results were found with, kept by every row.
+     */
+    QRegularExpression searchTextPattern() const {
 
-            modifiedItem->setText(fileInfo.lastModified().toString("yyyy-MM-dd hh:mm:ss"));
-            modifiedItem->setData(fileInfo.lastModified(), Qt::UserRole);
+        if (rowCount() == 0)
+            return QRegularExpression();
 
-            accessedItem->setText(fileInfo.lastRead().toString("yyyy-MM-dd hh:mm:ss"));
-            accessedItem->setData(fileInfo.lastRead(), Qt::UserRole);
+        const QStandardItem *searchTextItem = item(0, 11);
+        QRegularExpression::PatternOptions patternOptions = QRegularExpression::NoPatternOption;
 
+        if (searchTextItem->data(Qt::UserRole + 1).toString() == "1")
+            patternOptions |= QRegularExpression::CaseInsensitiveOption;
 
-            // Update the progress dialog with the current progress.
-            progress.setValue(row + 1);
+        return QRegularExpression(searchTextItem->data(Qt::UserRole + 2).toString(), patternOptions);
+    }
 
-            // Check if the user has canceled the rescan operation.
-            if (progress.wasCanceled()) {
-                QMessageBox::information(parent, "Operation Cancelled", "Rescan operation was cancelled.");
-                // return successfullyDeleted;
-                return;
-            }
 
+    /**
+     * Fills an item of the "Terms" column: "term: occurrences" for each term found, the lines in the tooltip.
+     * @param termsItem - The item to fill.
+     * @param termsBreakdown - The occurrences & lines of each term (empty when not a multiple terms search).
+     */
+    static void setTermsBreakdown(QStandardItem *termsItem, const TermsBreakdown &termsBreakdown) {
+
+        QStringList summary;
+        QStringList tooltip;
+        QVariantMap occurrencesMap;
+        QVariantMap linesMap;
+
+        for (auto it = termsBreakdown.cbegin(); it != termsBreakdown.cend(); ++it) {
+            QList<int> lines = it.value().second.values();
+            std::sort(lines.begin(), lines.end());
+
+            QStringList linesText;
+            linesText.reserve(lines.size());
+            for (const int &line : std::as_const(lines))
+                linesText.append(QString::number(line));
+
+            summary.append(QString("%1: %2").arg(it.key()).arg(it.value().first));
+            tooltip.append(QString("%1 (lines %2)").arg(it.key(), linesText.join(", ")));
+            occurrencesMap.insert(it.key(), it.value().first);
+            linesMap.insert(it.key(), QVariant::fromValue(it.value().second));
         }
 
-        // Delete rows in reverse order from the collected list
-        for (int i = rowsToDelete.size() - 1; i >= 0; --i)
-            removeRow(rowsToDelete[i]);
-
-
-        finishReset();  // Notify views that the model update is complete, prompting a full refresh
-
+        termsItem->setText(summary.join(", "));
+        termsItem->setToolTip(tooltip.join("\n"));
+        termsItem->setData(occurrencesMap, Qt::UserRole + 1);
+        termsItem->setData(linesMap, Qt::UserRole + 2);
     }
 
 
@@ -298,6 +331,7 @@ public:
      * Clears all data from the model.
      */
     void clearModel() {
+        m_pathRows.clear();
         removeRows(0, rowCount());
     }
 
@@ -328,4 +362,66 @@ public:
     }
 
 
+
+
+private:
+
+    /**
+     * Keeps the identity, size & modification time of a file when it was scanned, in the path item.
+     */
+    static void setScanFingerprint(QStandardItem *pathItem, const FileStat &fileStat) {
+        pathItem->setData(static_cast<qulonglong>(fileStat.inode), Qt::UserRole + 1);
+        pathItem->setData(fileStat.size, Qt::UserRole + 2);
+        pathItem->setData(fileStat.modifiedTimeNs, Qt::UserRole + 3);
+    }
+
+
+    /**
+     * @return - The identity, size & modification time of the file of a row when it was scanned, invalid for the
+     * imported rows.
+     */
+    FileStat scannedStat(const int row) const {
+        const QStandardItem *pathItem = item(row, 4);
+
+        FileStat fileStat;
+        fileStat.valid = pathItem->data(Qt::UserRole + 1).isValid();
+        fileStat.inode = pathItem->data(Qt::UserRole + 1).toULongLong();
+        fileStat.size = pathItem->data(Qt::UserRole + 2).toLongLong();
+        fileStat.modifiedTimeNs = pathItem->data(Qt::UserRole + 3).toLongLong();
+        return fileStat;
+    }
+
+
+    /**
+     * Refreshes the size & dates of a row, only the items that changed.
+     */
+    void setFileStat(const int row, const FileStat &fileStat) {
+
+        setScanFingerprint(item(row, 4), fileStat);
+
+        QStandardItem *sizeItem = item(row, 5);
+        if (sizeItem->data(Qt::UserRole + 1).toLongLong() != fileStat.size) {
+            sizeItem->setText(Size_Utils::convertSizeToHuman(fileStat.size, sizeItem->data(Qt::UserRole + 2).toString()));
+            sizeItem->setData(fileStat.size, Qt::UserRole + 1);
+        }
+
+        setDateItem(item(row, 7), fileStat.birthTime());
+        setDateItem(item(row, 8), fileStat.lastModified());
+        setDateItem(item(row, 9), fileStat.lastRead());
+    }
+
+
+    static void setDateItem(QStandardItem *dateItem, const QDateTime &dateTime) {
+        if (dateItem->data(Qt::UserRole).toDateTime() == dateTime)
+            return;
+
+        dateItem->setText(dateTime.toString("yyyy-MM-dd hh:mm:ss"));
+        dateItem->setData(dateTime, Qt::UserRole);
+    }
+
+
+    QVector<QPersistentModelIndex> m_rescanRows;    // The rows of the running rescan, by job
+    QHash<QString, QPersistentModelIndex> m_pathRows;   // The row of each result found by the search, by path
+
+
 };
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include "hash/checksum_utils.h"
+#include "matchers/metadata_filter.h"
 #include "models/results_model.h"
 
 #include <QDateTime>
@@ -171,6 +173,91 @@ public:
         // --------------------------
         appendNew("Processed directories", QString::number(m_statisticsMap.value("Processed Directories")));
         appendNew("Processed files", QString::number(m_statisticsMap.value("Processed Files")));
+        appendNew("Walking threads", QString::number(m_statisticsMap.value("Walking Threads")));
+        appendNew("Filtering threads", QString::number(m_statisticsMap.value("Filtering Threads")));
+        appendNew("Scanning threads", QString::number(m_statisticsMap.value("Scanning Threads")));
+        appendNew("Traversal time", QString("%1 ms").arg(m_statisticsMap.value("Traversal Time")));
+
+        // Only the native (Linux) walker counts its system calls
+        const qint64 walkSyscalls = m_statisticsMap.value("Walk Syscalls");
+        const qint64 processedFiles = m_statisticsMap.value("Processed Files");
+        if (walkSyscalls > 0) {
+            appendNew("Walk syscalls", QString::number(walkSyscalls));
+            if (processedFiles > 0)
+                appendNew("Walk syscalls per file", QString::number(double(walkSyscalls) / processedFiles, 'f', 2));
+        }
+
+        // Throughput of a single scanner: the scanning time is cumulated over the scanning threads
+        const qint64 scannedBytes = m_statisticsMap.value("Scanned Bytes");
+        const qint64 scanningTime = m_statisticsMap.value("Scanning Time");
+        appendNew("Scanned data", Size_Utils::convertSizeToHuman(scannedBytes, "SI"));
+        if (scanningTime > 0)
+            appendNew("Scanning throughput", QString("%1 MB/s per thread").arg(double(scannedBytes) / scanningTime, 0, 'f', 1));
+
+        // Only a regex requiring a literal is prefiltered
+        const qint64 prefilteredBytes = m_statisticsMap.value("Prefiltered Bytes");
+        if (prefilteredBytes > 0 && scannedBytes > 0)
+            appendNew("Eliminated by the prefilter", QString("%1 (%2%)").arg(Size_Utils::convertSizeToHuman(prefilteredBytes, "SI"))
+                                                                          .arg(100.0 * prefilteredBytes / scannedBytes, 0, 'f', 1));
+
+        // A repeated search only walks & scans the changes recorded by the journal
+        const qint64 reusedResults = m_statisticsMap.value("Reused Results");
+        if (reusedResults > 0)
+            appendNew("Reused from the last search", QString("%1 results (%2 changes since)")
+                                                         .arg(reusedResults)
+                                                         .arg(m_statisticsMap.value("Journal Changes")));
+
+        // The outcomes of the files unchanged since the same scan are taken from the results cache
+        const qint64 resultsCacheHits = m_statisticsMap.value("Results Cache Hits");
+        const qint64 resultsCacheMisses = m_statisticsMap.value("Results Cache Misses");
+        if (resultsCacheHits + resultsCacheMisses > 0)
+            appendNew("Results from the cache", QString("%1 hits, %2 misses (%3%)")
+                                                    .arg(resultsCacheHits)
+                                                    .arg(resultsCacheMisses)
+                                                    .arg(100.0 * resultsCacheHits / (resultsCacheHits + resultsCacheMisses), 0, 'f', 1));
+
+        // The filters are tested from the cheapest, each one only seeing the files the previous ones accepted
+        for (int opcode = 0; opcode < MetadataFilter::OPCODES_COUNT; ++opcode) {
+            const QString name = MetadataFilter::name(static_cast<MetadataFilter::Opcode>(opcode));
+            const qint64 tested = m_statisticsMap.value("Filter Tested " + name);
+            const qint64 rejected = m_statisticsMap.value("Filter Rejected " + name);
+
+            if (tested > 0)
+                appendNew(QString("Rejected by the %1 filter").arg(name.toLower()),
+                          QString("%1 of %2 (%3%)").arg(rejected).arg(tested)
+                                                   .arg(100.0 * rejected / tested, 0, 'f', 1));
+        }
+
+        // Only the files known to a trigram index, unchanged since, are ruled out without being read
+        const qint64 indexSkippedFiles = m_statisticsMap.value("Index Skipped Files");
+        if (indexSkippedFiles > 0)
+            appendNew("Ruled out by the index", QString::number(indexSkippedFiles));
+
+        // Only the files sharing a size are hashed to find the duplicates
+        const qint64 duplicateFiles = m_statisticsMap.value("Duplicate Files");
+        if (duplicateFiles > 0) {
+            appendNew("Duplicate files", QString("%1 (%2 hard links)").arg(duplicateFiles)
+                                                                       .arg(m_statisticsMap.value("Hard Links")));
+            appendNew("Hashed for the duplicates", Size_Utils::convertSizeToHuman(m_statisticsMap.value("Duplicates Hashed Bytes"), "SI"));
+
+            // Reading included, cumulated over the threads like the scanning time
+            const qint64 hashingTime = m_statisticsMap.value("Duplicates Hashing Time");
+            if (hashingTime > 0)
+                appendNew("Hashing throughput", QString("%1 GB/s per thread (%2)")
+                                                    .arg(double(m_statisticsMap.value("Duplicates Hashed Bytes")) / hashingTime / 1000, 0, 'f', 2)
+                                                    .arg(ChecksumUtils::contentHashAlgorithm()));
+
+            const qint64 cacheHits = m_statisticsMap.value("Hashes Cache Hits");
+            if (cacheHits > 0)
+                appendNew("Hashes from the cache", QString::number(cacheHits));
+        }
+
+        // The MIME types are only resolved for the MIME filter and the results
+        const qint64 mimeLookups = m_statisticsMap.value("MIME Lookups");
+        const qint64 mimeCacheHits = m_statisticsMap.value("MIME Cache Hits");
+        if (mimeLookups > 0)
+            appendNew("MIME types from the cache", QString("%1 of %2 (%3%)").arg(mimeCacheHits).arg(mimeLookups)
+                                                                          .arg(100.0 * mimeCacheHits / mimeLookups, 0, 'f', 1));
 
 
         // --------------------------
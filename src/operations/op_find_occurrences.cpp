@@ -30,27 +30,32 @@
 
 #include <QTimer>
 #include <QThread>
+#include <QThreadPool>
 #include <QMimeType>
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QDataStream>
+
+#include <atomic>
+#include <memory>
 
 #include "constants/constants.h"
 #include "utils/file_utils.h"
 #include "utils/datetime_utils.h"
-#include "hash/checksum_utils.h"
+#include "operations/op_walk_directories.h"
 
 
 // *******************************************************************************************************************
 // ************************************************** Constructors ***************************************************
 // *******************************************************************************************************************
 FindOccurrences::FindOccurrences(QSet<QString> &directories, QSet<QString> &excludeDirs, QSet<QMimeType> &mimetypes,
-                                 QStringList &filesList, ResultsModel *&resultsModel, QRegularExpression &searchTextPattern,
-                                 QString &targetFilenames, QVector<QRegularExpression> &filenamesPatterns,
-                                 FilterWidget::PatternSyntax patternSyntax_Filenames,
+                                 QRegularExpression &searchTextPattern, const TextMatcher &textMatcher,
+                                 QString &targetFilenames, FilterWidget::PatternSyntax patternSyntax_Filenames,
                                  Qt::CaseSensitivity filenamesCaseSensitivity, bool matchText, bool dontMatchfilenames,
                                  bool subdirectories, int minDepth, int maxDepth, bool ignoreHiddenDirectories,
                                  bool ignoreHiddenFiles, bool ignoreSymbolicDirectoriesLinks,
                                  bool ignoreSymbolicFilesLinks, bool findExactFilename, bool ignoreUnparseableFiles,
-                                 bool avoidDuplicates, QSet<QString> &filesHashes_Set, QDir::Filters filtersDirectories,
+                                 bool avoidDuplicates, bool listDuplicatesOnly, QDir::Filters filtersDirectories,
                                  QDir::Filters filtersFiles, QString &sizeCondition, QString &sizeSystem,
                                  double size_1, double size_2, QString &sizeUnits_1, QString &sizeUnits_2,
                                  QString &creationDateCondition, QDateTime &creationDate_1, QDateTime &creationDate_2,
@@ -60,18 +65,19 @@ FindOccurrences::FindOccurrences(QSet<QString> &directories, QSet<QString> &excl
                                  bool filterByCreationDate, bool filterByLastModificationDate,
                                  bool filterByLastAccessDate, bool filterByMimeTypes, bool fileReadingTimeout,
                                  bool limitFilesToParse, bool limitOccurrencesFound, int timeoutFileReading,
-                                 int filesToParseLimit, int occurrencesFoundLimit, QObject *parent)
+                                 int filesToParseLimit, int occurrencesFoundLimit, int scanThreads,
+                                 bool listMatchingFilesOnly, bool useTrigramIndex, ChangeJournal *changeJournal,
+                                 SearchSnapshot *searchSnapshot, bool cacheResults, QObject *parent)
 
     : QObject(parent),
     m_cancel(false),
     m_directoriesToInclude(directories),
     m_directoriesToExclude(excludeDirs),
+    m_excludedDirectories(excludeDirs),
     m_mimetypes(mimetypes),
-    m_filesList(filesList),
-    m_resultsModel(resultsModel),
     m_searchTextPattern(searchTextPattern),
+    m_textMatcher(textMatcher),
     m_targetFilenames(targetFilenames),
-    m_filenamesPatterns(filenamesPatterns),
     m_patternSyntax_Filenames(patternSyntax_Filenames),
     m_filenamesCaseSensitivity(filenamesCaseSensitivity),
     m_matchText(matchText),
@@ -84,9 +90,10 @@ FindOccurrences::FindOccurrences(QSet<QString> &directories, QSet<QString> &excl
     m_ignoreSymbolicDirectoriesLinks(ignoreSymbolicDirectoriesLinks),
     m_ignoreSymbolicFilesLinks(ignoreSymbolicFilesLinks),
     m_findExactFilename(findExactFilename),
+    m_filenameMatcher(targetFilenames, patternSyntax_Filenames, filenamesCaseSensitivity, findExactFilename),
     m_ignoreUnparseableFiles(ignoreUnparseableFiles),
     m_avoidDuplicates(avoidDuplicates),
-    m_filesHashes_Set(filesHashes_Set),
+    m_listDuplicatesOnly(listDuplicatesOnly),
     m_filtersDirectories(filtersDirectories),
     m_filtersFiles(filtersFiles),
     m_sizeCondition(sizeCondition),
@@ -114,7 +121,13 @@ FindOccurrences::FindOccurrences(QSet<QString> &directories, QSet<QString> &excl
     m_limitOccurrencesFound(limitOccurrencesFound),
     m_timeoutFileReading(timeoutFileReading),
     m_filesToParseLimit(filesToParseLimit),
-    m_occurrencesFoundLimit(occurrencesFoundLimit) { }
+    m_occurrencesFoundLimit(occurrencesFoundLimit),
+    m_scanThreads(scanThreads > 0 ? scanThreads : std::max(1, QThread::idealThreadCount())),
+    m_listMatchingFilesOnly(listMatchingFilesOnly),
+    m_useTrigramIndex(useTrigramIndex),
+    m_changeJournal(changeJournal),
+    m_searchSnapshot(searchSnapshot),
+    m_cacheResults(cacheResults) { }
 
 
 
@@ -125,40 +138,101 @@ void FindOccurrences::start() {
     
     qDebug() << "Searching operation started...";
     
+    compileMetadataFilter();
+
+    // The trigram indexes are brought up to date first, they must be complete to rule out files
+    prepareTrigramIndexes();
+
+    // An identical search over unchanged directories reuses the last results
+    prepareRepeatedSearch();
+
+    emit updateStatusBarOperation("Searching Occurrences : ");
+    
     // --------------------------
-    // Parse directories for files
+    // The stages run at the same time, connected by bounded queues: the walker feeds the paths queue, the filters
+    // feed the scan queue and the scanners send their results to the GUI thread in batches. A full queue blocks
+    // its producers, so the memory stays bounded whatever the size of the tree.
     // --------------------------
-    parseDirectories();
+    BlockingQueue<FileScanResult> pathsQueue(PATHS_QUEUE_CAPACITY, m_cancel);
+    BlockingQueue<FileScanResult> scanQueue(SCAN_QUEUE_CAPACITY, m_cancel);
+    
+    // The stages share the threads budget, the scanners taking the most of it: a stage runs at least one thread
+    m_walkingThreads = std::max(1, m_scanThreads / 4);
+    m_filteringThreads = std::max(1, m_scanThreads / 4);
+    m_scanningThreads = std::max(1, m_scanThreads - m_walkingThreads - m_filteringThreads);
+    std::atomic<int> runningFilters = m_filteringThreads;
+    
+    // The hashes of the files unchanged since a previous search are not computed again
+    std::unique_ptr<Database_Hashes> hashesCache;
+    if (m_avoidDuplicates || m_listDuplicatesOnly) {
+        hashesCache = std::make_unique<Database_Hashes>();
+        m_duplicatesDetector.setCache(hashesCache.get());
+    }
     
-    if (m_cancel) {
-        QStringList().swap(m_filesList);
-        setStatistics();
-        emit canceled(m_statisticsMap);
-        return;
+    // The outcomes of the files unchanged since the same scan are not computed again. A scan stopped by the timeout
+    // would be cached as complete.
+    std::unique_ptr<Database_Results> resultsCache;
+    if (m_cacheResults && !m_listDuplicatesOnly && !m_fileReadingTimeout) {
+        resultsCache = std::make_unique<Database_Results>(scanFingerprint());
+        m_resultsCache = resultsCache.get();
     }
     
-    std::sort(m_filesList.begin(), m_filesList.end());
+    // The walker task runs the first walking thread, the current thread the first scanner
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(1 + m_filteringThreads + m_scanningThreads - 1);
     
-    // for (const QString &file : m_filesList)
-    //     qDebug() << "Found File : " << file;
+    threadPool.start([this, &pathsQueue]() {
+        parseDirectories(pathsQueue);
+        pathsQueue.close();
+    });
     
+    for (int filter = 0; filter < m_filteringThreads; ++filter) {
+        threadPool.start([this, &pathsQueue, &scanQueue, &runningFilters]() {
+            filterFiles(pathsQueue, scanQueue);
+            
+            // The last filter to finish tells the scanners that nothing more is coming
+            if (--runningFilters == 0)
+                scanQueue.close();
+        });
+    }
     
-    // --------------------------
-    // Filter & Finding inside files
-    // --------------------------
-    filterFiles();
+    for (int scanner = 1; scanner < m_scanningThreads; ++scanner)
+        threadPool.start([this, &scanQueue]() { scanFiles(scanQueue); });
+    
+    // The current thread takes part in the scanning as the first scanner
+    scanFiles(scanQueue);
+    threadPool.waitForDone();
+    m_duplicatesDetector.setCache(nullptr);
+    m_trigramIndexes.clear();
+
+    if (m_resultsCache) {
+        m_statsResultsCacheHits = m_resultsCache->hits();
+        m_statsResultsCacheMisses = m_resultsCache->misses();
+        m_resultsCache = nullptr;
+    }
+
+    // Only a complete search can be repeated from its results
+    if (m_searchSnapshot) {
+        m_searchSnapshot->fingerprint.reset();
+        m_searchSnapshot->results.clear();
+
+        if (!m_cancel && m_changeJournal) {
+            m_snapshotResults.removeIf([this](const FileScanResult &result) {
+                return m_retractedPaths.contains(result.filePath);
+            });
+
+            m_searchSnapshot->fingerprint = m_fingerprint;
+            m_searchSnapshot->results = std::move(m_snapshotResults);
+        }
+    }
     
-    // for (const QString& file : m_filesList)
-    //     qDebug() << "Filtered File : " << file;
     
     if (m_cancel) {
-        QStringList().swap(m_filesList);
         setStatistics();
         emit canceled(m_statisticsMap);
         return;
     }
     
-
     setStatistics();
     emit finished(m_statisticsMap);
 }
@@ -169,12 +243,304 @@ void FindOccurrences::cancel() {
 }
 
 
+// *******************************************************************************************************************
+// ************************************************* Trigram Indexes *************************************************
+// *******************************************************************************************************************
+void FindOccurrences::prepareTrigramIndexes() {
+
+    m_trigramIndexes.clear();
+
+    // The indexes cover whole trees, and only help when the matches hold a literal of 3 bytes at least
+    if (!m_useTrigramIndex || m_listDuplicatesOnly || !m_subdirectories)
+        return;
+
+    const TrigramIndex::Query query(m_textMatcher.requiredLiterals());
+    if (!query.isUsable())
+        return;
+
+    excludeSubdirectoriesWithParents();
+
+    for (const QString &directory : std::as_const(m_directoriesToInclude)) {
+        if (m_cancel)
+            return;
+
+        if (TrigramIndex::isOutdated(directory)) {
+            emit updateStatusBarOperation("Indexing : ");
+            emit updateStatusBarMessage(directory);
+
+            if (!TrigramIndex::build(directory, m_scanThreads, m_cancel))
+                continue;
+        }
+
+        auto index = std::make_unique<TrigramIndex>();
+        if (!index->open(directory))
+            continue;
+
+        index->select(query);
+        m_trigramIndexes.push_back(std::move(index));
+    }
+}
+
+
+/**
+ * @return - true if the trigram index covering the file knows it, unchanged, and rules it out.
+ */
+bool FindOccurrences::indexesRuleOut(const FileScanResult &scanResult) const {
+
+    for (const std::unique_ptr<TrigramIndex> &index : m_trigramIndexes)
+        if (index->covers(scanResult.filePath))
+            return !index->mayMatch(scanResult.filePath, scanResult.fileStat);
+
+    return false;
+}
+
+
+// *******************************************************************************************************************
+// ************************************************* Repeated Search *************************************************
+// *******************************************************************************************************************
+/**
+ * @return - A hash of everything the scan outcome of a file depends on: the searched text & the scanning options.
+ */
+Hash128 FindOccurrences::scanFingerprint() const {
+
+    QByteArray options;
+    QDataStream stream(&options, QIODevice::WriteOnly);
+
+    stream << m_searchTextPattern.pattern() << int(m_searchTextPattern.patternOptions())
+           << m_textMatcher.isLiteral() << m_textMatcher.isMultipleTerms() << m_textMatcher.requiredLiterals()
+           << (!m_matchText || m_listMatchingFilesOnly) << m_ignoreUnparseableFiles
+           << m_limitOccurrencesFound << m_occurrencesFoundLimit;
+
+    return ChecksumUtils::calculateContentHash(options);
+}
+
+
+/**
+ * @return - A hash of everything the results depend on: the directories, the searched text & the filters.
+ */
+Hash128 FindOccurrences::searchFingerprint() const {
+
+    QStringList directoriesToInclude(m_directoriesToInclude.cbegin(), m_directoriesToInclude.cend());
+    QStringList directoriesToExclude(m_directoriesToExclude.cbegin(), m_directoriesToExclude.cend());
+    QStringList mimetypes;
+    for (const QMimeType &mimetype : m_mimetypes)
+        mimetypes.append(mimetype.name());
+
+    directoriesToInclude.sort();
+    directoriesToExclude.sort();
+    mimetypes.sort();
+
+    QByteArray options;
+    QDataStream stream(&options, QIODevice::WriteOnly);
+
+    stream << directoriesToInclude << directoriesToExclude << mimetypes
+           << m_searchTextPattern.pattern() << int(m_searchTextPattern.patternOptions())
+           << m_textMatcher.isLiteral() << m_textMatcher.isMultipleTerms() << m_textMatcher.requiredLiterals()
+           << m_targetFilenames << int(m_patternSyntax_Filenames) << int(m_filenamesCaseSensitivity)
+           << m_matchText << m_dontMatchfilenames << m_subdirectories << m_minDepth << m_maxDepth
+           << m_ignoreHiddenDirectories << m_ignoreHiddenFiles << m_ignoreSymbolicDirectoriesLinks
+           << m_ignoreSymbolicFilesLinks << m_findExactFilename << m_ignoreUnparseableFiles
+           << m_avoidDuplicates << m_listDuplicatesOnly
+           << m_filterBySize << m_sizeCondition << m_sizeSystem << m_size_1 << m_size_2
+           << m_sizeUnits_1 << m_sizeUnits_2
+           << m_filterByCreationDate << m_creationDateCondition << m_creationDate_1 << m_creationDate_2
+           << m_filterByLastModificationDate << m_lastModificationCondition
+           << m_lastModificationDate_1 << m_lastModificationDate_2
+           << m_filterByLastAccessDate << m_lastAccessDateCondition << m_lastAccessDate_1 << m_lastAccessDate_2
+           << m_filterByMimeTypes << m_fileReadingTimeout << m_timeoutFileReading
+           << m_limitFilesToParse << m_filesToParseLimit << m_limitOccurrencesFound << m_occurrencesFoundLimit
+           << m_listMatchingFilesOnly;
+
+    return ChecksumUtils::calculateContentHash(options);
+}
+
+
+void FindOccurrences::prepareRepeatedSearch() {
+
+    m_repeatedSearch = false;
+
+    if (!m_changeJournal || !m_searchSnapshot)
+        return;
+
+    // The results depend on each other (duplicates, limit of files) or on reading the files (access dates)
+    const bool reusable = !m_avoidDuplicates && !m_listDuplicatesOnly && !m_limitFilesToParse
+                          && !m_filterByLastAccessDate;
+
+    if (!reusable || !m_changeJournal->isAvailable()) {
+        m_changeJournal->clear();
+        m_changeJournal = nullptr;      // Nothing watched nor recorded for the next search
+        return;
+    }
+
+    if (m_subdirectories)
+        excludeSubdirectoriesWithParents();
+
+    // Other directories or other options: the watches of the last search are of no use
+    m_fingerprint = searchFingerprint();
+    const bool sameSearch = m_searchSnapshot->fingerprint == m_fingerprint;
+
+    if (!sameSearch)
+        m_changeJournal->clear();
+
+    // The journal starts recording the changes for the next search from now on
+    m_journalChanges = m_changeJournal->takeChanges();
+    m_repeatedSearch = sameSearch && m_journalChanges.complete;
+
+    if (m_repeatedSearch)
+        m_statsJournalChanges = m_journalChanges.files.size() + m_journalChanges.directories.size();
+    else
+        m_journalChanges = ChangeJournal::Changes();
+}
+
+
+/**
+ * Sends again the results of the last search the journal saw unchanged.
+ */
+void FindOccurrences::reuseSnapshot() {
+
+    QVector<FileScanResult> batch;
+
+    const auto sendBatch = [this, &batch]() {
+        {
+            QMutexLocker locker(&m_snapshotMutex);
+            m_snapshotResults.append(batch);
+        }
+
+        m_statsReusedResults += batch.size();
+        emit resultsFound(batch);
+        batch.clear();
+    };
+
+    for (const FileScanResult &result : std::as_const(m_searchSnapshot->results)) {
+        if (m_cancel)
+            return;
+
+        if (isChanged(result.filePath))
+            continue;
+
+        batch.append(result);
+        if (batch.size() >= RESULTS_BATCH_SIZE)
+            sendBatch();
+    }
+
+    if (!batch.isEmpty())
+        sendBatch();
+}
+
+
+/**
+ * Walks the directories changed since the last search, and hands the changed files to the filters, as the full walk
+ * would have (same filters, same depths from the searched directories).
+ */
+void FindOccurrences::walkChanges(BlockingQueue<FileScanResult> &pathsQueue, const bool needMetadata) {
+
+    const int minDepth = m_subdirectories ? m_minDepth : 0;
+    const int maxDepth = m_subdirectories ? m_maxDepth : 0;
+
+    QSet<QString> roots;
+    for (const QString &directory : std::as_const(m_directoriesToInclude))
+        roots.insert(QFileInfo(directory).absoluteFilePath());
+
+    // The depth of a path below the searched directories, -1 if outside
+    const PathTrie rootsTrie(roots);
+
+    const auto parentOf = [](const QString &path) {
+        return path.left(path.lastIndexOf('/'));
+    };
+
+
+    // --------------------------
+    // The changed subtrees, walked from their depth (a subtree within another one is walked with it)
+    // --------------------------
+    QMap<int, QSet<QString>> directoriesByDepth;
+
+    for (const QString &directory : std::as_const(m_journalChanges.directories)) {
+        const int depth = rootsTrie.depthBelow(directory);
+        if (depth < 0 || depth > maxDepth || (depth > 0 && isChanged(parentOf(directory))))
+            continue;
+
+        // The walker checks the subdirectories it enters, not the directories it starts from
+        const QFileInfo directoryInfo(directory);
+        if (!directoryInfo.isDir())
+            continue;
+
+        if (depth > 0 && (m_excludedDirectories.covers(directory)
+                          || (m_ignoreHiddenDirectories && directoryInfo.isHidden())
+                          || (m_ignoreSymbolicDirectoriesLinks && directoryInfo.isSymLink())))
+            continue;
+
+        directoriesByDepth[depth].insert(directory);
+    }
+
+    const auto watch = [this](const QString &directory) { m_changeJournal->watch(directory); };
+
+    for (auto it = directoriesByDepth.cbegin(); it != directoriesByDepth.cend() && !m_cancel; ++it) {
+        WalkDirectories walker(m_filtersDirectories, m_filtersFiles, m_excludedDirectories, m_subdirectories,
+                               minDepth - it.key(), maxDepth - it.key(), false, 0, needMetadata,
+                               m_walkingThreads, m_cancel);
+
+        walker.walk(it.value(), watch, [&pathsQueue](const QString &filePath, const FileStat &fileStat) {
+            FileScanResult scanResult;
+            scanResult.filePath = filePath;
+            scanResult.fileStat = fileStat;
+            return pathsQueue.push(std::move(scanResult));
+        });
+
+        m_statsProcessedDirectories += walker.processedDirectories();
+        m_statsProcessedFiles += walker.processedFiles();
+        m_statsWalkSyscalls += walker.syscalls();
+    }
+
+
+    // --------------------------
+    // The changed files of the directories that weren't walked again
+    // --------------------------
+    for (const QString &filePath : std::as_const(m_journalChanges.files)) {
+        if (m_cancel)
+            return;
+
+        const QString directory = parentOf(filePath);
+        const int depth = rootsTrie.depthBelow(directory);
+        if (depth < 0 || depth > maxDepth || depth < minDepth || isChanged(directory))
+            continue;
+
+        // Deleted files are simply not reported again
+        const QFileInfo fileInfo(filePath);
+        if (!fileInfo.isFile() || !fileInfo.isReadable() || (m_ignoreSymbolicFilesLinks && fileInfo.isSymLink()))
+            continue;
+
+        FileScanResult scanResult;
+        scanResult.filePath = filePath;
+        if (needMetadata)
+            scanResult.fileStat = Stat_Utils::fromPath(filePath);
+
+        m_statsProcessedFiles++;
+        if (!pathsQueue.push(std::move(scanResult)))
+            return;
+    }
+}
+
+
+/**
+ * @return - true if the journal recorded a change of the file, or of a directory above it.
+ */
+bool FindOccurrences::isChanged(const QString &filePath) const {
+
+    if (m_journalChanges.files.contains(filePath) || m_journalChanges.directories.contains(filePath))
+        return true;
+
+    for (qsizetype slash = filePath.lastIndexOf('/'); slash > 0; slash = filePath.lastIndexOf('/', slash - 1))
+        if (m_journalChanges.directories.contains(filePath.left(slash)))
+            return true;
+
+    return false;
+}
+
+
 // *******************************************************************************************************************
 // ************************************************ Parse Directories ************************************************
 // *******************************************************************************************************************
-void FindOccurrences::parseDirectories() {
-    
-    emit updateStatusBarOperation("Parsing directories : ");
+void FindOccurrences::parseDirectories(BlockingQueue<FileScanResult> &pathsQueue) {
     
     // --------------------------
     // Remove directories from a the initial list if they have a parent or ancestor directory that is
@@ -203,240 +569,370 @@ void FindOccurrences::parseDirectories() {
     
     
     // --------------------------
-    //
+    // Walk the directories with the work-stealing walker
     // --------------------------
-    for (auto it = m_directoriesToInclude.constBegin(); it != m_directoriesToInclude.constEnd(); ++it) {
-        if (m_cancel)
-            return;
-
-        const QString &dirPath = *it;
-        parseDirectory(dirPath, 0, m_statsProcessedFiles);
+    QElapsedTimer traversalTimer;
+    traversalTimer.start();
+
+    // The walker only gathers the metadata (one statx per file on Linux) when a filter, the duplicates detection
+    // (sizes & inodes), the trigram indexes or the results cache (sizes & modification times) need it
+    const bool needMetadata = m_metadataFilter.needsStat() || m_avoidDuplicates || m_listDuplicatesOnly
+                              || !m_trigramIndexes.empty() || m_resultsCache;
+
+    // A repeated search only walks what changed since the last one, the other results being reused
+    if (m_repeatedSearch) {
+        reuseSnapshot();
+        walkChanges(pathsQueue, needMetadata);
+        m_statsTraversalTime = traversalTimer.elapsed();
+        return;
     }
 
+    WalkDirectories walker(m_filtersDirectories, m_filtersFiles, m_excludedDirectories, m_subdirectories, m_minDepth,
+                           m_maxDepth, m_limitFilesToParse, m_filesToParseLimit, needMetadata, m_walkingThreads,
+                           m_cancel);
+
+    // The files are handed to the filters as soon as their directory is enumerated
+    // The journal watches each directory before it is enumerated
+    std::function<void(const QString &)> directoryVisited;
+    if (m_changeJournal)
+        directoryVisited = [this](const QString &directory) { m_changeJournal->watch(directory); };
+
+    walker.walk(m_directoriesToInclude, directoryVisited, [&pathsQueue](const QString &filePath, const FileStat &fileStat) {
+        FileScanResult scanResult;
+        scanResult.filePath = filePath;
+        scanResult.fileStat = fileStat;
+        return pathsQueue.push(std::move(scanResult));
+    });
+
+    m_statsProcessedDirectories = walker.processedDirectories();
+    m_statsProcessedFiles = walker.processedFiles();
+    m_statsTraversalTime = traversalTimer.elapsed();
+    m_statsWalkSyscalls = walker.syscalls();
 }
 
 
-void FindOccurrences::parseDirectory(const QString &dirPath, const int currentDepth, qint64 &filesParsedCount) {
-    
-    if (m_cancel)
-        return;
-    
-    
-    // If the limit is reached, return early
-    if (m_limitFilesToParse && filesParsedCount >= m_filesToParseLimit) {
-        qInfo() << "File limit reached. Stopping further parsing.";
-        return;
-    }
-    
-    if (currentDepth > m_maxDepth && m_maxDepth != -1)
-        return;
+void FindOccurrences::excludeSubdirectoriesWithParents() {
+    m_directoriesToInclude = PathTrie(m_directoriesToInclude).outermostPaths();
+}
+
+
+// *******************************************************************************************************************
+// ************************************************** Filter Files ***************************************************
+// *******************************************************************************************************************
+/**
+ * Compiles the hidden, size, dates & filenames options into the metadata filter, once for all the files.
+ */
+void FindOccurrences::compileMetadataFilter() {
+
+    if (m_ignoreHiddenFiles)
+        m_metadataFilter.addHidden();
+
+    if (m_filterBySize)
+        m_metadataFilter.addSize(m_sizeCondition, m_sizeSystem, m_size_1, m_size_2, m_sizeUnits_1, m_sizeUnits_2);
+
+    if (m_filterByCreationDate)
+        m_metadataFilter.addDate(MetadataFilter::Opcode::CreationDate, m_creationDateCondition, m_creationDate_1,
+                                 m_creationDate_2);
+
+    if (m_filterByLastModificationDate)
+        m_metadataFilter.addDate(MetadataFilter::Opcode::ModificationDate, m_lastModificationCondition,
+                                 m_lastModificationDate_1, m_lastModificationDate_2);
+
+    if (m_filterByLastAccessDate)
+        m_metadataFilter.addDate(MetadataFilter::Opcode::AccessDate, m_lastAccessDateCondition, m_lastAccessDate_1,
+                                 m_lastAccessDate_2);
+
+    if (!m_targetFilenames.isEmpty())
+        m_metadataFilter.addFilename([this](const QString &filename) { return matchFilenames(filename); });
+
+    m_metadataFilter.compile();
+}
+
+
+void FindOccurrences::filterFiles(BlockingQueue<FileScanResult> &pathsQueue, BlockingQueue<FileScanResult> &scanQueue) {
     
-    QFileInfo dirInfo(dirPath);
-    if (!dirInfo.isDir() || !dirInfo.isReadable()) {
-        qWarning() << "Directory is not readable or does not exist : " << dirPath;
-        return;
-    }
+    const QMimeDatabase mimeDatabase;
+    MetadataFilter::Counters filterCounters;
     
-    emit updateStatusBarMessage(dirPath);
-    
-    // Collect files in the current directory. If subdirectories are disabled, always collect files.
-    // If subdirectories are enabled, only collect files when currentDepth >= minDepth.
-    if (!m_subdirectories || currentDepth >= m_minDepth) {
-        // Collect files in the current directory.
-        QDirIterator it(dirPath, m_filtersFiles, QDirIterator::NoIteratorFlags);
-        while (it.hasNext() && (!m_limitFilesToParse || filesParsedCount < m_filesToParseLimit)) {
-            const QString filePath = it.next();
-            m_filesList << filePath;
-            ++filesParsedCount;
-        }
+    FileScanResult scanResult;
+    while (pathsQueue.pop(scanResult)) {
+        
+        if (!filterFile(mimeDatabase, scanResult, filterCounters))
+            continue;
         
-        m_statsProcessedDirectories++;
+        if (!scanQueue.push(std::move(scanResult)))
+            break;
     }
-    
-    
-    // Now parse subdirectories (recursively if needed)
-    if (m_subdirectories) {
-        QDirIterator subdirIt(dirPath, m_filtersDirectories, QDirIterator::NoIteratorFlags);
-        while (subdirIt.hasNext() && (!m_limitFilesToParse || filesParsedCount < m_filesToParseLimit)) {
-            QString subDirPath = subdirIt.next();
-            QString absoluteSubDirPath = QFileInfo(subDirPath).absoluteFilePath();
-            
-            // Check if the subdirectory is in the exclude list            
-            bool exclude = false;
-            for (auto it = m_directoriesToExclude.constBegin(); it != m_directoriesToExclude.constEnd(); ++it) {
-                const QString &excludeDir = *it;
-                if (absoluteSubDirPath.startsWith(excludeDir)) {
-                    exclude = true;
-                    break;
-                }
-            }
 
-            
-            if (!exclude) {
-                // Recurse into the subdirectory if not excluded
-                parseDirectory(absoluteSubDirPath, currentDepth + 1, filesParsedCount);
-                
-                // Check again if the limit is reached after recursion
-                if (m_limitFilesToParse && filesParsedCount >= m_filesToParseLimit) {
-                    qInfo() << "File limit reached after parsing subdirectories. Stopping further parsing.";
-                    return;
-                }
-            }
-        }
-    }
+    QMutexLocker locker(&m_statsFilterMutex);
+    m_statsFilterCounters += filterCounters;
 }
 
 
-void FindOccurrences::excludeSubdirectoriesWithParents() {
-    
-    QStringList sortedDirs = QStringList(m_directoriesToInclude.begin(), m_directoriesToInclude.end());
-    sortedDirs.sort();
-    
-    QSet<QString> cleanedSet;
-    for (const QString &dir : sortedDirs) {
-        if (std::none_of(cleanedSet.begin(), cleanedSet.end(),
-                         [&dir](const QString &parentDir) { return dir.startsWith(parentDir + '/'); })) {
-            cleanedSet.insert(dir);
-        }
+bool FindOccurrences::filterFile(const QMimeDatabase &mimeDatabase, FileScanResult &scanResult,
+                                 MetadataFilter::Counters &filterCounters) {
+
+    QFileInfo &fileInfo = scanResult.fileInfo;
+    fileInfo.setFile(scanResult.filePath);
+
+    // The metadata gathered by the walker, a single statx() per file
+    if (!m_metadataFilter.matches(fileInfo, scanResult.fileStat, filterCounters))
+        return false;
+
+
+    // Stat the file only if the walker couldn't provide the metadata
+    const bool needMetadata = m_avoidDuplicates || m_listDuplicatesOnly || !m_trigramIndexes.empty() || m_resultsCache;
+
+    if (needMetadata && !scanResult.fileStat.valid)
+        scanResult.fileStat = Stat_Utils::fromPath(scanResult.filePath);
+
+
+    // Most files are classified by their extension alone: the binary ones are dropped without being opened
+    scanResult.parseability = FileTypes_Utils::parseability(fileInfo.fileName());
+
+    if (m_ignoreUnparseableFiles && scanResult.parseability == FileTypes_Utils::Parseability::NotParseable)
+        return false;
+
+
+    // The MIME type is only needed here to filter, otherwise it is looked up for the accepted results only
+    if (m_filterByMimeTypes) {
+        const QMimeType qmimeType = m_mimeResolver.mimeTypeForFile(mimeDatabase, fileInfo);
+        if (!m_mimetypes.contains(qmimeType))
+            return false;
+
+        scanResult.mimeType = qmimeType.name();
     }
-    
-    m_directoriesToInclude = cleanedSet;
+
+    return true;
 }
 
 
 // *******************************************************************************************************************
-// ************************************************** Filter Files ***************************************************
+// ************************************************** Parsing Files **************************************************
 // *******************************************************************************************************************
-void FindOccurrences::filterFiles() {
-    
-    emit updateStatusBarOperation("Searching Occurrences : ");
+void FindOccurrences::scanFiles(BlockingQueue<FileScanResult> &scanQueue) {
     
+    // Each scanner owns its compiled copy of the search pattern
+    const TextMatcher textMatcher = m_textMatcher.compiledCopy();
     const QMimeDatabase mimeDatabase;
     
-    for (const QString &filePath : m_filesList) {
-        
-        if (m_cancel)
-            return;
-        
-        QFileInfo fileInfo(filePath);
-        
-        if (!matchFilenames(fileInfo.fileName()))
-            continue;
-        
-        if (m_ignoreHiddenFiles && fileInfo.isHidden())
-            continue;
-        
+    QVector<FileScanResult> batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    
+    FileScanResult scanResult;
+    while (scanQueue.pop(scanResult)) {
         
-        if (m_filterBySize)
-            if (!Size_Utils::matchesSizeConditions(fileInfo.size(),
-                                                   m_sizeSystem,
-                                                   m_sizeCondition,
-                                                   m_size_1,
-                                                   m_size_2,
-                                                   m_sizeUnits_1,
-                                                   m_sizeUnits_2))
-                continue;
+        if (m_listDuplicatesOnly) {
+            collectDuplicate(mimeDatabase, scanResult, batch);
+            
+        } else if (parsingFiles(textMatcher, scanResult) && acceptResult(scanResult)) {
+            if (scanResult.mimeType.isEmpty())
+                scanResult.mimeType = m_mimeResolver.mimeTypeForFile(mimeDatabase, scanResult.fileInfo).name();
 
-        if (m_filterByCreationDate)
-            if (!DateTime_Utils::matchesDateConditions(fileInfo.birthTime(),
-                                                       m_creationDateCondition,
-                                                       m_creationDate_1,
-                                                       m_creationDate_2))
-                continue;
+            // The metadata of the scanned file, a rescan only reads it again if it changed
+            if (!scanResult.fileStat.valid)
+                scanResult.fileStat = Stat_Utils::fromPath(scanResult.filePath);
 
-        if (m_filterByLastModificationDate)
-            if (!DateTime_Utils::matchesDateConditions(fileInfo.lastModified(),
-                                                       m_lastModificationCondition,
-                                                       m_lastModificationDate_1,
-                                                       m_lastModificationDate_2))
-                continue;
+            if (m_changeJournal) {
+                QMutexLocker locker(&m_snapshotMutex);
+                m_snapshotResults.append(scanResult);
+            }
 
-        if (m_filterByLastAccessDate)
-            if (!DateTime_Utils::matchesDateConditions(fileInfo.lastRead(),
-                                                       m_lastAccessDateCondition,
-                                                       m_lastAccessDate_1,
-                                                       m_lastAccessDate_2))
-                continue;
-        
-        
-        const QMimeType mimeType = mimeDatabase.mimeTypeForFile(fileInfo);
-        
-        if (m_filterByMimeTypes && !m_mimetypes.contains(mimeType))
-            continue;
-        
+            batch.append(std::move(scanResult));
+        }
         
-        parsingFiles(fileInfo, filePath, mimeType.name());
+        if (batch.size() >= RESULTS_BATCH_SIZE || (!batch.isEmpty() && batchTimer.elapsed() >= RESULTS_BATCH_INTERVAL)) {
+            sendResults(batch);
+            batchTimer.restart();
+        }
     }
     
-    // Clear the Set and free up the memory
-    QStringList().swap(m_filesList);
-    
+    if (!batch.isEmpty() && !m_cancel)
+        sendResults(batch);
 }
 
 
-// *******************************************************************************************************************
-// ************************************************** Parsing Files **************************************************
-// *******************************************************************************************************************
-void FindOccurrences::parsingFiles(const QFileInfo &fileInfo, const QString &filePath, const QString &mimeType) {
+bool FindOccurrences::parsingFiles(const TextMatcher &textMatcher, FileScanResult &scanResult) {
     
     if (m_cancel)
-        return;
+        return false;
     
+    // A file ruled out by its trigram index holds no match: nothing to read when the matches are wanted
+    const bool ruledOut = indexesRuleOut(scanResult);
+    if (ruledOut && m_matchText) {
+        m_statsIndexSkippedFiles++;
+        return false;
+    }
+
+    const QString &filePath = scanResult.filePath;
+
+    // The outcome of the same scan of the unchanged file, from a previous search
+    const bool cacheable = m_resultsCache && Database_Hashes::isCacheable(scanResult.fileStat);
+    const Database_Results::Key cacheKey = cacheable ? Database_Results::key(filePath, scanResult.fileStat)
+                                                     : Database_Results::Key();
+    if (cacheable)
+        if (const std::optional<Database_Results::Outcome> outcome = m_resultsCache->lookup(cacheKey))
+            return keepOutcome(*outcome, scanResult);
+
     QFile file(filePath);
     
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // Raw bytes: the engines handle the CRLF line breaks, and the content hash must be the one of the file
+    if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Cannot open file" << filePath << ": " << file.errorString();
-        return;
+        return false;
     }
     
     
-    // Skip unparseable files if needed
-    if (m_ignoreUnparseableFiles && !File_Utils::isTextFile(file)) {
+    // Skip unparseable files if needed, the content is only peeked at when the extension didn't tell
+    if (m_ignoreUnparseableFiles && scanResult.parseability != FileTypes_Utils::Parseability::Parseable
+        && !File_Utils::isTextFile(file)) {
         file.close();  // Close the file early if not parseable
-        return;
+
+        if (cacheable)
+            m_resultsCache->store(cacheKey, Database_Results::Outcome{Database_Results::UNPARSEABLE, {}, {}});
+
+        return false;
     }
-    
-    
-    // Check for duplicates and hash the file if required
-    if (m_avoidDuplicates) {
-        QString hashValue = ChecksumUtils::calculateMurmurHash3(file, ChecksumUtils::MurmurHash3Type::MURMUR_X64_128, false);
-        if (!m_filesHashes_Set.contains(hashValue)) {
-            m_filesHashes_Set.insert(hashValue);
-        } else {
-            file.close();  // Close the file early if it's a duplicate
-            return;
-        }
+
+    // ...and it is a result as is when the files without matches are wanted
+    if (ruledOut) {
+        m_statsIndexSkippedFiles++;
+        scanResult.occurrences = 0;
+        return true;
     }
     
+    
     emit updateStatusBarMessage(filePath);
 
 
+    QElapsedTimer scanTimer;
+    scanTimer.start();
+
+    // The file is hashed along the scan if it could be a duplicate (its size was seen), the duplicates being
+    // dropped once it has been read entirely
+    ScanDetails scanDetails;
+    scanDetails.hashContent = m_avoidDuplicates && m_duplicatesDetector.sizeSeen(file.size());
+
+    // Reading on after the first match is useless when the files without matches are listed, or when the
+    // occurrences are not wanted
+    const ScanMode scanMode = (!m_matchText || m_listMatchingFilesOnly) ? ScanMode::FirstMatch
+                                                                        : ScanMode::AllOccurrences;
 
     const QPair<int, QSet<int>> occurencesFound = RescanOccurrences::scan(file,
                                                                           m_fileReadingTimeout,
                                                                           m_timeoutFileReading,
                                                                           m_limitOccurrencesFound,
                                                                           m_occurrencesFoundLimit,
-                                                                          m_searchTextPattern,
-                                                                          m_cancel);
+                                                                          textMatcher,
+                                                                          m_cancel,
+                                                                          &scanDetails,
+                                                                          scanMode);
 
+    m_statsScanningTime += scanTimer.nsecsElapsed() / 1000;
+    m_statsScannedBytes += file.size();
+    m_statsPrefilteredBytes += scanDetails.prefilteredBytes;
 
 
     file.close();
 
-    // Add the result to the results QVector if any occurrences were found
-    bool shouldAppend = (m_matchText && occurencesFound.first > 0) || (!m_matchText && occurencesFound.first == 0);
+    const Database_Results::Outcome outcome{occurencesFound.first, occurencesFound.second, scanDetails.termsBreakdown};
+
+    // A canceled scan is incomplete
+    if (cacheable && !m_cancel)
+        m_resultsCache->store(cacheKey, outcome);
 
-    if (shouldAppend)
-        m_resultsModel->appendNew(fileInfo,
-                                  filePath,
-                                  mimeType,
-                                  m_sizeSystem,
-                                  occurencesFound.first,
-                                  occurencesFound.second,
-                                  m_searchTextPattern,
-                                  m_matchText);
+    if (scanDetails.hashContent)
+        scanResult.hash = scanDetails.contentHash;
 
+    return keepOutcome(outcome, scanResult);
+}
+
+
+/**
+ * Keeps the result if any occurrences were found (or none, when the files without matches are wanted).
+ */
+bool FindOccurrences::keepOutcome(const Database_Results::Outcome &outcome, FileScanResult &scanResult) {
+
+    const bool shouldAppend = (m_matchText && outcome.occurrences > 0) || (!m_matchText && outcome.occurrences == 0);
+
+    if (!shouldAppend)
+        return false;
+
+    scanResult.occurrences = outcome.occurrences;
+    scanResult.linesNumbers = outcome.linesNumbers;
+    scanResult.termsBreakdown = outcome.termsBreakdown;
+    return true;
+}
+
+
+/**
+ * Of the files sharing a content, keeps the one whose path sorts first whatever the order they are scanned in: a
+ * result already accepted is retracted when a duplicate sorting before it comes.
+ */
+bool FindOccurrences::acceptResult(const FileScanResult &scanResult) {
+
+    if (!m_avoidDuplicates)
+        return true;
+
+    const DuplicatesDetector::Verdict verdict = m_duplicatesDetector.insert(scanResult.filePath, scanResult.fileStat,
+                                                                            scanResult.hash, true);
+
+    if (!verdict.replacedPath.isEmpty()) {
+        QMutexLocker locker(&m_retractedMutex);
+        m_retractedPaths.insert(verdict.replacedPath);
+        emit resultRetracted(verdict.replacedPath);
+    }
+
+    return !verdict.duplicate;
+}
+
+
+/**
+ * Sends a batch of results, less those retracted meanwhile. The retractions are sent under the same lock, so a
+ * result is either left out here or sent before its retraction.
+ */
+void FindOccurrences::sendResults(QVector<FileScanResult> &batch) {
+
+    QMutexLocker locker(&m_retractedMutex);
+
+    if (!m_retractedPaths.isEmpty())
+        batch.removeIf([this](const FileScanResult &result) { return m_retractedPaths.contains(result.filePath); });
+
+    if (!batch.isEmpty())
+        emit resultsFound(batch);
+
+    batch.clear();
+}
+
+
+/**
+ * Lists the files having a duplicate: the original is sent along its first duplicate. Only the files sharing a
+ * size with another one are read.
+ */
+void FindOccurrences::collectDuplicate(const QMimeDatabase &mimeDatabase, FileScanResult &scanResult,
+                                       QVector<FileScanResult> &batch) {
+
+    if (m_cancel)
+        return;
+
+    const DuplicatesDetector::Verdict verdict = m_duplicatesDetector.insert(scanResult.filePath, scanResult.fileStat);
+
+    if (!verdict.duplicate)
+        return;
+
+    if (verdict.originalNewlyDuplicated) {
+        FileScanResult original;
+        original.filePath = verdict.originalPath;
+        original.fileInfo.setFile(verdict.originalPath);
+        original.mimeType = m_mimeResolver.mimeTypeForFile(mimeDatabase, original.fileInfo).name();
+        batch.append(std::move(original));
+    }
+
+    if (scanResult.mimeType.isEmpty())
+        scanResult.mimeType = m_mimeResolver.mimeTypeForFile(mimeDatabase, scanResult.fileInfo).name();
+
+    batch.append(std::move(scanResult));
 }
 
 
@@ -454,26 +950,41 @@ bool FindOccurrences::matchFilenames(const QString &filename) {
     if (m_targetFilenames.isEmpty())
         return true;
     
-    // Determine the target match outcome based on m_dontMatchfilenames
-    bool targetMatch = !m_dontMatchfilenames;
-    
-    // Check for exact filename match if required
-    if (m_findExactFilename && m_patternSyntax_Filenames == FilterWidget::FixedString)
-        return (filename.compare(m_targetFilenames, m_filenamesCaseSensitivity) == 0) == targetMatch;
-    
-    // Check patterns for match or non-match requirement
-    for (const QRegularExpression &filenamePattern : m_filenamesPatterns)
-        if (filenamePattern.match(filename).hasMatch())
-            return targetMatch;  // Found a match, return based on the target condition
-    
-    // No matches found, return based on the opposite of the target condition
-    return !targetMatch;
+    // A match is wanted, or none with m_dontMatchfilenames
+    return m_filenameMatcher.matches(filename) != m_dontMatchfilenames;
 }
 
 
 void FindOccurrences::setStatistics() {
     m_statisticsMap.insert("Processed Directories", m_statsProcessedDirectories);
     m_statisticsMap.insert("Processed Files", m_statsProcessedFiles);
+    m_statisticsMap.insert("Walking Threads", m_walkingThreads);
+    m_statisticsMap.insert("Filtering Threads", m_filteringThreads);
+    m_statisticsMap.insert("Scanning Threads", m_scanningThreads);
+    m_statisticsMap.insert("Traversal Time", m_statsTraversalTime);
+    m_statisticsMap.insert("Walk Syscalls", m_statsWalkSyscalls);
+    m_statisticsMap.insert("Scanned Bytes", m_statsScannedBytes);
+    m_statisticsMap.insert("Prefiltered Bytes", m_statsPrefilteredBytes);
+    m_statisticsMap.insert("Scanning Time", m_statsScanningTime);
+    m_statisticsMap.insert("Index Skipped Files", m_statsIndexSkippedFiles);
+    m_statisticsMap.insert("Reused Results", m_statsReusedResults);
+    m_statisticsMap.insert("Journal Changes", m_statsJournalChanges);
+    m_statisticsMap.insert("Results Cache Hits", m_statsResultsCacheHits);
+    m_statisticsMap.insert("Results Cache Misses", m_statsResultsCacheMisses);
+    m_statisticsMap.insert("MIME Lookups", m_mimeResolver.lookups());
+
+    for (int opcode = 0; opcode < MetadataFilter::OPCODES_COUNT; ++opcode) {
+        const QString name = MetadataFilter::name(static_cast<MetadataFilter::Opcode>(opcode));
+        m_statisticsMap.insert("Filter Tested " + name, m_statsFilterCounters.tested[opcode]);
+        m_statisticsMap.insert("Filter Rejected " + name, m_statsFilterCounters.rejected[opcode]);
+    }
+
+    m_statisticsMap.insert("Duplicate Files", m_duplicatesDetector.duplicates());
+    m_statisticsMap.insert("Hard Links", m_duplicatesDetector.hardLinks());
+    m_statisticsMap.insert("Duplicates Hashed Bytes", m_duplicatesDetector.hashedBytes());
+    m_statisticsMap.insert("Duplicates Hashing Time", m_duplicatesDetector.hashingTime());
+    m_statisticsMap.insert("Hashes Cache Hits", m_duplicatesDetector.cacheHits());
+    m_statisticsMap.insert("MIME Cache Hits", m_mimeResolver.cacheHits());
 }
 
 
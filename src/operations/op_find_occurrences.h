@@ -28,12 +28,54 @@
 
 #pragma once
 
-#include "models/results_model.h"
 #include "components/statusbarwidget.h"
 #include "components/filterwidget.h"
+#include "databases/database_results.h"
+#include "hash/duplicates_detector.h"
+#include "indexes/change_journal.h"
+#include "indexes/trigram_index.h"
+#include "matchers/filename_matcher.h"
+#include "matchers/metadata_filter.h"
+#include "matchers/text_matcher.h"
+#include "utils/blocking_queue.h"
+#include "utils/filetypes_utils.h"
+#include "utils/mime_resolver.h"
+#include "utils/stat_utils.h"
 
 #include <QFileInfo>
 #include <QMimeDatabase>
+#include <QMutex>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+/**
+ * A file going through the pipeline: the filters fill its info & MIME type, the scanners its occurrences,
+ * and it is finally sent to the GUI thread within a batch of results.
+ */
+struct FileScanResult {
+    FileStat fileStat;          // Metadata from the walker when a filter needs it, always filled for the results
+    QFileInfo fileInfo;
+    QString filePath;
+    QString mimeType;           // Looked up by the filters when filtering by MIME types, else for the results only
+    FileTypes_Utils::Parseability parseability = FileTypes_Utils::Parseability::Unknown;  // From the extension
+    int occurrences = 0;
+    QSet<int> linesNumbers;
+    std::optional<Hash128> hash;    // Content hash, computed along the scan when a file of the same size was seen
+    TermsBreakdown termsBreakdown;  // Occurrences per term, only filled by a multiple terms search
+};
+
+
+/**
+ * The results of the last complete search, the next identical one reusing those the change journal saw unchanged.
+ */
+struct SearchSnapshot {
+    std::optional<Hash128> fingerprint;     // Of the search options, none if the last search was incomplete
+    QVector<FileScanResult> results;
+};
 
 
 class FindOccurrences : public QObject {
@@ -42,13 +84,13 @@ class FindOccurrences : public QObject {
 
 public:
     FindOccurrences(QSet<QString> &directories, QSet<QString> &excludeDirs, QSet<QMimeType> &mimetypes,
-                    QStringList &filesList, ResultsModel *&resultsModel, QRegularExpression &searchTextPattern,
-                    QString &targetFilenames, QVector<QRegularExpression> &filenamesPatterns,
-                    FilterWidget::PatternSyntax patternSyntax_Filenames, Qt::CaseSensitivity filenamesCaseSensitivity,
+                    QRegularExpression &searchTextPattern, const TextMatcher &textMatcher,
+                    QString &targetFilenames, FilterWidget::PatternSyntax patternSyntax_Filenames,
+                    Qt::CaseSensitivity filenamesCaseSensitivity,
                     bool matchText, bool dontMatchfilenames, bool subdirectories, int minDepth, int maxDepth,
                     bool ignoreHiddenDirectories, bool ignoreHiddenFiles, bool ignoreSymbolicDirectoriesLinks,
                     bool ignoreSymbolicFilesLinks, bool findExactFilename, bool ignoreUnparseableFiles,
-                    bool avoidDuplicates, QSet<QString> &filesHashes_Set, QDir::Filters filtersDirectories,
+                    bool avoidDuplicates, bool listDuplicatesOnly, QDir::Filters filtersDirectories,
                     QDir::Filters filtersFiles, QString &sizeCondition, QString &sizeSystem, double size_1, double size_2,
                     QString &sizeUnits_1, QString &sizeUnits_2, QString &creationDateCondition, QDateTime &creationDate_1,
                     QDateTime &creationDate_2, QString &lastModificationCondition, QDateTime &lastModificationDate_1,
@@ -56,15 +98,32 @@ public:
                     QDateTime &lastAccessDate_2, bool filterBySize, bool filterByCreationDate,
                     bool filterByLastModificationDate, bool filterByLastAccessDate, bool filterByMimeTypes,
                     bool fileReadingTimeout, bool limitFilesToParse, bool limitOccurrencesFound,
-                    int timeoutFileReading, int filesToParseLimit, int occurrencesFoundLimit, QObject *parent);
+                    int timeoutFileReading, int filesToParseLimit, int occurrencesFoundLimit, int scanThreads,
+                    bool listMatchingFilesOnly, bool useTrigramIndex, ChangeJournal *changeJournal,
+                    SearchSnapshot *searchSnapshot, bool cacheResults, QObject *parent);
 
     void start();
     void cancel();
-    void parseDirectories();
-    void parseDirectory(const QString &dirPath, const int currentDepth, qint64 &filesParsedCount);
+    void prepareTrigramIndexes();
+    bool indexesRuleOut(const FileScanResult &scanResult) const;
+    Hash128 scanFingerprint() const;
+    Hash128 searchFingerprint() const;
+    void prepareRepeatedSearch();
+    void reuseSnapshot();
+    void walkChanges(BlockingQueue<FileScanResult> &pathsQueue, bool needMetadata);
+    bool isChanged(const QString &filePath) const;
+    void parseDirectories(BlockingQueue<FileScanResult> &pathsQueue);
     void excludeSubdirectoriesWithParents();
-    void filterFiles();
-    void parsingFiles(const QFileInfo &fileInfo, const QString &filePath, const QString &mimeType);
+    void compileMetadataFilter();
+    void filterFiles(BlockingQueue<FileScanResult> &pathsQueue, BlockingQueue<FileScanResult> &scanQueue);
+    bool filterFile(const QMimeDatabase &mimeDatabase, FileScanResult &scanResult,
+                    MetadataFilter::Counters &filterCounters);
+    void scanFiles(BlockingQueue<FileScanResult> &scanQueue);
+    bool parsingFiles(const TextMatcher &textMatcher, FileScanResult &scanResult);
+    bool keepOutcome(const Database_Results::Outcome &outcome, FileScanResult &scanResult);
+    bool acceptResult(const FileScanResult &scanResult);
+    void sendResults(QVector<FileScanResult> &batch);
+    void collectDuplicate(const QMimeDatabase &mimeDatabase, FileScanResult &scanResult, QVector<FileScanResult> &batch);
     bool matchFilenames(const QString &filename);
     void setStatistics();
 
@@ -75,22 +134,24 @@ signals:
     void finished(const QMap<QString, qint64> &statisticsMap);
     void failed(const QMap<QString, qint64> &statisticsMap);
     void canceled(const QMap<QString, qint64> &statisticsMap);
+    void resultsFound(const QVector<FileScanResult> &results);
+    void resultRetracted(const QString &filePath);
     void updateStatusBarOperation(const QString &operation);
     void updateStatusBarMessage(const QString &message);
 
 
 private:
-    bool m_cancel;
+    std::atomic<bool> m_cancel;             // Set by the GUI thread, read by all the stages
 
     QSet<QString> m_directoriesToInclude;
     QSet<QString> m_directoriesToExclude;
+    PathTrie m_excludedDirectories;         // The same, shared by the walkers
     QSet<QMimeType> m_mimetypes;
-    QStringList m_filesList;
-    ResultsModel *m_resultsModel;
+    MimeResolver m_mimeResolver;            // Shared by the filters & the scanners, each with its own database
 
     QRegularExpression m_searchTextPattern;
+    TextMatcher m_textMatcher;
     QString m_targetFilenames;
-    QVector<QRegularExpression> m_filenamesPatterns;
     FilterWidget::PatternSyntax m_patternSyntax_Filenames;
     Qt::CaseSensitivity m_filenamesCaseSensitivity;
     bool m_matchText;
@@ -104,10 +165,14 @@ private:
     bool m_ignoreSymbolicDirectoriesLinks = false;
     bool m_ignoreSymbolicFilesLinks = false;
     bool m_findExactFilename = false;
+    FilenameMatcher m_filenameMatcher;      // All the filenames patterns at once
     bool m_ignoreUnparseableFiles = true;
     bool m_avoidDuplicates = false;
+    bool m_listDuplicatesOnly = false;      // No text search: the files having a duplicate are the results
 
-    QSet<QString> m_filesHashes_Set;
+    DuplicatesDetector m_duplicatesDetector;
+    QMutex m_retractedMutex;                // Orders the retractions & the batches sent
+    QSet<QString> m_retractedPaths;         // The results replaced by a duplicate whose path sorts first
     QDir::Filters m_filtersDirectories = QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable;
     QDir::Filters m_filtersFiles = QDir::Files | QDir::NoDotAndDotDot | QDir::Readable;
 
@@ -132,6 +197,7 @@ private:
     bool m_filterByLastModificationDate = false;
     bool m_filterByLastAccessDate = false;
     bool m_filterByMimeTypes = false;
+    MetadataFilter m_metadataFilter;        // The hidden, size, dates & filenames filters, compiled before the walk
 
     bool m_fileReadingTimeout = false;
     bool m_limitFilesToParse = false;
@@ -139,9 +205,39 @@ private:
     int m_timeoutFileReading = 0;
     int m_filesToParseLimit = 0;
     int m_occurrencesFoundLimit = 0;
+    int m_scanThreads = 1;                  // The threads budget, shared by the stages of the search
+    int m_walkingThreads = 1;               // The share of each stage, set when the search starts
+    int m_filteringThreads = 1;
+    int m_scanningThreads = 1;
+    bool m_listMatchingFilesOnly = false;   // Stop at the first match, the occurrences are not counted
+    bool m_useTrigramIndex = false;         // Skip the files the trigram index of their directory rules out
+    std::vector<std::unique_ptr<TrigramIndex>> m_trigramIndexes;    // Opened & queried before the walk
+
+    ChangeJournal *m_changeJournal = nullptr;       // Owned by the main window, watches across the searches
+    SearchSnapshot *m_searchSnapshot = nullptr;     // Idem, the results of the last search
+    Hash128 m_fingerprint;
+    bool m_repeatedSearch = false;                  // Only the changes recorded by the journal are walked
+    ChangeJournal::Changes m_journalChanges;
+    QMutex m_snapshotMutex;
+    QVector<FileScanResult> m_snapshotResults;      // The results of this search, for the next one
+
+    bool m_cacheResults = false;
+    Database_Results *m_resultsCache = nullptr;     // Alive during the search only
 
     qint64 m_statsProcessedDirectories = 0;
     qint64 m_statsProcessedFiles = 0;
+    qint64 m_statsTraversalTime = 0;
+    qint64 m_statsWalkSyscalls = 0;
+    std::atomic<qint64> m_statsScannedBytes = 0;
+    std::atomic<qint64> m_statsPrefilteredBytes = 0;  // Never decoded thanks to the regex prefilter
+    std::atomic<qint64> m_statsScanningTime = 0;     // Cumulated over the scanners, in microseconds
+    std::atomic<qint64> m_statsIndexSkippedFiles = 0;  // Never opened, ruled out by a trigram index
+    qint64 m_statsReusedResults = 0;
+    qint64 m_statsJournalChanges = 0;
+    qint64 m_statsResultsCacheHits = 0;
+    qint64 m_statsResultsCacheMisses = 0;
+    QMutex m_statsFilterMutex;
+    MetadataFilter::Counters m_statsFilterCounters;     // Summed over the filter threads
     QMap<QString, qint64> m_statisticsMap;
 
 };
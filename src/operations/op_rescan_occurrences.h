@@ -28,23 +28,645 @@
 
 #pragma once
 
+#include "hash/checksum_utils.h"
+#include "matchers/text_matcher.h"
+
+#include <QBuffer>
 #include <QPair>
 #include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QFile>
+#include <QStringDecoder>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+
+/**
+ * How far a scan goes: through the whole file, or up to its first match when only the existence of a match matters
+ * (like grep -l & grep -L).
+ */
+enum class ScanMode {
+    AllOccurrences,
+    FirstMatch
+};
+
+
+/**
+ * What a scan reports besides the occurrences, and what it must compute along.
+ */
+struct ScanDetails {
+    bool hashContent = false;           // Hash the whole content from the buffers being scanned
+    Hash128 contentHash;                // ChecksumUtils::calculateContentHash() of the content, when requested
+    TermsBreakdown termsBreakdown;      // Occurrences & lines of each term, multiple terms only
+    qint64 prefilteredBytes = 0;        // Bytes rejected by the regex prefilter, never decoded nor matched
+};
 
 
 class RescanOccurrences {
 
 public:
 
+    /**
+     * Counts the occurrences of a pattern in a file (from its current position) and the lines holding them.
+     * Small files are read at once into a reusable buffer and bigger ones are mapped in memory, then matched chunk by
+     * chunk (on the UTF-8 bytes with PCRE2 when available, decoded otherwise); the QTextStream engine remains for the
+     * files that can't be mapped (e.g. pseudo-files).
+     * @return - The number of occurrences and the (1-based) numbers of the lines holding them.
+     */
+    static QPair<int, QSet<int>> scan(QFile &file, const bool &fileReadingTimeout, const int &timeoutFileReading,
+                                      const bool &limitOccurrencesFound, const int &occurrencesFoundLimit,
+                                      const QRegularExpression &searchTextPattern, const std::atomic<bool> &cancel) {
+
+        return scan(file, fileReadingTimeout, timeoutFileReading, limitOccurrencesFound, occurrencesFoundLimit,
+                    TextMatcher(searchTextPattern), cancel);
+    }
+
+
+    /**
+     * Same as above, fixed strings & multiple terms being searched directly on the UTF-8 bytes when the matcher
+     * allows it.
+     * @param details - If not null, receives the occurrences of each term and the prefiltering statistics, and the
+     *                  content hash if requested: the file is then read once for both, up to its end whatever the
+     *                  scan mode & limits.
+     * @param scanMode - ScanMode::FirstMatch stops reading at the first match, reporting it alone.
+     */
     static QPair<int, QSet<int>> scan(QFile &file, const bool &fileReadingTimeout, const int &timeoutFileReading,
                                       const bool &limitOccurrencesFound, const int &occurrencesFoundLimit,
-                                      const QRegularExpression &searchTextPattern, const bool &cancel) {
+                                      const TextMatcher &textMatcher, const std::atomic<bool> &cancel,
+                                      ScanDetails *details = nullptr,
+                                      const ScanMode scanMode = ScanMode::AllOccurrences) {
+
+        ScanLimits limits{fileReadingTimeout, timeoutFileReading, limitOccurrencesFound, occurrencesFoundLimit, false};
+
+        // The first match is an occurrences limit of 1 that is expected, hence not reported
+        if (scanMode == ScanMode::FirstMatch)
+            limits = ScanLimits{fileReadingTimeout, timeoutFileReading, true, 1, true};
+
+        ScanDetails ignoredDetails;
+        if (!details)
+            details = &ignoredDetails;
+
+        ScanState state;
+        state.hashContent = details->hashContent;
+
+        if (textMatcher.isMultipleTerms()) {
+            const AhoCorasickMatcher &terms = textMatcher.terms();
+            state.termsOccurrences.fill(0, terms.termsCount());
+            state.termsLines.resize(terms.termsCount());
+
+            // The automaton needs the bytes: the files that can't be mapped (e.g. pseudo-files) are read at once
+            if (!scanBuffer(file, limits, textMatcher, cancel, state)) {
+                QElapsedTimer timer;
+                if (fileReadingTimeout)
+                    timer.start();
+
+                const QByteArray content = file.readAll();
+                if (state.hashContent)
+                    state.contentHash = ChecksumUtils::calculateContentHash(content);
+
+                scanTerms(content, terms, limits, timer, cancel, state);
+            }
+
+            details->contentHash = state.contentHash;
+
+            details->termsBreakdown.clear();
+            for (int termIndex = 0; termIndex < terms.termsCount(); ++termIndex)
+                if (state.termsOccurrences.at(termIndex) > 0)
+                    details->termsBreakdown.insert(QString::fromUtf8(terms.term(termIndex)),
+                                                   {state.termsOccurrences.at(termIndex), state.termsLines.at(termIndex)});
+
+            return QPair<int, QSet<int>>(state.occurrences, state.linesNumbers);
+        }
+
+        if (scanBuffer(file, limits, textMatcher, cancel, state)) {
+            details->contentHash = state.contentHash;
+            details->prefilteredBytes = state.prefilteredBytes;
+            return QPair<int, QSet<int>>(state.occurrences, state.linesNumbers);
+        }
+
+        if (!details->hashContent)
+            return scanStream(file, file.fileName(), limits, textMatcher.pattern(), cancel);
+
+        // The stream can't be read twice: its content is hashed, then scanned from memory
+        QByteArray content = file.readAll();
+        details->contentHash = ChecksumUtils::calculateContentHash(content);
+
+        QBuffer buffer(&content);
+        buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+        return scanStream(buffer, file.fileName(), limits, textMatcher.pattern(), cancel);
+    }
+
+
+
+private:
+    static constexpr qint64 SMALL_FILE_SIZE = 64 * 1024;        // Read at once below, mapped above
+    static constexpr qsizetype CHUNK_SIZE = 4 * 1024 * 1024;    // Bytes decoded at once (extended to a line end)
+    static constexpr qsizetype PREFILTER_GAP = 4 * 1024;        // Prefiltered lines closer than this are decoded together
+
+
+    struct ScanLimits {
+        bool fileReadingTimeout;
+        int timeoutFileReading;
+        bool limitOccurrencesFound;
+        int occurrencesFoundLimit;
+        bool firstMatch;                    // The limit is the first match (ScanMode::FirstMatch)
+
+        bool reached(const int &occurrences) const {
+            return limitOccurrencesFound && occurrences >= occurrencesFoundLimit;
+        }
+
+        void warnLimitReached(const QString &fileName = QString()) const {
+            if (!firstMatch)
+                qWarning() << "Occurrences limit reached" << qPrintable(fileName);
+        }
+    };
+
+    struct ScanState {
+        int occurrences = 0;
+        QSet<int> linesNumbers;
+        bool stopped = false;
+        QVector<int> termsOccurrences;      // Per term, multiple terms only
+        QVector<QSet<int>> termsLines;
+        qint64 prefilteredBytes = 0;
+        bool hashContent = false;
+        Hash128 contentHash;
+    };
+
+
+    /**
+     * The search pattern prepared for the whole-chunk matching, cached per thread since the same pattern is used
+     * for every file of a search.
+     */
+    struct PreparedPattern {
+        QString pattern;
+        QRegularExpression::PatternOptions options;
+        bool wholeChunk = false;            // False if the pattern must run line by line (see preparePattern)
+        QRegularExpression multilinePattern;
+    };
+
+
+    static const PreparedPattern &preparePattern(const QRegularExpression &searchTextPattern) {
+
+        thread_local PreparedPattern prepared;
+        thread_local bool initialized = false;
+
+        if (initialized && prepared.pattern == searchTextPattern.pattern()
+            && prepared.options == searchTextPattern.patternOptions())
+            return prepared;
+
+        prepared.pattern = searchTextPattern.pattern();
+        prepared.options = searchTextPattern.patternOptions();
+        prepared.wholeChunk = TextMatcher::canMatchWholeChunks(searchTextPattern);
+
+        if (prepared.wholeChunk) {
+            // ^ and $ apply to every line, whatever the line breaks (LF or CRLF)
+            prepared.multilinePattern = QRegularExpression("(*ANYCRLF)" + prepared.pattern,
+                                                           prepared.options | QRegularExpression::MultilineOption);
+            prepared.multilinePattern.optimize();
+            prepared.wholeChunk = prepared.multilinePattern.isValid();
+        }
+
+        initialized = true;
+        return prepared;
+    }
+
+
+    // *******************************************************************************************************************
+    // ************************************************** Buffer Engine **************************************************
+    // *******************************************************************************************************************
+    static bool scanBuffer(QFile &file, const ScanLimits &limits, const TextMatcher &textMatcher,
+                           const std::atomic<bool> &cancel, ScanState &state) {
+
+        const qint64 offset = file.pos();
+        const qint64 length = file.size() - offset;
+
+        // Pseudo-files report a zero size, they are read through the stream
+        if (file.size() <= 0 || length < 0)
+            return false;
+
+        QElapsedTimer timer;
+        if (limits.fileReadingTimeout)
+            timer.start();
+
+
+        // --------------------------
+        // Small files are read at once into a per-thread buffer, bigger ones are mapped
+        // --------------------------
+        thread_local QByteArray readBuffer;
+        uchar *mappedData = nullptr;
+        QByteArrayView bytes;
+
+        if (length <= SMALL_FILE_SIZE) {
+            readBuffer.resize(length);
+
+            const qint64 bytesRead = file.read(readBuffer.data(), length);
+            if (bytesRead < 0)
+                return false;
+
+            bytes = QByteArrayView(readBuffer.constData(), bytesRead);
+
+        } else {
+            mappedData = file.map(offset, length);
+            if (!mappedData)
+                return false;
+
+            bytes = QByteArrayView(mappedData, length);
+        }
+
+        // The whole content is hashed from the same buffer, whether the scan goes to the end or not
+        if (state.hashContent)
+            state.contentHash = ChecksumUtils::calculateContentHash(bytes);
+
+
+        // --------------------------
+        // Decode chunk by chunk (UTF-8 chunks end on a line break), the BOM selects the encoding like QTextStream
+        // --------------------------
+        if (textMatcher.isMultipleTerms()) {
+            scanTerms(bytes, textMatcher.terms(), limits, timer, cancel, state);
+
+            if (mappedData)
+                file.unmap(mappedData);
+
+            return true;
+        }
+
+        const std::optional<QStringConverter::Encoding> encoding = QStringConverter::encodingForData(bytes);
+        const bool isUtf8 = !encoding || *encoding == QStringConverter::Utf8;
+
+        if (isUtf8 && bytes.startsWith("\xEF\xBB\xBF"))
+            bytes = bytes.sliced(3);
+
+        // Fixed strings are searched on the raw bytes, nothing is decoded
+        if (isUtf8 && textMatcher.isLiteral()) {
+            scanBytes(bytes, textMatcher.literal(), limits, timer, cancel, state);
+
+            if (mappedData)
+                file.unmap(mappedData);
+
+            return true;
+        }
+
+        // Regexes requiring a literal: only the lines holding it are decoded & matched
+        if (isUtf8 && textMatcher.hasPrefilter()) {
+            scanPrefiltered(bytes, textMatcher, limits, timer, cancel, state);
+
+            if (mappedData)
+                file.unmap(mappedData);
+
+            return true;
+        }
+
+        QStringDecoder decoder(encoding.value_or(QStringConverter::Utf8));
+
+        const QRegularExpression &searchTextPattern = textMatcher.pattern();
+        const PreparedPattern &prepared = preparePattern(searchTextPattern);
+
+        int firstLineNumber = 1;
+        qsizetype chunkStart = 0;
+
+        while (chunkStart < bytes.size() && !state.stopped) {
+
+            if (cancel)
+                break;
+
+            if (limits.fileReadingTimeout && timer.elapsed() > limits.timeoutFileReading * 1000) {
+                qWarning() << "File reading timeout reached for" << file.fileName();
+                break;
+            }
+
+            qsizetype chunkEnd = bytes.size();
+
+            if (isUtf8 && chunkEnd - chunkStart > CHUNK_SIZE) {
+                const qsizetype lineBreak = bytes.indexOf('\n', chunkStart + CHUNK_SIZE);
+                if (lineBreak >= 0)
+                    chunkEnd = lineBreak + 1;
+            }
+
+            const QByteArrayView chunk = bytes.sliced(chunkStart, chunkEnd - chunkStart);
+
+            // UTF-8 runs straight through PCRE2 when available, the decoding engine remains the fallback
+            if (isUtf8 && scanUtf8(chunk, firstLineNumber, textMatcher, limits, state)) {
+                firstLineNumber += static_cast<int>(std::count(chunk.begin(), chunk.end(), '\n'));
+            } else {
+                const QString text = decoder.decode(chunk);
+                scanText(text, firstLineNumber, searchTextPattern, prepared, limits, timer, cancel, state);
+                firstLineNumber += static_cast<int>(text.count(QLatin1Char('\n')));
+            }
+
+            chunkStart = chunkEnd;
+        }
+
+        if (mappedData)
+            file.unmap(mappedData);
+
+        return true;
+    }
+
+
+    /**
+     * Scans the UTF-8 bytes of a regex search through its prefilter: the spans of lines holding the required literal
+     * are decoded & matched, the rest is skipped (a file without the literal is never decoded). Since the occurrences
+     * are counted within a line, the lines without the literal can't hold any.
+     */
+    static void scanPrefiltered(const QByteArrayView &bytes, const TextMatcher &textMatcher, const ScanLimits &limits,
+                                const QElapsedTimer &timer, const std::atomic<bool> &cancel, ScanState &state) {
+
+        const LiteralMatcher &prefilter = textMatcher.prefilter();
+        const QRegularExpression &searchTextPattern = textMatcher.pattern();
+        const PreparedPattern &prepared = preparePattern(searchTextPattern);
+
+        const char *data = bytes.data();
+        const qsizetype size = bytes.size();
+
+        auto lineEnd = [&bytes, &size](const qsizetype position) {
+            const qsizetype lineBreak = bytes.indexOf('\n', position);
+            return lineBreak < 0 ? size : lineBreak + 1;
+        };
+
+        QStringDecoder decoder(QStringConverter::Utf8);
+
+        int lineNumber = 1;
+        qsizetype countedUpTo = 0;
+        qsizetype scannedUpTo = 0;
+        qsizetype candidate = prefilter.indexIn(data, size, 0);
+
+        while (candidate >= 0 && !state.stopped) {
+
+            if (cancel)
+                return;
+
+            if (limits.fileReadingTimeout && timer.elapsed() > limits.timeoutFileReading * 1000) {
+                qWarning() << "File reading timeout reached";
+                return;
+            }
+
+            // --------------------------
+            // The span starts at the line of the candidate and takes in the lines of the close candidates
+            // --------------------------
+            const qsizetype spanStart = bytes.lastIndexOf('\n', candidate) + 1;
+            qsizetype spanEnd = lineEnd(candidate);
+            candidate = spanEnd < size ? prefilter.indexIn(data, size, spanEnd) : -1;
+
+            while (candidate >= 0 && candidate - spanEnd <= PREFILTER_GAP && spanEnd - spanStart < CHUNK_SIZE) {
+                spanEnd = lineEnd(candidate);
+                candidate = spanEnd < size ? prefilter.indexIn(data, size, spanEnd) : -1;
+            }
+
+            lineNumber += static_cast<int>(std::count(data + countedUpTo, data + spanStart, '\n'));
+            countedUpTo = spanStart;
+
+            state.prefilteredBytes += spanStart - scannedUpTo;
+            scannedUpTo = spanEnd;
+
+            const QByteArrayView span = bytes.sliced(spanStart, spanEnd - spanStart);
+
+            if (!scanUtf8(span, lineNumber, textMatcher, limits, state)) {
+                const QString text = decoder.decode(span);
+                scanText(text, lineNumber, searchTextPattern, prepared, limits, timer, cancel, state);
+            }
+        }
+
+        if (!state.stopped)
+            state.prefilteredBytes += size - scannedUpTo;
+    }
+
+
+    /**
+     * Runs the regex directly on UTF-8 text made of whole lines, through PCRE2.
+     * @return - false (and nothing counted) if PCRE2 is not available or failed, the text must then be decoded.
+     */
+    static bool scanUtf8(const QByteArrayView &text, const int &firstLineNumber, const TextMatcher &textMatcher,
+                         const ScanLimits &limits, ScanState &state) {
+
+        if (!textMatcher.hasUtf8Regex())
+            return false;
+
+        const qsizetype maxMatches = limits.limitOccurrencesFound
+                                         ? std::max(0, limits.occurrencesFoundLimit - state.occurrences)
+                                         : std::numeric_limits<qsizetype>::max();
+
+        thread_local QVector<int> matchesLines;
+
+        if (!textMatcher.utf8Regex().scan(text.data(), text.size(), firstLineNumber, maxMatches, matchesLines))
+            return false;
+
+        for (const int &matchLine : std::as_const(matchesLines))
+            state.linesNumbers.insert(matchLine);
+
+        state.occurrences += static_cast<int>(matchesLines.size());
+
+        if (limits.reached(state.occurrences)) {
+            state.stopped = true;
+            limits.warnLimitReached();
+        }
+
+        return true;
+    }
+
+
+    /**
+     * Runs the pattern over decoded text, on the whole text when possible, line by line otherwise.
+     */
+    static void scanText(const QString &text, const int &firstLineNumber, const QRegularExpression &searchTextPattern,
+                         const PreparedPattern &prepared, const ScanLimits &limits, const QElapsedTimer &timer,
+                         const std::atomic<bool> &cancel, ScanState &state) {
+
+        if (!prepared.wholeChunk || !scanChunk(text, firstLineNumber, prepared.multilinePattern, limits, state))
+            scanChunkByLines(text, firstLineNumber, searchTextPattern, limits, timer, cancel, state);
+    }
+
+
+    /**
+     * Runs the literal matcher over the bytes, the line numbers being computed from the line breaks preceding each
+     * match only.
+     */
+    static void scanBytes(const QByteArrayView &bytes, const LiteralMatcher &literal, const ScanLimits &limits,
+                          const QElapsedTimer &timer, const std::atomic<bool> &cancel, ScanState &state) {
+
+        const char *data = bytes.data();
+        const qsizetype size = bytes.size();
+
+        int lineNumber = 1;
+        qsizetype countedUpTo = 0;
+        qsizetype position = literal.indexIn(data, size, 0);
+
+        while (position >= 0) {
+
+            // Check for the cancellation & timeout every 256 matches
+            if ((state.occurrences & 0xFF) == 0xFF
+                && (cancel || (limits.fileReadingTimeout && timer.elapsed() > limits.timeoutFileReading * 1000)))
+                break;
+
+            lineNumber += static_cast<int>(std::count(data + countedUpTo, data + position, '\n'));
+            countedUpTo = position;
+
+            state.linesNumbers.insert(lineNumber);
+            state.occurrences++;
+
+            if (limits.reached(state.occurrences)) {
+                limits.warnLimitReached();
+                state.stopped = true;
+                break;
+            }
+
+            position = literal.indexIn(data, size, position + literal.size());
+        }
+    }
+
+
+    /**
+     * Runs the Aho-Corasick automaton over the bytes in a single pass. Each occurrence of each term is counted,
+     * the overlapping ones included; the contents not encoded in UTF-8 (per their BOM) are converted first.
+     */
+    static void scanTerms(QByteArrayView bytes, const AhoCorasickMatcher &terms, const ScanLimits &limits,
+                          const QElapsedTimer &timer, const std::atomic<bool> &cancel, ScanState &state) {
+
+        const std::optional<QStringConverter::Encoding> encoding = QStringConverter::encodingForData(bytes);
+
+        QByteArray converted;
+        if (encoding && *encoding != QStringConverter::Utf8) {
+            QStringDecoder decoder(*encoding);
+            converted = QString(decoder.decode(bytes)).toUtf8();
+            bytes = converted;
+        } else if (bytes.startsWith("\xEF\xBB\xBF")) {
+            bytes = bytes.sliced(3);
+        }
+
+        terms.scan(bytes.data(), bytes.size(), [&](const int termIndex, const int lineNumber) {
+
+            // Check for the cancellation & timeout every 256 matches
+            if ((state.occurrences & 0xFF) == 0xFF
+                && (cancel || (limits.fileReadingTimeout && timer.elapsed() > limits.timeoutFileReading * 1000)))
+                return false;
+
+            state.linesNumbers.insert(lineNumber);
+            state.occurrences++;
+            state.termsLines[termIndex].insert(lineNumber);
+            state.termsOccurrences[termIndex]++;
+
+            if (limits.reached(state.occurrences)) {
+                limits.warnLimitReached();
+                state.stopped = true;
+                return false;
+            }
+
+            return true;
+        });
+    }
+
+
+    /**
+     * Runs the pattern over a whole chunk, the line numbers being computed from the line breaks preceding each
+     * match only.
+     * @return - false (and nothing counted) if a match spans several lines, the chunk must then be scanned
+     *           line by line.
+     */
+    static bool scanChunk(const QString &text, const int &firstLineNumber, const QRegularExpression &multilinePattern,
+                          const ScanLimits &limits, ScanState &state) {
+
+        QVector<int> matchesLines;
+        int lineNumber = firstLineNumber;
+        qsizetype countedUpTo = 0;
+
+        QRegularExpressionMatchIterator matchIterator = multilinePattern.globalMatch(text);
+
+        while (matchIterator.hasNext()) {
+            const QRegularExpressionMatch match = matchIterator.next();
+            const qsizetype start = match.capturedStart();
+            const qsizetype end = match.capturedEnd();
+
+            const auto matchBegin = text.cbegin() + start;
+            const auto matchEnd = text.cbegin() + end;
+            if (std::any_of(matchBegin, matchEnd, [](const QChar &c) { return c == u'\n' || c == u'\r'; }))
+                return false;
+
+            lineNumber += static_cast<int>(std::count(text.cbegin() + countedUpTo, matchBegin, QLatin1Char('\n')));
+            countedUpTo = start;
+
+            matchesLines.append(lineNumber);
+
+            if (limits.reached(state.occurrences + static_cast<int>(matchesLines.size())))
+                break;
+        }
+
+        for (const int &matchLine : std::as_const(matchesLines))
+            state.linesNumbers.insert(matchLine);
+
+        state.occurrences += static_cast<int>(matchesLines.size());
+
+        if (limits.reached(state.occurrences)) {
+            state.stopped = true;
+            limits.warnLimitReached();
+        }
+
+        return true;
+    }
+
+
+    /**
+     * Runs the pattern on every line of a chunk, through views on the decoded text (no allocation per line).
+     */
+    static void scanChunkByLines(const QString &text, const int &firstLineNumber,
+                                 const QRegularExpression &searchTextPattern, const ScanLimits &limits,
+                                 const QElapsedTimer &timer, const std::atomic<bool> &cancel, ScanState &state) {
+
+        int lineNumber = firstLineNumber;
+        int linesProcessed = 0;   // Counter for processed lines, the timeout is checked every 100 lines
+        qsizetype lineStart = 0;
+
+        while (lineStart < text.size()) {
+
+            if (linesProcessed >= 100) {
+                if (cancel || (limits.fileReadingTimeout && timer.elapsed() > limits.timeoutFileReading * 1000)) {
+                    state.stopped = true;
+                    return;
+                }
+
+                linesProcessed = 0;
+            }
+
+            qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+            if (lineEnd < 0)
+                lineEnd = text.size();
+
+            QStringView line = QStringView(text).sliced(lineStart, lineEnd - lineStart);
+            if (line.endsWith(u'\r'))
+                line.chop(1);
+
+            QRegularExpressionMatchIterator matchIterator = searchTextPattern.globalMatchView(line);
+
+            while (matchIterator.hasNext()) {
+                matchIterator.next();
+                state.linesNumbers.insert(lineNumber);
+                state.occurrences++;
+
+                if (limits.reached(state.occurrences)) {
+                    limits.warnLimitReached();
+                    state.stopped = true;
+                    return;
+                }
+            }
+
+            linesProcessed++;
+            lineNumber++;
+            lineStart = lineEnd + 1;
+        }
+    }
+
+
+    // *******************************************************************************************************************
+    // ************************************************** Stream Engine **************************************************
+    // *******************************************************************************************************************
+    static QPair<int, QSet<int>> scanStream(QIODevice &device, const QString &fileName, const ScanLimits &limits,
+                                            const QRegularExpression &searchTextPattern,
+                                            const std::atomic<bool> &cancel) {
 
         // Initialize the elapsed timer if timeout is enabled
         QElapsedTimer timer;
-        if (fileReadingTimeout)
+        if (limits.fileReadingTimeout)
             timer.start();
 
 
@@ -55,7 +677,7 @@ public:
         int linesProcessed = 0;   // Counter for processed lines
 
 
-        QTextStream in(&file);
+        QTextStream in(&device);
 
         // Read the file line by line
         while (!in.atEnd()) {
@@ -63,12 +685,12 @@ public:
             lineNumber++;
 
             // Check for timeout every 'checkInterval' lines if enabled
-            if (fileReadingTimeout && linesProcessed >= checkInterval) {
+            if (limits.fileReadingTimeout && linesProcessed >= checkInterval) {
                 if (cancel)
                     return QPair<int, QSet<int>>(occurrences, linesNumbers);
 
-                if (timer.elapsed() > timeoutFileReading * 1000) {
-                    qWarning() << "File reading timeout reached for" << file.fileName();
+                if (timer.elapsed() > limits.timeoutFileReading * 1000) {
+                    qWarning() << "File reading timeout reached for" << fileName;
                     break;
                 }
 
@@ -87,8 +709,8 @@ public:
                 occurrences++;
 
                 // If occurrence limit is enabled and reached, stop searching
-                if (limitOccurrencesFound && occurrences >= occurrencesFoundLimit) {
-                    qWarning() << "Occurrences limit reached for" << file.fileName();
+                if (limits.reached(occurrences)) {
+                    limits.warnLimitReached(fileName);
                     break;
                 }
             }
@@ -96,7 +718,7 @@ public:
             linesProcessed++;
 
             // Break out of the outer loop if the limit has been reached
-            if (limitOccurrencesFound && occurrences >= occurrencesFoundLimit)
+            if (limits.reached(occurrences))
                 break;
 
         }
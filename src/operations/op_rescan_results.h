@@ -0,0 +1,245 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "constants/constants.h"
+#include "operations/op_rescan_occurrences.h"
+#include "utils/stat_utils.h"
+
+#include <QMimeDatabase>
+#include <QObject>
+#include <QThread>
+#include <QThreadPool>
+
+#include <atomic>
+
+
+/**
+ * A row of the results to rescan, the worker only knows its file: the rows stay in the GUI thread.
+ */
+struct RescanJob {
+    QString filePath;
+    FileStat scannedStat;       // The metadata of the file when it was scanned, invalid for the imported rows
+};
+
+
+/**
+ * What the rescan of a row found, applied to the model by the GUI thread.
+ */
+struct RescanUpdate {
+    enum class Kind {
+        Removed,        // The file is gone, unreadable or no longer a result
+        Refreshed,      // Unchanged since it was scanned, only its metadata is refreshed
+        Rescanned       // Read again, still a result
+    };
+
+    int job = 0;                // Index of the job in the list given to the worker
+    Kind kind = Kind::Removed;
+    FileStat fileStat;
+    int occurrences = 0;
+    QSet<int> linesNumbers;
+    QString mimeType;
+};
+
+
+class RescanResults : public QObject {
+    Q_OBJECT
+
+
+public:
+    /**
+     * @param jobs - The rows to rescan.
+     * @param searchTextPattern - The pattern the rows were found with.
+     * @param matchText - true if the results hold the pattern, false if they don't.
+     * @param threads - The number of files rescanned at once, the ideal thread count if 0 ("Auto").
+     */
+    RescanResults(const QVector<RescanJob> &jobs, const QRegularExpression &searchTextPattern,
+                  bool fileReadingTimeout, int timeoutFileReading, bool limitOccurrencesFound,
+                  int occurrencesFoundLimit, bool matchText, int threads, QObject *parent = nullptr)
+        : QObject(parent),
+          m_jobs(jobs),
+          m_textMatcher(searchTextPattern),
+          m_fileReadingTimeout(fileReadingTimeout),
+          m_timeoutFileReading(timeoutFileReading),
+          m_limitOccurrencesFound(limitOccurrencesFound),
+          m_occurrencesFoundLimit(occurrencesFoundLimit),
+          m_matchText(matchText),
+          m_threads(threads > 0 ? threads : std::max(1, QThread::idealThreadCount())) {
+    }
+
+
+    /**
+     * Rescans all the jobs on a pool of threads, each one taking the next job & sending its updates by batches.
+     */
+    void start() {
+
+        emit updateStatusBarOperation("Rescanning results...");
+
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(m_threads);
+
+        for (int thread = 0; thread < m_threads; ++thread)
+            threadPool.start([this]() { rescanFiles(); });
+
+        threadPool.waitForDone();
+
+        if (m_cancel)
+            emit canceled();
+        else
+            emit finished();
+    }
+
+
+    /**
+     * Stops the rescan, the file being read included: the files not read yet keep their results.
+     */
+    void cancel() {
+        m_cancel = true;
+    }
+
+
+signals:
+    void finished();
+    void canceled();
+    void rowsRescanned(const QVector<RescanUpdate> &updates);
+    void updateStatusBarOperation(const QString &operation);
+
+
+private:
+    void rescanFiles() {
+
+        // Each thread owns its compiled copy of the search pattern
+        const TextMatcher textMatcher = m_textMatcher.compiledCopy();
+        const QMimeDatabase mimeDatabase;
+
+        QVector<RescanUpdate> batch;
+        QElapsedTimer batchTimer;
+        batchTimer.start();
+
+        while (!m_cancel) {
+            const int job = m_nextJob++;
+            if (job >= m_jobs.size())
+                break;
+
+            RescanUpdate update;
+            update.job = job;
+
+            if (rescanFile(textMatcher, mimeDatabase, update))
+                batch.append(std::move(update));
+
+            if (batch.size() >= RESULTS_BATCH_SIZE
+                || (!batch.isEmpty() && batchTimer.elapsed() >= RESULTS_BATCH_INTERVAL)) {
+                emit rowsRescanned(batch);
+                batch.clear();
+                batchTimer.restart();
+            }
+        }
+
+        // The updates already complete are kept even when canceled
+        if (!batch.isEmpty())
+            emit rowsRescanned(batch);
+    }
+
+
+    /**
+     * @return - false if the rescan of the file was canceled, its row is left as is.
+     */
+    bool rescanFile(const TextMatcher &textMatcher, const QMimeDatabase &mimeDatabase, RescanUpdate &update) {
+
+        const RescanJob &job = m_jobs.at(update.job);
+
+        update.fileStat = Stat_Utils::fromPath(job.filePath);
+        if (!update.fileStat.valid) {
+            update.kind = RescanUpdate::Kind::Removed;
+            return true;
+        }
+
+        if (isUnchanged(job.scannedStat, update.fileStat)) {
+            update.kind = RescanUpdate::Kind::Refreshed;
+            return true;
+        }
+
+        QFile file(job.filePath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            update.kind = RescanUpdate::Kind::Removed;
+            return true;
+        }
+
+        const QPair<int, QSet<int>> occurencesFound = RescanOccurrences::scan(file, m_fileReadingTimeout,
+                                                                              m_timeoutFileReading,
+                                                                              m_limitOccurrencesFound,
+                                                                              m_occurrencesFoundLimit, textMatcher,
+                                                                              m_cancel);
+        file.close();
+
+        // A scan stopped midway doesn't hold all the occurrences
+        if (m_cancel)
+            return false;
+
+        // A result holds the pattern when matching it, doesn't hold it otherwise
+        if ((occurencesFound.first > 0) != m_matchText) {
+            update.kind = RescanUpdate::Kind::Removed;
+            return true;
+        }
+
+        // The MIME type may depend on the content
+        update.kind = RescanUpdate::Kind::Rescanned;
+        update.occurrences = occurencesFound.first;
+        update.linesNumbers = occurencesFound.second;
+        update.mimeType = mimeDatabase.mimeTypeForFile(job.filePath).name();
+        return true;
+    }
+
+
+    /**
+     * @return - true if the file is the one scanned, unchanged (the imported rows never are).
+     */
+    static bool isUnchanged(const FileStat &scannedStat, const FileStat &fileStat) {
+        return scannedStat.valid
+               && scannedStat.inode == fileStat.inode
+               && scannedStat.size == fileStat.size
+               && scannedStat.modifiedTimeNs == fileStat.modifiedTimeNs;
+    }
+
+
+    std::atomic<bool> m_cancel = false;     // Set by the GUI thread, read by the pool & the scans
+
+    const QVector<RescanJob> m_jobs;
+    std::atomic<int> m_nextJob = 0;
+
+    const TextMatcher m_textMatcher;    // Prepared once, compiled by each thread
+    bool m_fileReadingTimeout = false;
+    int m_timeoutFileReading = 0;
+    bool m_limitOccurrencesFound = false;
+    int m_occurrencesFoundLimit = 0;
+    bool m_matchText = true;
+    int m_threads = 1;
+
+};
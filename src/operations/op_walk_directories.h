@@ -0,0 +1,560 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "utils/path_trie.h"
+#include "utils/stat_utils.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * Parallel directory traversal.
+ *
+ * Every directory is a task on a work-stealing deque. Each worker owns a deque: it pushes the subdirectories it
+ * finds at the back and pops from the back (depth-first, good locality), while idle workers steal from the front
+ * of the other deques (the oldest tasks, usually the biggest subtrees). The depth, hidden, symbolic links and
+ * exclude rules are applied per task, so every directory is enumerated exactly once by a single QDirIterator.
+ * Files are not collected: they are streamed to a callback, typically feeding the next stage of a pipeline.
+ *
+ * On Linux the directories are read with getdents64() on directory descriptors opened with openat() relative to
+ * their parent, the entry types come from `d_type` and statx() is only called for the entries that need it
+ * (unknown types, symbolic links, metadata required by the filters). Elsewhere QDirIterator is used.
+ */
+class WalkDirectories {
+
+public:
+
+#ifdef Q_OS_LINUX
+    /**
+     * An open directory descriptor, shared by the tasks of its subdirectories so they can be opened relatively.
+     */
+    struct DirectoryHandle {
+        DirectoryHandle(const int fd, std::atomic<int> &openHandles) : fd(fd), openHandles(openHandles) {
+            openHandles.fetch_add(1);
+        }
+
+        ~DirectoryHandle() {
+            ::close(fd);
+            openHandles.fetch_sub(1);
+        }
+
+        const int fd;
+        std::atomic<int> &openHandles;
+    };
+#endif
+
+
+    struct DirectoryTask {
+        QString path;
+        int depth = 0;
+#ifdef Q_OS_LINUX
+        std::shared_ptr<DirectoryHandle> parent;    // Null for the roots, or when too many descriptors are held
+        QByteArray name;
+#endif
+    };
+
+
+    WalkDirectories(const QDir::Filters &filtersDirectories, const QDir::Filters &filtersFiles,
+                    const PathTrie &directoriesToExclude, const bool subdirectories, const int minDepth,
+                    const int maxDepth, const bool limitFilesToParse, const int filesToParseLimit,
+                    const bool needMetadata, const int threadsCount, const std::atomic<bool> &cancel)
+        : m_filtersDirectories(filtersDirectories),
+        m_filtersFiles(filtersFiles),
+        m_directoriesToExclude(directoriesToExclude),
+        m_subdirectories(subdirectories),
+        m_minDepth(minDepth),
+        m_maxDepth(maxDepth),
+        m_limitFilesToParse(limitFilesToParse),
+        m_filesToParseLimit(filesToParseLimit),
+        m_needMetadata(needMetadata),
+        m_threadsCount(std::max(1, threadsCount)),
+        m_cancel(cancel) { }
+
+
+    /**
+     * Walks the given directories with a pool of workers, handing every file found to `fileFound` as soon as
+     * its directory is enumerated.
+     * @param directories - The root directories to walk.
+     * @param directoryVisited - Called (from any worker thread) for each enumerated directory.
+     * @param fileFound - Called (from any worker thread) for each file with its metadata (only valid when the
+     *                    walker was asked for it), returning false stops the walk.
+     */
+    void walk(const QSet<QString> &directories, const std::function<void(const QString &)> &directoryVisited,
+              const std::function<bool(const QString &, const FileStat &)> &fileFound) {
+
+        m_directoryVisited = directoryVisited;
+        m_fileFound = fileFound;
+
+        m_queues.clear();
+        for (int worker = 0; worker < m_threadsCount; ++worker)
+            m_queues.push_back(std::make_unique<WorkQueue>());
+
+
+        // --------------------------
+        // Spread the roots over the workers' deques
+        // --------------------------
+        int rootWorker = 0;
+        for (const QString &directory : directories) {
+            const QFileInfo dirInfo(directory);
+
+            if (!dirInfo.isDir() || !dirInfo.isReadable()) {
+                qWarning() << "Directory is not readable or does not exist : " << directory;
+                continue;
+            }
+
+            DirectoryTask rootTask;
+            rootTask.path = dirInfo.absoluteFilePath();
+            pushTask(rootWorker, std::move(rootTask));
+            rootWorker = (rootWorker + 1) % m_threadsCount;
+        }
+
+
+        // --------------------------
+        // Run the workers, the current thread being the first one
+        // --------------------------
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(m_threadsCount);
+
+        for (int worker = 1; worker < m_threadsCount; ++worker)
+            threadPool.start([this, worker]() { runWorker(worker); });
+
+        runWorker(0);
+        threadPool.waitForDone();
+
+        if (m_limitReached)
+            qInfo() << "File limit reached. Stopping further parsing.";
+    }
+
+
+    qint64 processedDirectories() const {
+        return m_processedDirectories.load();
+    }
+
+    qint64 processedFiles() const {
+        const qint64 filesCount = m_filesCount.load();
+        return m_limitFilesToParse ? std::min<qint64>(filesCount, m_filesToParseLimit) : filesCount;
+    }
+
+    /**
+     * Number of system calls issued by the native walker (open, getdents64, statx, close), 0 with QDirIterator.
+     */
+    qint64 syscalls() const {
+        return m_syscalls.load();
+    }
+
+
+
+private:
+
+    struct WorkQueue {
+        QMutex mutex;
+        std::deque<DirectoryTask> tasks;
+    };
+
+
+    void pushTask(const int worker, DirectoryTask &&task) {
+        m_pendingTasks.fetch_add(1);
+
+        WorkQueue &queue = *m_queues[worker];
+        QMutexLocker locker(&queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+
+    bool popTask(const int worker, DirectoryTask &task) {
+        WorkQueue &queue = *m_queues[worker];
+        QMutexLocker locker(&queue.mutex);
+
+        if (queue.tasks.empty())
+            return false;
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+
+    bool stealTask(const int thief, DirectoryTask &task) {
+        for (int offset = 1; offset < m_threadsCount; ++offset) {
+            WorkQueue &queue = *m_queues[(thief + offset) % m_threadsCount];
+            QMutexLocker locker(&queue.mutex);
+
+            if (queue.tasks.empty())
+                continue;
+
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        return false;
+    }
+
+
+    void runWorker(const int worker) {
+
+        int idleRounds = 0;
+
+        while (!m_cancel && !m_stopped) {
+
+            DirectoryTask task;
+
+            if (!popTask(worker, task) && !stealTask(worker, task)) {
+                // Nothing to do: either the walk is over, or the other workers are still producing tasks
+                if (m_pendingTasks.load() == 0)
+                    return;
+
+                if (++idleRounds < 64)
+                    QThread::yieldCurrentThread();
+                else
+                    QThread::usleep(100);
+
+                continue;
+            }
+
+            idleRounds = 0;
+            processTask(worker, task);
+            m_pendingTasks.fetch_sub(1);
+        }
+    }
+
+
+    void processTask(const int worker, DirectoryTask &task) {
+
+        // Collect files in the current directory. If subdirectories are disabled, always collect files.
+        // If subdirectories are enabled, only collect files when the depth >= minDepth.
+        const bool collectFiles = !m_subdirectories || task.depth >= m_minDepth;
+        const bool collectDirectories = m_subdirectories && (m_maxDepth == -1 || task.depth + 1 <= m_maxDepth);
+
+        if (!collectFiles && !collectDirectories)
+            return;
+
+        if (m_directoryVisited)
+            m_directoryVisited(task.path);
+
+#ifdef Q_OS_LINUX
+        processTaskNative(worker, task, collectFiles, collectDirectories);
+#else
+        processTaskIterator(worker, task, collectFiles, collectDirectories);
+#endif
+
+        if (collectFiles)
+            m_processedDirectories.fetch_add(1);
+    }
+
+
+    /**
+     * Portable backend.
+     */
+    void processTaskIterator(const int worker, const DirectoryTask &task, const bool collectFiles,
+                             const bool collectDirectories) {
+
+        // --------------------------
+        // One iterator per directory for both the files and the subdirectories
+        // --------------------------
+        QDir::Filters iteratorFilters = QDir::NoDotAndDotDot | QDir::Readable;
+
+        if (collectFiles)
+            iteratorFilters |= QDir::Files | (m_filtersFiles & QDir::Hidden);
+
+        if (collectDirectories)
+            iteratorFilters |= QDir::Dirs | (m_filtersDirectories & QDir::Hidden);
+
+        QDirIterator iterator(task.path, iteratorFilters, QDirIterator::NoIteratorFlags);
+
+        while (iterator.hasNext()) {
+
+            if (m_cancel || m_stopped)
+                return;
+
+            const QFileInfo entryInfo = iterator.nextFileInfo();
+
+            if (entryInfo.isDir()) {
+                if (!collectDirectories || !acceptEntry(entryInfo, m_filtersDirectories))
+                    continue;
+
+                const QString subDirPath = entryInfo.absoluteFilePath();
+
+                if (isExcluded(subDirPath))
+                    continue;
+
+                DirectoryTask subDirTask;
+                subDirTask.path = subDirPath;
+                subDirTask.depth = task.depth + 1;
+                pushTask(worker, std::move(subDirTask));
+
+            } else {
+                if (!collectFiles || !acceptEntry(entryInfo, m_filtersFiles))
+                    continue;
+
+                if (!emitFile(entryInfo.filePath(), m_needMetadata ? Stat_Utils::fromFileInfo(entryInfo) : FileStat()))
+                    return;
+            }
+        }
+    }
+
+
+#ifdef Q_OS_LINUX
+    struct LinuxDirent64 {
+        quint64 d_ino;
+        qint64 d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+
+    /**
+     * Linux backend: one descriptor and a few getdents64() calls per directory, statx() only when needed.
+     */
+    void processTaskNative(const int worker, DirectoryTask &task, const bool collectFiles,
+                           const bool collectDirectories) {
+
+        const int dirFd = task.parent
+                              ? ::openat(task.parent->fd, task.name.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+                              : ::open(QFile::encodeName(task.path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        m_syscalls.fetch_add(1);
+
+        // The parent descriptor isn't needed anymore by this task
+        task.parent.reset();
+
+        if (dirFd < 0) {
+            if (task.depth == 0)
+                qWarning() << "Directory is not readable or does not exist : " << task.path;
+            return;
+        }
+
+        // Closed once this directory and all the pending tasks of its subdirectories are done (close() counted now)
+        m_syscalls.fetch_add(1);
+        const auto handle = std::make_shared<DirectoryHandle>(dirFd, m_openHandles);
+
+        const QString dirPrefix = task.path.endsWith(QLatin1Char('/')) ? task.path : task.path + QLatin1Char('/');
+
+        const bool followDirectoriesLinks = !m_filtersDirectories.testFlag(QDir::NoSymLinks);
+        const bool followFilesLinks = !m_filtersFiles.testFlag(QDir::NoSymLinks);
+        const bool hiddenDirectories = m_filtersDirectories.testFlag(QDir::Hidden);
+        const bool hiddenFiles = m_filtersFiles.testFlag(QDir::Hidden);
+
+        alignas(8) char buffer[32 * 1024];
+
+        while (true) {
+
+            const long bytesRead = ::syscall(SYS_getdents64, dirFd, buffer, sizeof(buffer));
+            m_syscalls.fetch_add(1);
+
+            if (bytesRead <= 0)
+                break;
+
+            for (long offset = 0; offset < bytesRead;) {
+
+                if (m_cancel || m_stopped)
+                    return;
+
+                const LinuxDirent64 *entry = reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+                offset += entry->d_reclen;
+
+                const char *name = entry->d_name;
+
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                    continue;
+
+                const bool hidden = name[0] == '.';
+
+                if (hidden && !(collectDirectories && hiddenDirectories) && !(collectFiles && hiddenFiles))
+                    continue;
+
+                unsigned char type = entry->d_type;
+                bool isLink = type == DT_LNK;
+
+                struct statx stx;
+                bool haveMetadata = false;
+
+
+                // --------------------------
+                // Resolve the type when getdents64 doesn't provide it, and the target of symbolic links
+                // --------------------------
+                if (type == DT_UNKNOWN) {
+                    if (!statEntry(dirFd, name, AT_SYMLINK_NOFOLLOW, stx))
+                        continue;
+
+                    isLink = S_ISLNK(stx.stx_mode);
+                    type = isLink ? DT_LNK : (S_ISDIR(stx.stx_mode) ? DT_DIR : (S_ISREG(stx.stx_mode) ? DT_REG : DT_UNKNOWN));
+                    haveMetadata = !isLink;
+                }
+
+                if (isLink) {
+                    if (!(collectDirectories && followDirectoriesLinks) && !(collectFiles && followFilesLinks))
+                        continue;
+
+                    // Broken links are skipped, like QDir does without the System filter
+                    if (!statEntry(dirFd, name, 0, stx))
+                        continue;
+
+                    type = S_ISDIR(stx.stx_mode) ? DT_DIR : (S_ISREG(stx.stx_mode) ? DT_REG : DT_UNKNOWN);
+                    haveMetadata = true;
+                }
+
+
+                if (type == DT_DIR) {
+                    if (!collectDirectories || (hidden && !hiddenDirectories) || (isLink && !followDirectoriesLinks))
+                        continue;
+
+                    DirectoryTask subDirTask;
+                    subDirTask.path = dirPrefix + QFile::decodeName(name);
+                    subDirTask.depth = task.depth + 1;
+
+                    if (isExcluded(subDirTask.path))
+                        continue;
+
+                    // Keep the parent descriptor for openat() unless too many are already held
+                    if (m_openHandles.load() < MAX_HELD_DIRECTORY_HANDLES) {
+                        subDirTask.parent = handle;
+                        subDirTask.name = QByteArray(name);
+                    }
+
+                    pushTask(worker, std::move(subDirTask));
+
+                } else if (type == DT_REG) {
+                    if (!collectFiles || (hidden && !hiddenFiles) || (isLink && !followFilesLinks))
+                        continue;
+
+                    FileStat fileStat;
+
+                    if (m_needMetadata && (haveMetadata || statEntry(dirFd, name, 0, stx)))
+                        fileStat = Stat_Utils::fromStatx(stx);
+
+                    if (!emitFile(dirPrefix + QFile::decodeName(name), fileStat))
+                        return;
+                }
+
+                // Other types (sockets, fifos, devices) are skipped, like QDir does without the System filter
+            }
+        }
+    }
+
+
+    bool statEntry(const int dirFd, const char *name, const int flags, struct statx &stx) {
+        m_syscalls.fetch_add(1);
+        return ::statx(dirFd, name, flags | AT_NO_AUTOMOUNT, Stat_Utils::STATX_METADATA_MASK, &stx) == 0;
+    }
+#endif
+
+
+    /**
+     * Hands a file to the sink, applying the files limit.
+     * @return - false if the walk must stop.
+     */
+    bool emitFile(const QString &filePath, const FileStat &fileStat) {
+
+        if (m_filesCount.fetch_add(1) >= m_filesToParseLimit && m_limitFilesToParse) {
+            m_limitReached = true;
+            m_stopped = true;
+            return false;
+        }
+
+        if (!m_fileFound(filePath, fileStat)) {
+            m_stopped = true;
+            return false;
+        }
+
+        return true;
+    }
+
+
+    /**
+     * Applies the hidden & symbolic links rules, the iterator filters being shared by files and directories.
+     */
+    static bool acceptEntry(const QFileInfo &entryInfo, const QDir::Filters &filters) {
+
+        if (!filters.testFlag(QDir::Hidden) && entryInfo.isHidden())
+            return false;
+
+        if (filters.testFlag(QDir::NoSymLinks) && entryInfo.isSymLink())
+            return false;
+
+        return true;
+    }
+
+
+    bool isExcluded(const QString &absoluteDirPath) const {
+        return m_directoriesToExclude.covers(absoluteDirPath);
+    }
+
+
+
+private:
+    static constexpr int MAX_HELD_DIRECTORY_HANDLES = 256;
+
+    const QDir::Filters m_filtersDirectories;
+    const QDir::Filters m_filtersFiles;
+    const PathTrie &m_directoriesToExclude;         // Built once per search, shared by the workers
+    const bool m_subdirectories;
+    const int m_minDepth;
+    const int m_maxDepth;
+    const bool m_limitFilesToParse;
+    const int m_filesToParseLimit;
+    const bool m_needMetadata;
+    const int m_threadsCount;
+    const std::atomic<bool> &m_cancel;
+
+    std::function<void(const QString &)> m_directoryVisited;
+    std::function<bool(const QString &, const FileStat &)> m_fileFound;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    std::atomic<qint64> m_pendingTasks = 0;
+    std::atomic<qint64> m_filesCount = 0;
+    std::atomic<qint64> m_processedDirectories = 0;
+    std::atomic<bool> m_limitReached = false;
+    std::atomic<bool> m_stopped = false;
+    std::atomic<qint64> m_syscalls = 0;
+    std::atomic<int> m_openHandles = 0;
+
+};
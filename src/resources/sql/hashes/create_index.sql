@@ -0,0 +1 @@
+CREATE INDEX IF NOT EXISTS hashes_last_used ON hashes ("last_used");
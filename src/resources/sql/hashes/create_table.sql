@@ -0,0 +1 @@
+CREATE TABLE IF NOT EXISTS hashes ("path" TEXT NOT NULL PRIMARY KEY, "inode" INTEGER, "size" INTEGER, "mtime_ns" INTEGER, "algorithm" TEXT, "partial_low" INTEGER, "partial_high" INTEGER, "whole_low" INTEGER, "whole_high" INTEGER, "last_used" INTEGER);
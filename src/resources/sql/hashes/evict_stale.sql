@@ -0,0 +1 @@
+DELETE FROM hashes WHERE rowid IN (SELECT rowid FROM hashes WHERE "last_used" < :C0 LIMIT :C1)
@@ -0,0 +1 @@
+SELECT "partial_low", "partial_high", "whole_low", "whole_high", "last_used" FROM hashes WHERE "path" = :C0 AND "inode" = :C1 AND "size" = :C2 AND "mtime_ns" = :C3 AND "algorithm" = :C4
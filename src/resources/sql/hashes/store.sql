@@ -0,0 +1 @@
+INSERT OR REPLACE INTO hashes ("path", "inode", "size", "mtime_ns", "algorithm", "partial_low", "partial_high", "whole_low", "whole_high", "last_used") VALUES (:C0, :C1, :C2, :C3, :C4, :C5, :C6, :C7, :C8, :C9)
@@ -0,0 +1 @@
+UPDATE hashes SET "last_used" = :C0 WHERE "path" = :C1
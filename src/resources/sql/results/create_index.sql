@@ -0,0 +1 @@
+CREATE INDEX IF NOT EXISTS results_last_used ON results ("last_used");
@@ -0,0 +1 @@
+CREATE TABLE IF NOT EXISTS results ("fingerprint" TEXT NOT NULL, "path" TEXT NOT NULL, "inode" INTEGER, "size" INTEGER, "mtime_ns" INTEGER, "occurrences" INTEGER, "details" BLOB, "last_used" INTEGER, PRIMARY KEY ("fingerprint", "path"));
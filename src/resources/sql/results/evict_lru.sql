@@ -0,0 +1 @@
+DELETE FROM results WHERE rowid IN (SELECT rowid FROM results ORDER BY "last_used" LIMIT :C0)
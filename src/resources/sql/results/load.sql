@@ -0,0 +1 @@
+SELECT "path", "inode", "size", "mtime_ns", "occurrences", "details" FROM results WHERE "fingerprint" = :C0
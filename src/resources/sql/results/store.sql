@@ -0,0 +1 @@
+INSERT OR REPLACE INTO results ("fingerprint", "path", "inode", "size", "mtime_ns", "occurrences", "details", "last_used") VALUES (:C0, :C1, :C2, :C3, :C4, :C5, :C6, :C7)
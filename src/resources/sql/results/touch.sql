@@ -0,0 +1 @@
+UPDATE results SET "last_used" = :C0 WHERE "fingerprint" = :C1 AND "path" = :C2
@@ -58,6 +58,13 @@ SettingsWindow::SettingsWindow(App_Settings *&appSettings, QWidget *parent)
 
     ui->checkBox_EnableLoggers->setChecked(m_appSettings->enableLoggers());
     ui->spinBox_LoggerFilesToKeep->setValue(m_appSettings->getLoggersFilesToKeep());
+
+    ui->spinBox_ScanThreads->setValue(m_appSettings->getScanThreads());
+    ui->checkBox_SortResults->setChecked(m_appSettings->getSortResults());
+    ui->checkBox_ListMatchingFilesOnly->setChecked(m_appSettings->getListMatchingFilesOnly());
+    ui->checkBox_UseTrigramIndex->setChecked(m_appSettings->getUseTrigramIndex());
+    ui->checkBox_UseChangeJournal->setChecked(m_appSettings->getUseChangeJournal());
+    ui->checkBox_CacheResults->setChecked(m_appSettings->getCacheResults());
 }
 
 
@@ -73,6 +80,12 @@ void SettingsWindow::closeEvent(QCloseEvent *event) {
     m_appSettings->setAlwaysOnTop(ui->checkBox_AlwaysOnTop->isChecked());
     m_appSettings->setEnableLoggers(ui->checkBox_EnableLoggers->isChecked());
     m_appSettings->setLoggersFilesToKeep(ui->spinBox_LoggerFilesToKeep->value());
+    m_appSettings->setScanThreads(ui->spinBox_ScanThreads->value());
+    m_appSettings->setSortResults(ui->checkBox_SortResults->isChecked());
+    m_appSettings->setListMatchingFilesOnly(ui->checkBox_ListMatchingFilesOnly->isChecked());
+    m_appSettings->setUseTrigramIndex(ui->checkBox_UseTrigramIndex->isChecked());
+    m_appSettings->setUseChangeJournal(ui->checkBox_UseChangeJournal->isChecked());
+    m_appSettings->setCacheResults(ui->checkBox_CacheResults->isChecked());
 
     event->accept();
 }
@@ -0,0 +1,113 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+
+
+/**
+ * Bounded FIFO queue shared by the stages of a pipeline.
+ *
+ * `push()` blocks while the queue is full (backpressure on the producers) and `pop()` blocks while it is empty.
+ * Once the producers are done they `close()` the queue: consumers drain what is left and then get `false`.
+ * The waits wake up periodically to honor the shared cancel flag.
+ */
+template <typename T>
+class BlockingQueue {
+
+public:
+    BlockingQueue(const qsizetype capacity, const std::atomic<bool> &cancel)
+        : m_capacity(std::max<qsizetype>(1, capacity)), m_cancel(cancel) { }
+
+
+    /**
+     * Appends an item, waiting for room if the queue is full.
+     * @return - false if the queue was closed or the operation canceled, the item is then dropped.
+     */
+    bool push(T item) {
+        QMutexLocker locker(&m_mutex);
+
+        while (!m_closed && !m_cancel && static_cast<qsizetype>(m_items.size()) >= m_capacity)
+            m_notFull.wait(&m_mutex, WAIT_INTERVAL);
+
+        if (m_closed || m_cancel)
+            return false;
+
+        m_items.push_back(std::move(item));
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+
+    /**
+     * Takes the oldest item, waiting for one if the queue is empty.
+     * @return - false once the queue is closed and drained, or the operation canceled.
+     */
+    bool pop(T &item) {
+        QMutexLocker locker(&m_mutex);
+
+        while (!m_closed && !m_cancel && m_items.empty())
+            m_notEmpty.wait(&m_mutex, WAIT_INTERVAL);
+
+        if (m_cancel || m_items.empty())
+            return false;
+
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+
+    void close() {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+
+
+private:
+    static constexpr unsigned long WAIT_INTERVAL = 100;     // ms
+
+    const qsizetype m_capacity;
+    const std::atomic<bool> &m_cancel;
+
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    std::deque<T> m_items;
+    bool m_closed = false;
+
+};
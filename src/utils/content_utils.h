@@ -0,0 +1,419 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CONTENT_UTILS_X86
+#include <immintrin.h>
+#endif
+
+
+/**
+ * What the first bytes of a file tell about its content.
+ */
+struct ContentClass {
+
+    enum Kind {
+        Empty,
+        Text,
+        Binary
+    };
+
+    enum Encoding {
+        Unknown,            // Binary or empty
+        Ascii,
+        Utf8,
+        Utf8WithBom,
+        Utf16LE,            // The UTF-16/32 encodings are only recognized by their BOM
+        Utf16BE,
+        Utf32LE,
+        Utf32BE
+    };
+
+    Kind kind = Empty;
+    Encoding encoding = Unknown;
+    int confidence = 0;     // 0 to 100: how much the examined bytes support the kind
+
+    bool isText() const {
+        return kind == Text;
+    }
+};
+
+
+class Content_Utils {
+
+public:
+    static constexpr qsizetype PEEK_SIZE = 1024;     // Bytes worth examining at the start of a file
+
+
+    /**
+     * Classifies a content in a single pass without allocating: known binary signatures, BOMs, UTF-8 validity, NUL
+     * and control bytes. The ASCII runs are skipped 16 bytes at a time, only the other bytes go through the UTF-8
+     * state machine.
+     * @param data - The first bytes of the content.
+     * @param size - The number of bytes.
+     * @param truncated - Whether the content goes on after these bytes (a multi-byte character may then be cut).
+     */
+    static ContentClass classify(const char *data, const qsizetype size, const bool truncated) {
+
+        ContentClass contentClass;
+
+        if (size <= 0)
+            return contentClass;
+
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+
+        if (isKnownBinary(bytes, size))
+            return {ContentClass::Binary, ContentClass::Unknown, 100};
+
+
+        // --------------------------
+        // The BOM of the UTF-16/32 encodings (the UTF-32 ones first, UTF-32LE starting like UTF-16LE)
+        // --------------------------
+        const std::string_view start(data, std::min<qsizetype>(size, 4));
+
+        if (start == std::string_view("\xFF\xFE\x00\x00", 4))
+            return {ContentClass::Text, ContentClass::Utf32LE, 90};
+        if (start == std::string_view("\x00\x00\xFE\xFF", 4))
+            return {ContentClass::Text, ContentClass::Utf32BE, 90};
+        if (start.starts_with("\xFF\xFE"))
+            return {ContentClass::Text, ContentClass::Utf16LE, 90};
+        if (start.starts_with("\xFE\xFF"))
+            return {ContentClass::Text, ContentClass::Utf16BE, 90};
+
+        qsizetype position = 0;
+        bool hasBom = false;
+        if (start.starts_with("\xEF\xBB\xBF")) {
+            position = 3;
+            hasBom = true;
+        }
+
+
+        // --------------------------
+        // UTF-8 validation & control bytes
+        // --------------------------
+        int suspiciousBytes = 0;
+        bool nonAscii = false;
+
+        while (position < size) {
+
+            position = skipPlainAscii(bytes, size, position);
+            if (position >= size)
+                break;
+
+            const unsigned char byte = bytes[position];
+
+            if (byte < 0x80) {
+                if (byte == 0x00)
+                    return {ContentClass::Binary, ContentClass::Unknown, 100};
+
+                if (!isAllowedAscii(byte))
+                    suspiciousBytes++;
+
+                position++;
+                continue;
+            }
+
+            nonAscii = true;
+
+            const int sequenceLength = utf8SequenceLength(bytes, size, position);
+
+            if (sequenceLength == 0) {
+                // A character cut by the end of the examined bytes is not an error
+                if (truncated && isUtf8Prefix(bytes, size, position))
+                    break;
+
+                suspiciousBytes++;
+                position++;
+                continue;
+            }
+
+            // The C1 control characters (U+0080 to U+009F)
+            if (byte == 0xC2 && bytes[position + 1] < 0xA0)
+                suspiciousBytes++;
+
+            position += sequenceLength;
+        }
+
+        if (suspiciousBytes > 0) {
+            const qsizetype examined = size;
+            const int confidence = 50 + static_cast<int>(std::min<qsizetype>(50, 50 * 16 * suspiciousBytes / examined));
+            return {ContentClass::Binary, ContentClass::Unknown, confidence};
+        }
+
+        contentClass.kind = ContentClass::Text;
+        contentClass.encoding = hasBom ? ContentClass::Utf8WithBom : (nonAscii ? ContentClass::Utf8 : ContentClass::Ascii);
+
+        // The more bytes were examined, the surer the guess
+        contentClass.confidence = hasBom ? 100 : 50 + static_cast<int>(50 * std::min(size, PEEK_SIZE) / PEEK_SIZE);
+        return contentClass;
+    }
+
+
+    /**
+     * Checks if the bytes start with a known binary file signature ("magic number").
+     */
+    static bool isKnownBinary(const unsigned char *bytes, const qsizetype size) {
+
+        if (size <= 0)
+            return false;
+
+        // Only the signatures sharing the first byte are compared
+        const unsigned char firstByte = bytes[0];
+        const auto first = MAGIC_NUMBERS.cbegin() + MAGIC_NUMBERS_OFFSETS[firstByte];
+        const auto last = MAGIC_NUMBERS.cbegin() + MAGIC_NUMBERS_OFFSETS[firstByte + 1];
+
+        const std::string_view data(reinterpret_cast<const char *>(bytes), size);
+
+        return std::any_of(first, last, [&data](const std::string_view &magicNumber) {
+            return data.starts_with(magicNumber);
+        });
+    }
+
+
+
+private:
+
+    /**
+     * Tab, line feed, vertical tab, form feed, carriage return & escape (ANSI colored logs) are the only control
+     * characters allowed in a text.
+     */
+    static bool isAllowedAscii(const unsigned char byte) {
+        return (byte >= 0x20 && byte < 0x7F) || (byte >= '\t' && byte <= '\r') || byte == 0x1B;
+    }
+
+
+    /**
+     * @return - The position of the first byte that is not printable ASCII nor an allowed control character.
+     */
+    static qsizetype skipPlainAscii(const unsigned char *bytes, const qsizetype size, qsizetype position) {
+
+#ifdef CONTENT_UTILS_X86
+        position = skipPlainAsciiSse2(bytes, size, position);
+#endif
+
+        while (position < size && isAllowedAscii(bytes[position]))
+            position++;
+
+        return position;
+    }
+
+
+#ifdef CONTENT_UTILS_X86
+    __attribute__((target("sse2")))
+    static qsizetype skipPlainAsciiSse2(const unsigned char *bytes, const qsizetype size, qsizetype position) {
+
+        const __m128i space = _mm_set1_epi8(0x20);
+        const __m128i del = _mm_set1_epi8(0x7F);
+        const __m128i tab = _mm_set1_epi8('\t' - 1);
+        const __m128i carriageReturn = _mm_set1_epi8('\r' + 1);
+        const __m128i escape = _mm_set1_epi8(0x1B);
+
+        while (position + 16 <= size) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + position));
+
+            // Signed comparisons: the bytes >= 0x80 are negative, hence below the space too
+            const __m128i belowSpace = _mm_cmplt_epi8(block, space);
+            const __m128i allowedControl = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi8(block, tab),
+                                                                      _mm_cmplt_epi8(block, carriageReturn)),
+                                                        _mm_cmpeq_epi8(block, escape));
+            const __m128i rejected = _mm_or_si128(_mm_andnot_si128(allowedControl, belowSpace),
+                                                  _mm_cmpeq_epi8(block, del));
+
+            const int rejectedMask = _mm_movemask_epi8(rejected);
+            if (rejectedMask != 0)
+                return position + __builtin_ctz(rejectedMask);
+
+            position += 16;
+        }
+
+        return position;
+    }
+#endif
+
+
+    /**
+     * @return - The length of the valid UTF-8 sequence at the position (2 to 4), 0 if invalid or incomplete.
+     */
+    static int utf8SequenceLength(const unsigned char *bytes, const qsizetype size, const qsizetype position) {
+
+        const unsigned char lead = bytes[position];
+
+        int length = 0;
+        unsigned char secondMin = 0x80;
+        unsigned char secondMax = 0xBF;
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0)
+                secondMin = 0xA0;       // Overlong
+            else if (lead == 0xED)
+                secondMax = 0x9F;       // Surrogates
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0)
+                secondMin = 0x90;       // Overlong
+            else if (lead == 0xF4)
+                secondMax = 0x8F;       // Above U+10FFFF
+        } else {
+            return 0;
+        }
+
+        if (position + length > size)
+            return 0;
+
+        if (bytes[position + 1] < secondMin || bytes[position + 1] > secondMax)
+            return 0;
+
+        for (int i = 2; i < length; ++i)
+            if ((bytes[position + i] & 0xC0) != 0x80)
+                return 0;
+
+        return length;
+    }
+
+
+    /**
+     * @return - true if the bytes from the position to the end start a valid UTF-8 sequence.
+     */
+    static bool isUtf8Prefix(const unsigned char *bytes, const qsizetype size, const qsizetype position) {
+
+        const unsigned char lead = bytes[position];
+        const int length = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : 2);
+
+        if (lead < 0xC2 || lead > 0xF4 || position + length <= size)
+            return false;
+
+        for (qsizetype i = position + 1; i < size; ++i)
+            if ((bytes[i] & 0xC0) != 0x80)
+                return false;
+
+        return true;
+    }
+
+
+    /**
+     * Known binary file "magic numbers", sorted at compile time by their first byte.
+     */
+    static constexpr auto MAGIC_NUMBERS = [] {
+        using namespace std::string_view_literals;
+
+        std::array magicNumbers {
+            // Images
+            "\xFF\xD8\xFF"sv,                                   // JPEG
+            "\x89\x50\x4E\x47\x0D\x0A\x1A\x0A"sv,               // PNG
+            "\x47\x49\x46\x38\x37\x61"sv,                       // GIF87a
+            "\x47\x49\x46\x38\x39\x61"sv,                       // GIF89a
+            "\x42\x4D"sv,                                       // BMP
+            "\x49\x49\x2A\x00"sv,                               // TIFF (little-endian)
+            "\x4D\x4D\x00\x2A"sv,                               // TIFF (big-endian)
+            "\x52\x49\x46\x46"sv,                               // WebP, WAV, AVI (further bytes needed)
+            "\x00\x00\x01\x00"sv,                               // ICO (Windows Icon)
+            "\x00\x01\x00\x00\x4A\x46\x49\x46\x00"sv,           // JFIF (JPEG File Interchange Format)
+
+            // Documents
+            "\x25\x50\x44\x46"sv,                               // PDF
+            "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1"sv,               // DOC, XLS, PPT, MSI (pre-2003, OLE Compound)
+            "\x50\x4B\x03\x04"sv,                               // DOCX, XLSX, PPTX, JAR, APK, ZIP, ODT, EPUB (ZIP-based)
+
+            // Archives and Compressed Files
+            "\x52\x61\x72\x21\x1A\x07\x00"sv,                   // RAR (v1.5 and later)
+            "\x37\x7A\xBC\xAF\x27\x1C"sv,                       // 7-Zip
+            "\x1F\x8B"sv,                                       // GZIP
+            "\x42\x5A\x68"sv,                                   // BZip2
+            "\x75\x73\x74\x61\x72"sv,                           // TAR
+            "\xED\xAB\xEE\xDB"sv,                               // RPM
+            "\x21\x3C\x61\x72\x63\x68\x3E"sv,                   // Debian package (DEB), AR archive
+            "\xFD\x37\x7A\x58\x5A\x00"sv,                       // XZ
+            "\x5D\x00\x00\x80"sv,                               // LZMA
+            "\x30\x37\x30\x37\x30\x37"sv,                       // CPIO archive
+
+            // Executables and Libraries
+            "\x4D\x5A"sv,                                       // EXE (Windows executable)
+            "\x7F\x45\x4C\x46"sv,                               // ELF (Unix/Linux Executable)
+            "\xCA\xFE\xBA\xBE"sv,                               // Java Class file, Mach-O Fat Binary
+            "\xFE\xED\xFA\xCE"sv,                               // Mach-O (MacOS executable, 32-bit)
+            "\xFE\xED\xFA\xCF"sv,                               // Mach-O (MacOS executable, 64-bit)
+
+            // Audio/Video
+            "\x49\x44\x33"sv,                                   // MP3 (ID3v2)
+            "\x00\x00\x00\x18\x66\x74\x79\x70\x6D\x70"sv,       // MP4 video file
+            "\x00\x00\x00\x20\x66\x74\x79\x70\x69\x73"sv,       // MP4 video file
+            "\x66\x74\x79\x70\x4D\x53\x4E\x56"sv,               // MP4 video file
+            "\x66\x74\x79\x70\x69\x73\x6F\x6D"sv,               // MP4 video file
+            "\x00\x00\x01\xBA"sv,                               // MPEG video file
+            "\x00\x00\x01\xB3"sv,                               // MPEG Video
+            "\x46\x4C\x56\x01"sv,                               // FLV video
+            "\x30\x26\xB2\x75\x8E\x66\xCF\x11"sv,               // ASF (WMV, WMA)
+            "\x4F\x67\x67\x53"sv,                               // OGG audio file
+            "\x1A\x45\xDF\xA3"sv,                               // MKV video file (mkv, mka, mks, mk3d, webm)
+
+            // Disk Images
+            "\x43\x44\x30\x30\x31"sv,                           // ISO CD/DVD image
+            "\x78\x01\x73\x0D\x62\x62\x60"sv,                   // DMG (Apple Disk Image)
+            "\x4B\x44\x4D"sv,                                   // VMDK (VMware Disk Image)
+
+            // Database
+            "\x53\x51\x4C\x69\x74\x65\x20\x66\x6F\x72\x6D\x61\x74\x20\x33\x00"sv,    // SQLite DB
+        };
+
+        std::sort(magicNumbers.begin(), magicNumbers.end(), [](const std::string_view &a, const std::string_view &b) {
+            return static_cast<unsigned char>(a.front()) < static_cast<unsigned char>(b.front());
+        });
+
+        return magicNumbers;
+    }();
+
+
+    /**
+     * First byte dispatch table, built at compile time: the signatures starting with the byte b are
+     * MAGIC_NUMBERS[MAGIC_NUMBERS_OFFSETS[b]] up to MAGIC_NUMBERS[MAGIC_NUMBERS_OFFSETS[b + 1]] (excluded).
+     */
+    static constexpr auto MAGIC_NUMBERS_OFFSETS = [] {
+        static_assert(MAGIC_NUMBERS.size() <= 0xFF);
+
+        std::array<quint8, 257> offsets {};
+        for (const std::string_view &magicNumber : MAGIC_NUMBERS)
+            offsets[static_cast<unsigned char>(magicNumber.front()) + 1]++;
+
+        for (std::size_t i = 1; i < offsets.size(); ++i)
+            offsets[i] += offsets[i - 1];
+
+        return offsets;
+    }();
+
+};
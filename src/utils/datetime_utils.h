@@ -84,37 +84,6 @@ public:
     }
 
 
-    /**
-     * Checks if a QDateTime satisfies a specified date condition relative to other date values.
-     * Supports a range of conditions including "Equals", "Not equals", "Before", "After", "Between", and "Not between".
-     *
-     * @param date - The QDateTime to evaluate.
-     * @param dateCondition - Condition to apply ("Equals", "Not equals", etc.).
-     * @param dateValue1 - First comparison QDateTime (used for most conditions).
-     * @param dateValue2 - Second comparison QDateTime (used only for "Between" and "Not between" conditions).
-     * @return bool - True if the date meets the specified condition; false otherwise.
-     */
-    static bool matchesDateConditions(const QDateTime &date, const QString &dateCondition, const QDateTime &dateValue1,
-                                      const QDateTime &dateValue2) {
-
-        if (dateCondition == "Equals")
-            return date == dateValue1;
-        else if (dateCondition == "Not equals")
-            return date != dateValue1;
-        else if (dateCondition == "Before")
-            return date < dateValue1;
-        else if (dateCondition == "After")
-            return date > dateValue1;
-        else if (dateCondition == "Between")
-            return date >= dateValue1 && date <= dateValue2;
-        else if (dateCondition == "Not between")
-            return date < dateValue1 || date > dateValue2;
-
-        return false; // Return false if an unsupported condition is provided
-    }
-
-
-
     static QString currentDateTime(const QString &format = "yyyyMMdd_hhmmss") {
         return QDateTime::currentDateTime().toString(format);
     }
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "constants/constants.h"
+#include "utils/content_utils.h"
 
 
 class File_Utils {
@@ -37,11 +38,11 @@ public:
 
     /**
      * Creates necessary directories and files by invoking helper functions.
-     * This method creates the `SETTINGS_DIR` and `LOGGERS_DIR` directories
+     * This method creates the `SETTINGS_DIR`, `LOGGERS_DIR`, `CACHE_DIR` and `INDEXES_DIR` directories
      * and the `SETTINGS_FILE`.
      */
     static void createNecessaryDirectoriesAndFiles(bool logIfExists = true) {
-        createDirectories({ SETTINGS_DIR, LOGGERS_DIR }, logIfExists);
+        createDirectories({ SETTINGS_DIR, LOGGERS_DIR, CACHE_DIR, INDEXES_DIR }, logIfExists);
         createFile(SETTINGS_FILE, logIfExists);
     }
 
@@ -283,117 +284,36 @@ public:
      * @return True if a known binary signature is found, false otherwise.
      */
     static bool isKnownBinaryFile(const QByteArray &data) {
-        // Iterate over the set and check if the file starts with any of the magic numbers
-        for (const QByteArray &magicNumber : binariesMagicNumbers_Set)
-            if (data.startsWith(magicNumber))
-                return true;
-
-        return false;
+        return Content_Utils::isKnownBinary(reinterpret_cast<const uchar *>(data.constData()), data.size());
     }
 
     /**
-     * Checks if a file contains text (as opposed to binary data).
+     * Classifies the content of a file from its first bytes (kind, encoding & confidence), without moving its
+     * position.
      * @param file - QFile object to check.
-     * @return True if the file is likely a text file, false otherwise.
+     * @return The content class, empty if the file can't be read.
      */
-    static bool isTextFile(QFile &file) {
+    static ContentClass classifyContent(QFile &file) {
         if (!file.isOpen() || !file.isReadable()) {
             qWarning() << "File is not open or readable";
-            return false;
+            return ContentClass();
         }
 
-        // Read the first 1024 bytes
-        QByteArray data = file.peek(1024);
-
-        // Check for known binary signatures or invalid UTF-8 sequences
-        if (isKnownBinaryFile(data) || data.isEmpty() || QString::fromUtf8(data).toUtf8() != data)
-            return false;
-
-        // Check if the content contains only printable characters (or valid control characters like newline)
-        QString content = QString::fromUtf8(data);
-        for (QChar c : content)
-            if (!c.isPrint() && c != '\n' && c != '\r' && c != '\t')
-                return false;
+        char data[Content_Utils::PEEK_SIZE];
+        const qint64 bytesRead = file.peek(data, Content_Utils::PEEK_SIZE);
 
-        return true;
+        // A pseudo-file reports a zero size, it may go on after a full peek
+        const bool truncated = bytesRead == Content_Utils::PEEK_SIZE && (file.size() == 0 || file.size() > bytesRead);
+        return Content_Utils::classify(data, bytesRead, truncated);
     }
 
-
-
-private:
     /**
-     * A set of known binary file "magic numbers" for various file types.
-     * This set is used to help identify binary files by checking their first bytes.
+     * Checks if a file contains text (as opposed to binary data).
+     * @param file - QFile object to check.
+     * @return True if the file is likely a text file, false otherwise.
      */
-    static const inline QSet<QByteArray> binariesMagicNumbers_Set {
-        // Images
-        QByteArray::fromHex("FFD8FF"),               // JPEG
-        QByteArray::fromHex("89504E470D0A1A0A"),     // PNG
-        QByteArray::fromHex("474946383761"),         // GIF87a
-        QByteArray::fromHex("474946383961"),         // GIF89a
-        QByteArray::fromHex("424D"),                 // BMP
-        QByteArray::fromHex("49492A00"),             // TIFF (little-endian)
-        QByteArray::fromHex("4D4D002A"),             // TIFF (big-endian)
-        QByteArray::fromHex("52494646"),             // WebP, WAV, AVI (further bytes needed)
-        QByteArray::fromHex("00000100"),             // ICO (Windows Icon)
-        QByteArray::fromHex("000100004A46494600"),   // JFIF (JPEG File Interchange Format)
-
-        // Documents
-        QByteArray::fromHex("25504446"),             // PDF
-        QByteArray::fromHex("D0CF11E0A1B11AE1"),     // DOC, XLS, PPT (pre-2003, OLE Compound)
-        QByteArray::fromHex("504B0304"),             // DOCX, XLSX, PPTX, JAR, APK, ZIP, ODT, EPUB (ZIP-based)
-
-        // Archives and Compressed Files
-        QByteArray::fromHex("526172211A0700"),       // RAR (v1.5 and later)
-        QByteArray::fromHex("377ABCAF271C"),         // 7-Zip
-        QByteArray::fromHex("1F8B"),                 // GZIP
-        QByteArray::fromHex("425A68"),               // BZip2
-        QByteArray::fromHex("7573746172"),           // TAR
-        QByteArray::fromHex("EDABEEDB"),             // RPM
-        QByteArray::fromHex("213C617263683E"),       // Debian package (DEB)
-        QByteArray::fromHex("FD377A585A00"),         // XZ
-        QByteArray::fromHex("5D000080"),             // LZMA
-        QByteArray::fromHex("213C617263683E"),       // AR archive
-        QByteArray::fromHex("303730373037"),         // CPIO archive
-
-        // Executables and Libraries
-        QByteArray::fromHex("4D5A"),                 // EXE (Windows executable)
-        QByteArray::fromHex("7F454C46"),             // ELF (Unix/Linux Executable) none, .axf, .bin, .elf, .o, .out, .prx, .puff, .ko, .mod, .so
-        QByteArray::fromHex("CAFEBABE"),             // Java Class file
-        QByteArray::fromHex("FEEDFACE"),             // Mach-O (MacOS executable, 32-bit)
-        QByteArray::fromHex("FEEDFACF"),             // Mach-O (MacOS executable, 64-bit)
-        QByteArray::fromHex("CAFEBABE"),             // Mach-O Fat Binary
-        QByteArray::fromHex("D0CF11E0A1B11AE1"),     // MSI (Microsoft Installer)
-
-        // Audio/Video
-        QByteArray::fromHex("494433"),               // MP3 (ID3v2)
-        // QByteArray::fromHex("000000146674797071742020"), // MOV (QuickTime)
-        // QByteArray::fromHex("00000020667479704D3441"), // M4A audio file
-        QByteArray::fromHex("00000018667479706D70"), // MP4 video file
-        QByteArray::fromHex("00000020667479706973"), // MP4 video file
-        QByteArray::fromHex("667479704D534E56"), // MP4 video file
-        QByteArray::fromHex("6674797069736F6D"), // MP4 video file
-        QByteArray::fromHex("000001BA"),             // MPEG video file
-        QByteArray::fromHex("000001B3"),             // MPEG Video
-        QByteArray::fromHex("464C5601"),             // FLV video
-        QByteArray::fromHex("3026B2758E66CF11"),     // ASF (WMV, WMA)
-        // QByteArray::fromHex("52494646xxxx57415645"), // WAV (part of RIFF format, similar to WebP and AVI)
-        QByteArray::fromHex("4F676753"),             // OGG audio file
-        QByteArray::fromHex("1A45DFA3"),             // MKV video file (mkv, mka, mks, mk3d, webm)
-        // QByteArray::fromHex("4D546864"),             // MIDI music file
-        // QByteArray::fromHex("2E524D46"),             // RealMedia file
-        // QByteArray::fromHex("2E736E64"),             // AU audio file
-
-        // Disk Images
-        QByteArray::fromHex("4344303031"),           // ISO CD/DVD image
-        QByteArray::fromHex("7801730D626260"),       // DMG (Apple Disk Image)
-        QByteArray::fromHex("4B444D"),               // VMDK (VMware Disk Image)
-
-        //     // Database
-        QByteArray::fromHex("53514C69746520666F726D6174203300"),  // SQLite DB
-
-        //     // Others
-        //     QByteArray::fromHex("2142444E"),             // PST (Personal Storage Table, Microsoft Outlook)
-    };
+    static bool isTextFile(QFile &file) {
+        return classifyContent(file).isText();
+    }
 
 };
@@ -0,0 +1,306 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <QStringView>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <string_view>
+
+
+/**
+ * Classifies the files from their extension alone, so the walker's output can be sorted without opening the files,
+ * peeking at their content or querying the MIME database.
+ *
+ * The extensions live in a constant table, looked up through a perfect hash that the compiler builds from it: adding
+ * an extension to the table is all it takes, a duplicate or an unplaceable extension fails the build.
+ */
+class FileTypes_Utils {
+
+public:
+    enum class Parseability : quint8 {
+        Unknown,            // Not in the table (or no extension): the content decides
+        Parseable,          // Text: no need to peek at the content
+        NotParseable        // Binary: no need to open the file
+    };
+
+
+    /**
+     * @param fileName - The file name (not the path), its last extension is looked up case insensitively.
+     * @return - The parseability of the extension, Unknown if it is not listed.
+     */
+    static Parseability parseability(const QStringView fileName) {
+
+        const qsizetype dot = fileName.lastIndexOf(u'.');
+
+        // No extension, a hidden file without one (".bashrc") or a too long one
+        if (dot <= 0 || fileName.size() - dot - 1 > MAX_EXTENSION_SIZE)
+            return Parseability::Unknown;
+
+        char extension[MAX_EXTENSION_SIZE];
+        qsizetype size = 0;
+
+        for (const QChar &c : fileName.sliced(dot + 1)) {
+            const char16_t unicode = c.unicode();
+            if (unicode >= 0x80)
+                return Parseability::Unknown;
+
+            extension[size++] = static_cast<char>(unicode >= u'A' && unicode <= u'Z' ? unicode + 0x20 : unicode);
+        }
+
+        return lookup(std::string_view(extension, size));
+    }
+
+
+
+private:
+    struct FileType {
+        std::string_view extension;     // Lower case
+        Parseability parseability;
+    };
+
+    static constexpr qsizetype MAX_EXTENSION_SIZE = 16;
+    static constexpr quint32 BUCKETS = 128;
+    static constexpr quint32 SLOTS = 512;                // A power of two, at least twice the extensions count
+    static constexpr qsizetype MAX_BUCKET_SIZE = 8;
+
+    struct PerfectHash {
+        std::array<quint16, BUCKETS> seeds {};       // Per bucket seed placing its extensions on free slots
+        std::array<quint16, SLOTS> slots {};         // 1-based index in FILE_TYPES, 0 for a free slot
+    };
+
+
+    /**
+     * Seeded FNV-1a, with a final mix so that the low bits (the slot) depend on every character.
+     */
+    static constexpr quint32 hash(const std::string_view key, const quint32 seed) {
+
+        quint32 h = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (const char c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        return h;
+    }
+
+
+    /**
+     * Hash and displace: the extensions are spread over buckets, then each bucket (the fullest first, while the
+     * table is the emptiest) searches for the seed that lands all of its extensions on free & distinct slots.
+     */
+    static constexpr PerfectHash buildPerfectHash() {
+
+        static_assert(FILE_TYPES.size() * 2 <= SLOTS, "Grow SLOTS along with the file types");
+
+        std::array<std::array<quint16, MAX_BUCKET_SIZE>, BUCKETS> buckets {};
+        std::array<qsizetype, BUCKETS> bucketsSizes {};
+
+        for (std::size_t i = 0; i < FILE_TYPES.size(); ++i) {
+            const std::string_view extension = FILE_TYPES[i].extension;
+
+            if (extension.empty() || static_cast<qsizetype>(extension.size()) > MAX_EXTENSION_SIZE)
+                throw "Invalid extension";
+
+            for (std::size_t j = 0; j < i; ++j)
+                if (FILE_TYPES[j].extension == extension)
+                    throw "Duplicated extension";
+
+            const quint32 bucket = hash(extension, 0) % BUCKETS;
+            if (bucketsSizes[bucket] == MAX_BUCKET_SIZE)
+                throw "Bucket overflow, grow BUCKETS";
+
+            buckets[bucket][bucketsSizes[bucket]++] = static_cast<quint16>(i);
+        }
+
+        std::array<quint32, BUCKETS> order {};
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&bucketsSizes](const quint32 a, const quint32 b) {
+            return bucketsSizes[a] > bucketsSizes[b];
+        });
+
+        PerfectHash perfectHash;
+
+        for (const quint32 bucket : order) {
+            const qsizetype bucketSize = bucketsSizes[bucket];
+            if (bucketSize == 0)
+                break;
+
+            for (quint32 seed = 1;; ++seed) {
+                if (seed > 0xFFFF)
+                    throw "No seed found, grow SLOTS";
+
+                std::array<quint32, MAX_BUCKET_SIZE> candidates {};
+                bool placed = true;
+
+                for (qsizetype k = 0; k < bucketSize && placed; ++k) {
+                    candidates[k] = hash(FILE_TYPES[buckets[bucket][k]].extension, seed) & (SLOTS - 1);
+                    placed = perfectHash.slots[candidates[k]] == 0
+                             && std::find(candidates.begin(), candidates.begin() + k, candidates[k])
+                                    == candidates.begin() + k;
+                }
+
+                if (!placed)
+                    continue;
+
+                for (qsizetype k = 0; k < bucketSize; ++k)
+                    perfectHash.slots[candidates[k]] = buckets[bucket][k] + 1;
+
+                perfectHash.seeds[bucket] = static_cast<quint16>(seed);
+                break;
+            }
+        }
+
+        return perfectHash;
+    }
+
+
+    /**
+     * Only the extensions that unambiguously denote a text or a binary format are listed, e.g. ".ts" (TypeScript or
+     * MPEG transport stream) and ".dat" are left to the content.
+     */
+    static constexpr auto FILE_TYPES = [] {
+        using namespace std::string_view_literals;
+        constexpr Parseability TEXT = Parseability::Parseable;
+        constexpr Parseability BINARY = Parseability::NotParseable;
+
+        return std::array {
+            // Plain text, documentation & data
+            FileType {"txt"sv, TEXT}, FileType {"text"sv, TEXT}, FileType {"md"sv, TEXT},
+            FileType {"markdown"sv, TEXT}, FileType {"rst"sv, TEXT}, FileType {"adoc"sv, TEXT},
+            FileType {"org"sv, TEXT}, FileType {"tex"sv, TEXT}, FileType {"bib"sv, TEXT}, FileType {"rtf"sv, TEXT},
+            FileType {"csv"sv, TEXT}, FileType {"tsv"sv, TEXT}, FileType {"log"sv, TEXT}, FileType {"srt"sv, TEXT},
+            FileType {"vtt"sv, TEXT}, FileType {"ics"sv, TEXT}, FileType {"vcf"sv, TEXT}, FileType {"po"sv, TEXT},
+            FileType {"pot"sv, TEXT},
+
+            // Configuration & markup
+            FileType {"ini"sv, TEXT}, FileType {"cfg"sv, TEXT}, FileType {"conf"sv, TEXT},
+            FileType {"toml"sv, TEXT}, FileType {"yaml"sv, TEXT}, FileType {"yml"sv, TEXT},
+            FileType {"json"sv, TEXT}, FileType {"jsonl"sv, TEXT}, FileType {"xml"sv, TEXT},
+            FileType {"xsd"sv, TEXT}, FileType {"xsl"sv, TEXT}, FileType {"xslt"sv, TEXT}, FileType {"svg"sv, TEXT},
+            FileType {"html"sv, TEXT}, FileType {"htm"sv, TEXT}, FileType {"xhtml"sv, TEXT},
+            FileType {"css"sv, TEXT}, FileType {"scss"sv, TEXT}, FileType {"sass"sv, TEXT},
+            FileType {"less"sv, TEXT}, FileType {"properties"sv, TEXT}, FileType {"desktop"sv, TEXT},
+            FileType {"service"sv, TEXT}, FileType {"env"sv, TEXT},
+
+            // Source code & build files
+            FileType {"c"sv, TEXT}, FileType {"h"sv, TEXT}, FileType {"cc"sv, TEXT}, FileType {"cpp"sv, TEXT},
+            FileType {"cxx"sv, TEXT}, FileType {"hh"sv, TEXT}, FileType {"hpp"sv, TEXT}, FileType {"hxx"sv, TEXT},
+            FileType {"inl"sv, TEXT}, FileType {"ipp"sv, TEXT}, FileType {"mm"sv, TEXT}, FileType {"cs"sv, TEXT},
+            FileType {"java"sv, TEXT}, FileType {"kt"sv, TEXT}, FileType {"kts"sv, TEXT},
+            FileType {"scala"sv, TEXT}, FileType {"groovy"sv, TEXT}, FileType {"gradle"sv, TEXT},
+            FileType {"go"sv, TEXT}, FileType {"rs"sv, TEXT}, FileType {"swift"sv, TEXT}, FileType {"py"sv, TEXT},
+            FileType {"pyi"sv, TEXT}, FileType {"rb"sv, TEXT}, FileType {"pl"sv, TEXT}, FileType {"pm"sv, TEXT},
+            FileType {"php"sv, TEXT}, FileType {"lua"sv, TEXT}, FileType {"jl"sv, TEXT}, FileType {"dart"sv, TEXT},
+            FileType {"js"sv, TEXT}, FileType {"mjs"sv, TEXT}, FileType {"cjs"sv, TEXT}, FileType {"jsx"sv, TEXT},
+            FileType {"tsx"sv, TEXT}, FileType {"vue"sv, TEXT}, FileType {"sh"sv, TEXT}, FileType {"bash"sv, TEXT},
+            FileType {"zsh"sv, TEXT}, FileType {"fish"sv, TEXT}, FileType {"ps1"sv, TEXT}, FileType {"bat"sv, TEXT},
+            FileType {"cmd"sv, TEXT}, FileType {"sql"sv, TEXT}, FileType {"hs"sv, TEXT}, FileType {"ml"sv, TEXT},
+            FileType {"ex"sv, TEXT}, FileType {"exs"sv, TEXT}, FileType {"erl"sv, TEXT}, FileType {"clj"sv, TEXT},
+            FileType {"el"sv, TEXT}, FileType {"lisp"sv, TEXT}, FileType {"f90"sv, TEXT}, FileType {"asm"sv, TEXT},
+            FileType {"vhd"sv, TEXT}, FileType {"proto"sv, TEXT}, FileType {"graphql"sv, TEXT},
+            FileType {"tf"sv, TEXT}, FileType {"nix"sv, TEXT}, FileType {"zig"sv, TEXT}, FileType {"tcl"sv, TEXT},
+            FileType {"awk"sv, TEXT}, FileType {"vim"sv, TEXT}, FileType {"cmake"sv, TEXT}, FileType {"mk"sv, TEXT},
+            FileType {"pro"sv, TEXT}, FileType {"pri"sv, TEXT}, FileType {"qrc"sv, TEXT}, FileType {"ui"sv, TEXT},
+            FileType {"qml"sv, TEXT}, FileType {"patch"sv, TEXT}, FileType {"diff"sv, TEXT},
+            FileType {"csproj"sv, TEXT}, FileType {"sln"sv, TEXT}, FileType {"vcxproj"sv, TEXT},
+
+            // Images & fonts
+            FileType {"png"sv, BINARY}, FileType {"jpg"sv, BINARY}, FileType {"jpeg"sv, BINARY},
+            FileType {"gif"sv, BINARY}, FileType {"bmp"sv, BINARY}, FileType {"tif"sv, BINARY},
+            FileType {"tiff"sv, BINARY}, FileType {"webp"sv, BINARY}, FileType {"ico"sv, BINARY},
+            FileType {"icns"sv, BINARY}, FileType {"psd"sv, BINARY}, FileType {"xcf"sv, BINARY},
+            FileType {"heic"sv, BINARY}, FileType {"avif"sv, BINARY}, FileType {"ttf"sv, BINARY},
+            FileType {"otf"sv, BINARY}, FileType {"woff"sv, BINARY}, FileType {"woff2"sv, BINARY},
+            FileType {"eot"sv, BINARY},
+
+            // Documents
+            FileType {"pdf"sv, BINARY}, FileType {"doc"sv, BINARY}, FileType {"docx"sv, BINARY},
+            FileType {"xls"sv, BINARY}, FileType {"xlsx"sv, BINARY}, FileType {"ppt"sv, BINARY},
+            FileType {"pptx"sv, BINARY}, FileType {"odt"sv, BINARY}, FileType {"ods"sv, BINARY},
+            FileType {"odp"sv, BINARY}, FileType {"epub"sv, BINARY},
+
+            // Archives, packages & disk images
+            FileType {"zip"sv, BINARY}, FileType {"gz"sv, BINARY}, FileType {"tgz"sv, BINARY},
+            FileType {"bz2"sv, BINARY}, FileType {"xz"sv, BINARY}, FileType {"zst"sv, BINARY},
+            FileType {"lz4"sv, BINARY}, FileType {"lzma"sv, BINARY}, FileType {"7z"sv, BINARY},
+            FileType {"rar"sv, BINARY}, FileType {"tar"sv, BINARY}, FileType {"jar"sv, BINARY},
+            FileType {"war"sv, BINARY}, FileType {"apk"sv, BINARY}, FileType {"deb"sv, BINARY},
+            FileType {"rpm"sv, BINARY}, FileType {"cab"sv, BINARY}, FileType {"msi"sv, BINARY},
+            FileType {"iso"sv, BINARY}, FileType {"img"sv, BINARY}, FileType {"dmg"sv, BINARY},
+            FileType {"vmdk"sv, BINARY}, FileType {"qcow2"sv, BINARY},
+
+            // Executables, libraries & compiled files
+            FileType {"exe"sv, BINARY}, FileType {"dll"sv, BINARY}, FileType {"so"sv, BINARY},
+            FileType {"dylib"sv, BINARY}, FileType {"a"sv, BINARY}, FileType {"o"sv, BINARY},
+            FileType {"obj"sv, BINARY}, FileType {"lib"sv, BINARY}, FileType {"class"sv, BINARY},
+            FileType {"pyc"sv, BINARY}, FileType {"pyo"sv, BINARY}, FileType {"wasm"sv, BINARY},
+            FileType {"qm"sv, BINARY}, FileType {"rcc"sv, BINARY},
+
+            // Audio & video
+            FileType {"mp3"sv, BINARY}, FileType {"wav"sv, BINARY}, FileType {"flac"sv, BINARY},
+            FileType {"ogg"sv, BINARY}, FileType {"oga"sv, BINARY}, FileType {"opus"sv, BINARY},
+            FileType {"m4a"sv, BINARY}, FileType {"aac"sv, BINARY}, FileType {"wma"sv, BINARY},
+            FileType {"mp4"sv, BINARY}, FileType {"m4v"sv, BINARY}, FileType {"mkv"sv, BINARY},
+            FileType {"webm"sv, BINARY}, FileType {"avi"sv, BINARY}, FileType {"mov"sv, BINARY},
+            FileType {"wmv"sv, BINARY}, FileType {"flv"sv, BINARY}, FileType {"mpg"sv, BINARY},
+            FileType {"mpeg"sv, BINARY},
+
+            // Databases
+            FileType {"sqlite"sv, BINARY}, FileType {"sqlite3"sv, BINARY}, FileType {"db"sv, BINARY},
+            FileType {"parquet"sv, BINARY}, FileType {"npy"sv, BINARY},
+        };
+    }();
+
+
+
+    static Parseability lookup(const std::string_view extension) {
+
+        // Evaluated by the compiler: only the tables end up in the binary
+        static constexpr PerfectHash PERFECT_HASH = buildPerfectHash();
+
+        if (extension.empty())
+            return Parseability::Unknown;
+
+        const quint32 bucket = hash(extension, 0) % BUCKETS;
+        const quint16 index = PERFECT_HASH.slots[hash(extension, PERFECT_HASH.seeds[bucket]) & (SLOTS - 1)];
+
+        if (index == 0 || FILE_TYPES[index - 1].extension != extension)
+            return Parseability::Unknown;
+
+        return FILE_TYPES[index - 1].parseability;
+    }
+
+};
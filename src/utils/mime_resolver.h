@@ -0,0 +1,188 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QReadWriteLock>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <atomic>
+
+
+/**
+ * Resolves the MIME types of a search's files through a cache shared by its threads, each thread querying its own
+ * QMimeDatabase on a miss.
+ *
+ * The files are keyed by their name part the globs look at (the complete suffix, or the whole name without suffix):
+ * when the name designates a single MIME type, the content is never read. Otherwise the key is completed with the
+ * leading bytes of the file, where the magic numbers are, and only the first file of each kind is sniffed in full.
+ * Files matched by a glob on more than their suffix (e.g. "CMakeLists.txt", "Makefile.am") are keyed by their whole
+ * name, and so is any name that its suffix alone would not resolve the same.
+ */
+class MimeResolver {
+
+public:
+    MimeResolver() : m_wholeNameGlobs(wholeNameGlobs()) {}
+
+
+    /**
+     * @param mimeDatabase - The calling thread's MIME database, queried on a cache miss.
+     * @param fileInfo - The file.
+     * @return - The MIME type of the file, as QMimeDatabase::mimeTypeForFile() would resolve it.
+     */
+    QMimeType mimeTypeForFile(const QMimeDatabase &mimeDatabase, const QFileInfo &fileInfo) {
+
+        m_lookups.fetch_add(1, std::memory_order_relaxed);
+
+        const QString fileName = fileInfo.fileName();
+        const QString suffix = fileInfo.completeSuffix();
+        const bool keyBySuffix = !suffix.isEmpty() && !fileInfo.baseName().isEmpty()
+                                 && !m_wholeNameGlobs.match(fileName).hasMatch();
+        QByteArray nameKey = (keyBySuffix ? suffix : fileName).toUtf8();
+
+
+        // --------------------------
+        // The name decides
+        // --------------------------
+        bool ambiguousName = false;
+        QMimeType mimeType;
+
+        if (find(nameKey, mimeType, ambiguousName))
+            return mimeType;
+
+        if (!ambiguousName) {
+            const QList<QMimeType> candidates = mimeDatabase.mimeTypesForFileName(fileName);
+            mimeType = candidates.size() == 1 ? candidates.constFirst() : QMimeType();
+
+            // The suffix only stands for the names it resolves the same
+            if (keyBySuffix && candidates != mimeDatabase.mimeTypesForFileName("x." + suffix))
+                nameKey = fileName.toUtf8();
+
+            insert(nameKey, mimeType);
+
+            if (mimeType.isValid())
+                return mimeType;
+        }
+
+
+        // --------------------------
+        // The content decides: the name & the magic bytes make the key
+        // --------------------------
+        QFile file(fileInfo.filePath());
+        if (!file.open(QIODevice::ReadOnly))
+            return mimeDatabase.mimeTypeForFile(fileInfo, QMimeDatabase::MatchExtension);
+
+        const QByteArray head = file.read(SNIFF_SIZE);
+        const QByteArray contentKey = nameKey + '\0' + head.left(MAGIC_SIZE);
+
+        if (find(contentKey, mimeType, ambiguousName))
+            return mimeType;
+
+        mimeType = mimeDatabase.mimeTypeForFileNameAndData(fileName, head);
+        insert(contentKey, mimeType);
+
+        return mimeType;
+    }
+
+
+    qint64 lookups() const { return m_lookups.load(std::memory_order_relaxed); }
+    qint64 cacheHits() const { return m_cacheHits.load(std::memory_order_relaxed); }
+
+
+
+private:
+    static constexpr qsizetype MAGIC_SIZE = 16;          // Bytes of content in the key
+    static constexpr qsizetype SNIFF_SIZE = 16 * 1024;   // Bytes sniffed on a miss, as much as QMimeDatabase reads
+
+    const QRegularExpression m_wholeNameGlobs;   // The globs that look at more than the suffix
+    QHash<QByteArray, QMimeType> m_cache;   // An invalid type marks a name that needs the content
+    QReadWriteLock m_cacheLock;
+    std::atomic<qint64> m_lookups = 0;
+    std::atomic<qint64> m_cacheHits = 0;
+
+
+    /**
+     * @param found - Set to the cached MIME type.
+     * @param ambiguous - Set to true if the key is cached as not deciding.
+     * @return - true if the key is cached with a MIME type.
+     */
+    bool find(const QByteArray &key, QMimeType &found, bool &ambiguous) {
+
+        QReadLocker locker(&m_cacheLock);
+
+        const auto it = m_cache.constFind(key);
+        if (it == m_cache.constEnd())
+            return false;
+
+        ambiguous = !it->isValid();
+        if (ambiguous)
+            return false;
+
+        found = *it;
+        m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+
+    void insert(const QByteArray &key, const QMimeType &mimeType) {
+        QWriteLocker locker(&m_cacheLock);
+        m_cache.insert(key, mimeType);
+    }
+
+
+    /**
+     * @return - A pattern matching the file names that a glob other than "*.suffix" resolves, e.g. literal names
+     *           ("CMakeLists.txt") or prefixes ("Makefile.*", "README*").
+     */
+    static QRegularExpression wholeNameGlobs() {
+
+        static const QRegularExpression suffixGlob(R"(^\*\.[^*?\[\]]+$)");
+
+        QStringList patterns;
+
+        for (const QMimeType &mimeType : QMimeDatabase().allMimeTypes())
+            for (const QString &glob : mimeType.globPatterns())
+                if (!suffixGlob.match(glob).hasMatch())
+                    patterns << "(?:" + QRegularExpression::wildcardToRegularExpression(glob) + ")";
+
+        // An empty alternation would match every name
+        if (patterns.isEmpty())
+            return QRegularExpression("(?!)");
+
+        QRegularExpression pattern(patterns.join('|'), QRegularExpression::CaseInsensitiveOption);
+        pattern.optimize();
+        return pattern;
+    }
+
+};
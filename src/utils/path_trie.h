@@ -0,0 +1,182 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include <vector>
+
+
+/**
+ * A set of directories stored by path components, answering whether a path is one of them or lies below one of
+ * them in O(depth) whatever the number of directories. A whole component must match: `/src` doesn't cover `/src2`.
+ * Built once per search then only read, it is shared by the walker threads without locking.
+ */
+class PathTrie {
+
+public:
+    PathTrie() : m_nodes(1) { }
+
+
+    /**
+     * @param paths - The directories, absolute.
+     */
+    explicit PathTrie(const QSet<QString> &paths) : PathTrie() {
+        for (const QString &path : paths)
+            insert(path);
+    }
+
+
+    void insert(const QString &path) {
+
+        const QString cleanPath = QDir::cleanPath(path);
+        int node = 0;
+
+        for (const QStringView &component : QStringView(cleanPath).split(u'/', Qt::SkipEmptyParts)) {
+            const QString key = component.toString();
+            int child = m_nodes[node].children.value(key, -1);
+
+            if (child < 0) {
+                child = static_cast<int>(m_nodes.size());
+                m_nodes[node].children.insert(key, child);
+                m_nodes.emplace_back();
+            }
+
+            node = child;
+        }
+
+        m_nodes[node].path = cleanPath;
+    }
+
+
+    bool isEmpty() const {
+        return m_nodes.size() == 1 && m_nodes.front().path.isNull();
+    }
+
+
+    /**
+     * @return - true if the path is one of the directories or lies below one of them.
+     */
+    bool covers(const QString &path) const {
+        return depthBelow(path, true) >= 0;
+    }
+
+
+    /**
+     * @return - The number of components of the path below the nearest directory holding it, -1 if none does.
+     */
+    int depthBelow(const QString &path) const {
+        return depthBelow(path, false);
+    }
+
+
+    /**
+     * @return - The directories not lying below another one: a subtree walked once only.
+     */
+    QSet<QString> outermostPaths() const {
+
+        QSet<QString> paths;
+        std::vector<int> pending = {0};
+
+        while (!pending.empty()) {
+            const Node &node = m_nodes[pending.back()];
+            pending.pop_back();
+
+            if (!node.path.isNull()) {
+                paths.insert(node.path);
+                continue;
+            }
+
+            for (auto it = node.children.cbegin(); it != node.children.cend(); ++it)
+                pending.push_back(it.value());
+        }
+
+        return paths;
+    }
+
+
+
+
+private:
+    struct Node {
+        QHash<QString, int> children;   // Component -> node
+        QString path;                   // Null unless a directory ends here
+    };
+
+
+    /**
+     * Follows the components of the path, the lookups referring to them without copying.
+     * @param firstOnly - Stop at the first directory holding the path, its depth being of no use.
+     */
+    int depthBelow(const QString &path, const bool firstOnly) const {
+
+        int node = 0;
+        int depth = m_nodes[0].path.isNull() ? -1 : 0;     // The root directory itself may be listed
+
+        if (firstOnly && depth == 0)
+            return 0;
+
+        for (qsizetype start = 0; start < path.size(); ) {
+            qsizetype end = path.indexOf(u'/', start);
+            if (end < 0)
+                end = path.size();
+
+            if (end > start) {
+                if (depth >= 0)
+                    depth++;
+
+                // Past the nodes, the components only count for the depth
+                if (node >= 0) {
+                    node = m_nodes[node].children.value(QString::fromRawData(path.constData() + start, end - start),
+                                                        -1);
+
+                    if (node >= 0 && !m_nodes[node].path.isNull()) {
+                        if (firstOnly)
+                            return 0;
+                        depth = 0;
+                    } else if (node < 0 && depth < 0) {
+                        return -1;
+                    }
+                }
+            }
+
+            start = end + 1;
+        }
+
+        return depth;
+    }
+
+
+    std::vector<Node> m_nodes;      // The root first
+
+};
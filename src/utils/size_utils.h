@@ -101,41 +101,4 @@ public:
         return static_cast<qint64>(size * conversions[unit]);
     }
 
-
-    /**
-     * Checks if a file size matches specified conditions against given size values.
-     * @param fileSize - The actual size of the file.
-     * @param sizeSystem - The measurement system used ("SI" or "IEC").
-     * @param sizeCondition - The condition to check (e.g., "Equals", "Less than").
-     * @param sizeValue1 - The first size value for comparison.
-     * @param sizeValue2 - The second size value for comparison (used for "Between" and "Not between" conditions).
-     * @param sizeUnit_1 - The unit of sizeValue1 (e.g., "KB").
-     * @param sizeUnit_2 - The unit of sizeValue2 (e.g., "MB").
-     * @return True if the file size meets the specified conditions; otherwise, false.
-     */
-    static bool matchesSizeConditions(const qint64 &fileSize, const QString &sizeSystem, const QString &sizeCondition,
-                                      double sizeValue1, double sizeValue2,
-                                      const QString &sizeUnit_1, const QString &sizeUnit_2) {
-
-        // Convert the size conditions from the specified units to bytes
-        qint64 convertedSizeValue1 = Size_Utils::convertSize(sizeValue1, sizeUnit_1, sizeSystem);
-        qint64 convertedSizeValue2 = Size_Utils::convertSize(sizeValue2, sizeUnit_2, sizeSystem);
-
-        // Evaluate the condition against the file size
-        if (sizeCondition == "Equals")
-            return fileSize == convertedSizeValue1;
-        else if (sizeCondition == "Not equals")
-            return fileSize != convertedSizeValue1;
-        else if (sizeCondition == "Less than")
-            return fileSize < convertedSizeValue1;
-        else if (sizeCondition == "Greater than")
-            return fileSize > convertedSizeValue1;
-        else if (sizeCondition == "Between")
-            return fileSize >= convertedSizeValue1 && fileSize <= convertedSizeValue2;
-        else if (sizeCondition == "Not between")
-            return fileSize < convertedSizeValue1 || fileSize > convertedSizeValue2;
-
-        return false;
-    }
-
 };
@@ -0,0 +1,162 @@
+/*
+    Author: Rachid Tagzen
+    Date: 2024/11/23 | 22h57 | 13h34
+
+    This work is licensed under the MIT License.
+
+    Copyright (c) 2024 Rachid Tagzen
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+/**
+ * Raw metadata of a file, gathered once during the walk so the filters don't have to stat the file again.
+ * Times are nanoseconds since the epoch, -1 when unknown (e.g. no birth time on the filesystem).
+ */
+struct FileStat {
+    bool valid = false;
+    qint64 size = 0;
+    qint64 birthTimeNs = -1;
+    qint64 modifiedTimeNs = -1;
+    qint64 accessedTimeNs = -1;
+    quint64 inode = 0;
+    quint64 device = 0;
+
+    QDateTime birthTime() const {
+        return toDateTime(birthTimeNs);
+    }
+
+    QDateTime lastModified() const {
+        return toDateTime(modifiedTimeNs);
+    }
+
+    QDateTime lastRead() const {
+        return toDateTime(accessedTimeNs);
+    }
+
+private:
+    static QDateTime toDateTime(const qint64 &timeNs) {
+        return timeNs < 0 ? QDateTime() : QDateTime::fromMSecsSinceEpoch(timeNs / 1000000);
+    }
+};
+
+
+class Stat_Utils {
+
+public:
+
+    /**
+     * Fills a FileStat from a QFileInfo (portable path, costs a stat() if the info isn't cached yet).
+     * @param fileInfo - The file to describe.
+     * @return The metadata of the file, invalid if the file doesn't exist.
+     */
+    static FileStat fromFileInfo(const QFileInfo &fileInfo) {
+
+        FileStat fileStat;
+
+        if (!fileInfo.exists())
+            return fileStat;
+
+        const QDateTime birthTime = fileInfo.birthTime();
+
+        fileStat.valid = true;
+        fileStat.size = fileInfo.size();
+        fileStat.birthTimeNs = birthTime.isValid() ? birthTime.toMSecsSinceEpoch() * 1000000 : -1;
+        fileStat.modifiedTimeNs = fileInfo.lastModified().toMSecsSinceEpoch() * 1000000;
+        fileStat.accessedTimeNs = fileInfo.lastRead().toMSecsSinceEpoch() * 1000000;
+        return fileStat;
+    }
+
+
+    /**
+     * Stats a file by its path, with a single statx() on Linux (symbolic links followed, like the walker).
+     * @param filePath - The file to describe.
+     * @return The metadata of the file, invalid if it doesn't exist or isn't a regular file.
+     */
+    static FileStat fromPath(const QString &filePath) {
+
+#ifdef Q_OS_LINUX
+        struct statx stx;
+        if (::statx(AT_FDCWD, QFile::encodeName(filePath).constData(), AT_NO_AUTOMOUNT, STATX_METADATA_MASK,
+                    &stx) != 0 || !S_ISREG(stx.stx_mode))
+            return FileStat();
+
+        return fromStatx(stx);
+#else
+        const QFileInfo fileInfo(filePath);
+        return fileInfo.isFile() ? fromFileInfo(fileInfo) : FileStat();
+#endif
+    }
+
+
+#ifdef Q_OS_LINUX
+    /**
+     * Metadata requested from statx() by the walker: the type (to resolve links and unknown entries),
+     * the size, the times and the identity of the file.
+     */
+    static constexpr unsigned int STATX_METADATA_MASK = STATX_TYPE | STATX_SIZE | STATX_BTIME | STATX_MTIME
+                                                        | STATX_ATIME | STATX_INO;
+
+
+    /**
+     * Fills a FileStat from a statx() result.
+     * @param stx - The statx() result, only the fields flagged in `stx_mask` are used.
+     * @return The metadata of the file.
+     */
+    static FileStat fromStatx(const struct statx &stx) {
+
+        FileStat fileStat;
+        fileStat.valid = true;
+        fileStat.size = static_cast<qint64>(stx.stx_size);
+        fileStat.inode = stx.stx_ino;
+        fileStat.device = (static_cast<quint64>(stx.stx_dev_major) << 32) | stx.stx_dev_minor;
+
+        if (stx.stx_mask & STATX_BTIME)
+            fileStat.birthTimeNs = toNanoseconds(stx.stx_btime);
+
+        if (stx.stx_mask & STATX_MTIME)
+            fileStat.modifiedTimeNs = toNanoseconds(stx.stx_mtime);
+
+        if (stx.stx_mask & STATX_ATIME)
+            fileStat.accessedTimeNs = toNanoseconds(stx.stx_atime);
+
+        return fileStat;
+    }
+
+
+private:
+    static qint64 toNanoseconds(const struct statx_timestamp &timestamp) {
+        return static_cast<qint64>(timestamp.tv_sec) * 1000000000 + timestamp.tv_nsec;
+    }
+#endif
+
+};